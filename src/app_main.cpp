@@ -31,11 +31,16 @@
 #include "intf/mdns/init.hpp"
 #include "intf/udp/init.hpp"
 #include "intf/usb/init.hpp"
+#include "mem/littlefs/init.hpp"
 #include "mem/nvs/init.hpp"
 #include "mw/dcc/init.hpp"
 #include "mw/disp/init.hpp"
+#include "mw/events/init.hpp"
+#include "mw/frontend/init.hpp"
+#include "mw/meter/init.hpp"
 #include "mw/ota/init.hpp"
 #include "mw/roco/z21/init.hpp"
+#include "mw/telem/init.hpp"
 #include "mw/zimo/decup/init.hpp"
 #include "mw/zimo/mdu/init.hpp"
 #include "mw/zimo/ulf/init.hpp"
@@ -50,6 +55,9 @@ extern "C" void app_main() {
   // Most important ones
   ESP_ERROR_CHECK(invoke_on_core(PRO_CPU_NUM, mem::nvs::init));
   static_assert(APP_CPU_NUM == mem::nvs::task.core_id);
+  // Frontend falls back to the embedded one without LittleFS, so don't abort
+  ESP_ERROR_CHECK_WITHOUT_ABORT(
+    invoke_on_core(PRO_CPU_NUM, mem::littlefs::init));
   ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, drv::anlg::init));
   static_assert(APP_CPU_NUM == drv::anlg::adc_task.core_id &&
                 APP_CPU_NUM == drv::anlg::temp_task.core_id);
@@ -63,14 +71,26 @@ extern "C" void app_main() {
   ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, drv::led::init));
   if (auto const err{invoke_on_core(WIFI_TASK_CORE_ID, drv::eth::init)})
     ESP_ERROR_CHECK(invoke_on_core(WIFI_TASK_CORE_ID, drv::wifi::init));
+  ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, mw::telem::init));
+  static_assert(APP_CPU_NUM == mw::telem::task.core_id);
   ESP_ERROR_CHECK(invoke_on_core(PRO_CPU_NUM, intf::http::init));
+  static_assert(WIFI_TASK_CORE_ID == intf::http::workers.core_id);
   ESP_ERROR_CHECK(invoke_on_core(PRO_CPU_NUM, intf::udp::init));
   ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, mw::dcc::init));
   static_assert(APP_CPU_NUM == mw::dcc::task.core_id);
+  ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, mw::events::init));
+  static_assert(APP_CPU_NUM == mw::events::task.core_id);
+  ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, mw::frontend::init));
+  static_assert(APP_CPU_NUM == mw::frontend::task.core_id);
+  ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, mw::meter::init));
+  static_assert(APP_CPU_NUM == mw::meter::task.core_id);
   ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, mw::ota::init));
   static_assert(APP_CPU_NUM == mw::ota::task.core_id);
+  static_assert(APP_CPU_NUM == mw::ota::writer_task.core_id);
   ESP_ERROR_CHECK(invoke_on_core(PRO_CPU_NUM, mw::roco::z21::init));
   static_assert(APP_CPU_NUM == mw::roco::z21::task.core_id);
+  static_assert(APP_CPU_NUM == mw::roco::z21::exec_task.core_id);
+  static_assert(APP_CPU_NUM == mw::roco::z21::prog_task.core_id);
   ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, mw::zimo::zusi::init));
   ESP_ERROR_CHECK(invoke_on_core(APP_CPU_NUM, mw::zimo::decup::init));
   static_assert(APP_CPU_NUM == mw::zimo::decup::task.core_id);
@@ -108,12 +128,20 @@ static_assert(std::invoke([] {
                         drv::out::track::dcc::task.name,
                         drv::out::track::zimo::decup::task.name,
                         drv::out::track::zimo::mdu::task.name,
+                        intf::http::workers.name,
                         intf::usb::rx_task.name,
                         intf::usb::tx_task.name,
                         mem::nvs::task.name,
                         mw::dcc::task.name,
+                        mw::events::task.name,
+                        mw::frontend::task.name,
+                        mw::meter::task.name,
                         mw::ota::task.name,
+                        mw::ota::writer_task.name,
                         mw::roco::z21::task.name,
+                        mw::roco::z21::exec_task.name,
+                        mw::roco::z21::prog_task.name,
+                        mw::telem::task.name,
                         mw::zimo::decup::task.name,
                         mw::zimo::mdu::task.name,
                         mw::zimo::ulf::dcc_ein::task.name,
@@ -0,0 +1,83 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Blocking channel
+///
+/// \file   channel.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/// Multiple producer, single consumer blocking channel
+///
+/// Channel hands values from any task to a consumer which blocks until either
+/// a value arrives or a timeout expires. Contrary to polling a queue the
+/// consumer uses no CPU time at all while waiting.
+///
+/// \tparam T Type
+template<typename T>
+class Channel {
+public:
+  /// Push value and wake up consumer
+  ///
+  /// \param  value Value
+  void push(T&& value) {
+    {
+      std::scoped_lock lock{_mutex};
+      _values.push_back(std::move(value));
+    }
+    _cv.notify_one();
+  }
+
+  /// Pop value, wait for one if necessary
+  ///
+  /// \param  timeout   Timeout
+  /// \return Value
+  /// \return std::nullopt if no value arrived in time
+  std::optional<T> pop(std::chrono::milliseconds timeout = {}) {
+    std::unique_lock lock{_mutex};
+    if (!_cv.wait_for(lock, timeout, [this] { return !empty(_values); }))
+      return std::nullopt;
+    std::optional<T> value{std::move(_values.front())};
+    _values.pop_front();
+    return value;
+  }
+
+  /// Remove all values
+  void clear() {
+    std::scoped_lock lock{_mutex};
+    _values.clear();
+  }
+
+  /// Number of values
+  ///
+  /// \return Number of values
+  size_t size() const {
+    std::scoped_lock lock{_mutex};
+    return std::size(_values);
+  }
+
+private:
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<T> _values;
+};
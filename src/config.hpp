@@ -29,6 +29,7 @@
 #include <freertos/stream_buffer.h>
 #include <hal/gpio_types.h>
 #include <static_math/static_math.h>
+#include <array>
 #include <atomic>
 #include <climits>
 #include <dcc/dcc.hpp>
@@ -42,6 +43,7 @@
 #include <ztl/limits.hpp>
 #include <ztl/moving_average.hpp>
 #include <ztl/string.hpp>
+#include "seqlock.hpp"
 #include "task.hpp"
 
 #if CONFIG_IDF_TARGET_ESP32S3
@@ -170,9 +172,10 @@ enum class State : uint16_t {
   ULF_SUSIV2 = 10u << CHAR_BIT, ///< ULF_SUSIV2 USB mode
 
   // System
-  OTA = 11u << CHAR_BIT, ///< OTA update
+  OTA = 11u << CHAR_BIT,      ///< OTA update
+  Frontend = 12u << CHAR_BIT, ///< Frontend update
 };
-static_assert(std::to_underlying(State::OTA) < MAGIC_ENUM_RANGE_MAX);
+static_assert(std::to_underlying(State::Frontend) < MAGIC_ENUM_RANGE_MAX);
 
 ZTL_MAKE_ENUM_CLASS_FLAGS(State)
 
@@ -314,6 +317,26 @@ inline struct TemperatureQueue {
   static inline QueueHandle_t handle{};
 } temperature_queue;
 
+/// Track energy per operating mode [nJ]
+///
+/// Index 0 holds the energy consumed while no operating mode was active.
+using Energies =
+  std::array<uint64_t, (std::to_underlying(State::Frontend) >> CHAR_BIT) + 1uz>;
+
+/// Get index of operating mode into energy counters
+///
+/// \param  s State
+/// \return Index
+constexpr size_t state2energies_index(State s) {
+  return std::to_underlying(s) >> CHAR_BIT;
+}
+
+/// Number of conversion frames after which energies get published (~100ms)
+inline constexpr auto energies_publish_frames{100uz};
+
+/// Latest energy counters
+inline Seqlock<Energies> energies;
+
 } // namespace anlg
 
 namespace eth {
@@ -498,6 +521,64 @@ inline httpd_handle_t handle{};
 ///
 inline constexpr auto stack_size{6144uz};
 
+/// Number of outbound WebSocket messages which can be queued at once
+inline constexpr auto message_pool_size{32uz};
+
+/// Maximum number of outbound WebSocket messages queued per client
+inline constexpr auto outbox_depth{8uz};
+
+/// Maximum number of acknowledge frames queued per client
+inline constexpr auto outbox_ack_depth{16uz};
+
+/// Payload capacity reserved per outbound WebSocket message
+inline constexpr auto message_payload_capacity{128uz};
+
+/// Number of inbound WebSocket payloads kept for reuse
+inline constexpr auto payload_pool_size{8uz};
+
+/// Largest capacity of inbound WebSocket payloads kept for reuse
+inline constexpr auto payload_pool_max_capacity{8192uz};
+
+/// Buffer size used to send chunked responses
+inline constexpr auto response_chunk_size{1024uz};
+
+/// Buffer size used to stream files
+inline constexpr auto file_chunk_size{4096uz};
+
+/// JSON responses smaller than this are never compressed
+inline constexpr auto compression_threshold{1024uz};
+
+/// LZ77 window used to compress JSON responses, each compressed response
+/// allocates about 6 times this size
+inline constexpr auto compression_window_size{2048uz};
+
+/// Workers handling HTTP requests off the server task
+inline TASK_POOL(workers,
+                 "intf::http::worker",  // Name
+                 2uz,                   // Number of tasks
+                 stack_size,            // Stack size
+                 tskIDLE_PRIORITY + 5u, // Priority (same as server task)
+                 WIFI_TASK_CORE_ID,     // Core
+                 0u);
+
+/// HTTP requests waiting for a worker
+inline struct WorkQueue {
+  static constexpr auto size{8uz};
+  static inline QueueHandle_t handle{};
+} work_queue;
+
+/// Maximum number of HTTP requests per endpoint which can be queued or
+/// handled at once
+inline constexpr auto endpoint_queue_limit{4uz};
+
+/// Endpoints overriding \ref endpoint_queue_limit
+inline constexpr std::array<std::pair<std::string_view, size_t>, 3uz>
+  endpoint_queue_limits{{
+    {"/dcc/locos/", 2uz},
+    {"/dcc/turnouts/", 2uz},
+    {"/settings/", 1uz}, // NVS writes
+  }};
+
 namespace sta {
 
 class Server;
@@ -516,7 +597,9 @@ inline std::string str;
 namespace udp {
 
 inline constexpr uint16_t port{21105u};
-inline int sock_fd;
+
+/// IPv4 and IPv6 sockets bound to \ref port, -1 if not available
+inline std::array<int, 2uz> sock_fds{-1, -1};
 
 } // namespace udp
 
@@ -559,6 +642,25 @@ inline struct TxStreamBuffer {
 
 namespace mem {
 
+namespace littlefs {
+
+/// Label of LittleFS partition
+inline constexpr auto partition_label{"data"};
+
+/// Mount point of LittleFS partition
+inline constexpr auto base_path{"/data"};
+
+/// Directory containing the frontend
+inline constexpr auto frontend_path{"/data/frontend"};
+
+/// Directory uploaded frontends get extracted to
+inline constexpr auto frontend_staging_path{"/data/frontend.new"};
+
+/// Directory the previous frontend gets moved to while swapping
+inline constexpr auto frontend_backup_path{"/data/frontend.old"};
+
+} // namespace littlefs
+
 namespace nvs {
 
 ///
@@ -579,6 +681,24 @@ namespace dcc {
 
 inline constexpr auto priority_bits{5u};
 
+/// Minimum time between two broadcasts of the same kind [ms]
+inline constexpr auto loco_info_interval{100u};
+inline constexpr auto turnout_info_interval{100u};
+inline constexpr auto railcom_data_interval{500u};
+
+/// Minimum time between two NVS writes of changed locos and turnouts [ms]
+inline constexpr auto nvs_interval{1000u};
+
+/// Maximum number of deleted addresses remembered for delta queries
+inline constexpr auto max_tombstones{64uz};
+
+/// Number of revisions reserved at once in NVS
+inline constexpr auto revision_block{1u << 16u};
+
+/// Loco and turnout JSON cache statistics
+inline std::atomic<uint32_t> json_cache_hits;
+inline std::atomic<uint32_t> json_cache_misses;
+
 class Service;
 inline std::shared_ptr<Service> service;
 
@@ -604,6 +724,63 @@ inline TASK(task,
 
 } // namespace disp
 
+namespace events {
+
+///
+inline TASK(task,
+            "mw::events",     // Name
+            4096uz,           // Stack size
+            tskIDLE_PRIORITY, // Priority
+            APP_CPU_NUM,      // Core
+            250u);            // Timeout
+
+/// Minimum time between two system state events [ms]
+inline constexpr auto sys_interval{1000u};
+
+/// Size after which loco and turnout events get split into pages [B]
+inline constexpr auto max_event_size{1024uz};
+
+/// Number of subscribed clients
+inline std::atomic<uint32_t> clients;
+
+} // namespace events
+
+namespace frontend {
+
+///
+inline constexpr uint8_t ack{0x06u};
+
+///
+inline constexpr uint8_t nak{0x15u};
+
+///
+inline TASK(task,
+            "mw::frontend",   // Name
+            4096uz,           // Stack size
+            tskIDLE_PRIORITY, // Priority
+            APP_CPU_NUM,      // Core
+            0u);              // Timeout
+
+} // namespace frontend
+
+namespace meter {
+
+///
+inline TASK(task,
+            "mw::meter",      // Name
+            3072uz,           // Stack size
+            tskIDLE_PRIORITY, // Priority
+            APP_CPU_NUM,      // Core
+            1000u);           // Timeout
+
+/// Interval in which counters get persisted [s]
+inline constexpr auto persist_interval{300u};
+
+/// Age after which RailCom speeds are considered stale [ms]
+inline constexpr auto bidi_speed_max_age{2000u};
+
+} // namespace meter
+
 namespace ota {
 
 ///
@@ -620,6 +797,27 @@ inline TASK(task,
             APP_CPU_NUM,            // Core
             0u);
 
+/// Writes chunks of windowed uploads to flash
+///
+/// A single chunk of a delta patch can copy megabytes of the running image,
+/// hence the generous timeout.
+inline TASK(writer_task,
+            "mw::ota::writer",      // Name
+            4096uz,                 // Stack size
+            ESP_TASK_PRIO_MAX - 1u, // Priority
+            APP_CPU_NUM,            // Core
+            30000u);                // Timeout
+
+/// Number of chunks a client may send ahead without waiting for an ack
+inline constexpr auto window_size{4uz};
+
+/// Interval in which progress of resumable uploads gets persisted [bytes]
+inline constexpr auto checkpoint_interval{64uz * 1024uz};
+static_assert(checkpoint_interval % 4096uz == 0uz);
+
+/// Size of buffer delta patches copy the running image through [bytes]
+inline constexpr auto patch_buffer_size{1024uz};
+
 } // namespace ota
 
 namespace roco::z21 {
@@ -632,11 +830,102 @@ inline TASK(task,
             APP_CPU_NUM,     // Core
             500u);           // Timeout
 
+///
+inline TASK(exec_task,
+            "mw::roco::z21::exec", // Name
+            6144uz,                // Stack size
+            5u,                    // Priority
+            APP_CPU_NUM,           // Core
+            500u);                 // Timeout
+
+///
+inline TASK(prog_task,
+            "mw::roco::z21::prog", // Name
+            4096uz,                // Stack size
+            4u,                    // Priority
+            APP_CPU_NUM,           // Core
+            0u);                   // Timeout
+
+/// Maximum number of datagrams read from a single socket per wakeup
+inline constexpr auto max_datagrams_per_socket{16uz};
+
+/// Maximum number of received datagrams waiting for execution
+inline constexpr auto max_queued_datagrams{64uz};
+
+/// Maximum number of POM requests waiting for execution
+inline constexpr auto max_queued_pom_requests{8uz};
+
+/// Time outbound datasets are held back to be sent as single datagram [us]
+inline constexpr auto aggregation_window{2000u};
+
+/// Maximum payload of an aggregated datagram (Ethernet MTU - IPv4 and UDP)
+inline constexpr auto aggregation_mtu{1472uz};
+
+/// Time after which a silent UDP client gets logged off [ms]
+inline constexpr auto udp_client_timeout{60'000u};
+
+/// Time after which a silent WebSocket client gets pinged [ms]
+inline constexpr auto ws_ping_interval{20'000u};
+
+/// Time after which a silent WebSocket client gets closed [ms]
+inline constexpr auto ws_client_timeout{30'000u};
+
+/// Interval at which clients are checked for timeouts [ms]
+inline constexpr auto client_check_interval{1000u};
+
+/// Client statistics
+inline std::atomic<uint32_t> active_clients;
+inline std::atomic<uint32_t> reaped_clients;
+
+/// Receive statistics
+inline std::atomic<uint32_t> wakeups;
+inline std::atomic<uint32_t> datagrams;
+inline std::atomic<uint32_t> max_datagrams_per_wakeup;
+inline std::atomic<uint32_t> ingress_drops;
+
+/// Transmit statistics
+inline std::atomic<uint32_t> datagrams_saved;
+
 class Service;
 inline std::shared_ptr<Service> service;
 
 } // namespace roco::z21
 
+namespace telem {
+
+///
+inline TASK(task,
+            "mw::telem", // Name
+            3072uz,      // Stack size
+            1u,          // Priority
+            APP_CPU_NUM, // Core
+            100u);       // Timeout
+
+/// Telemetry snapshot
+///
+/// All measurements are already converted into SI units, so consumers don't
+/// have to touch any queue or driver.
+struct Snapshot {
+  uint32_t version{};         ///< Incremented on every update
+  State state{};              ///< \ref state "State"
+  int16_t vcc_voltage{};      ///< VCC voltage [mV]
+  int16_t supply_voltage{};   ///< Supply voltage [mV]
+  int16_t current{};          ///< Latest current sample [mA]
+  int16_t filtered_current{}; ///< Filtered current [mA]
+  float temperature{};        ///< Temperature [°C]
+  int8_t rssi{};              ///< RSSI [dBm]
+  bool rssi_valid{};          ///< RSSI is only valid for WiFi
+  uint32_t heap{};            ///< Free heap [B]
+  uint32_t internal_heap{};   ///< Free internal heap [B]
+  uint32_t update_time{};     ///< Time taken by last update [us]
+  uint32_t max_update_time{}; ///< Maximum time taken by update [us]
+};
+
+/// Latest telemetry snapshot
+inline Seqlock<Snapshot> snapshot;
+
+} // namespace telem
+
 namespace zimo {
 
 namespace decup {
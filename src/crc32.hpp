@@ -0,0 +1,48 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// CRC-32
+///
+/// \file   crc32.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// CRC-32 as used by gzip, zip and PNG (reflected polynomial 0xEDB88320)
+///
+/// \param  crc   CRC of previous bytes (0 for the first call)
+/// \param  s     Pointer to bytes
+/// \param  n     Number of bytes
+/// \return CRC
+constexpr uint32_t crc32(uint32_t crc, uint8_t const* s, size_t n) {
+  constexpr auto table{[] {
+    std::array<uint32_t, 256uz> t{};
+    for (auto i{0u}; i < size(t); ++i) {
+      auto c{i};
+      for (auto j{0uz}; j < 8uz; ++j)
+        c = c & 1u ? 0xEDB8'8320u ^ (c >> 1u) : c >> 1u;
+      t[i] = c;
+    }
+    return t;
+  }()};
+  crc = ~crc;
+  for (auto i{0uz}; i < n; ++i) crc = table[(crc ^ s[i]) & 0xFFu] ^ (crc >> 8u);
+  return ~crc;
+}
@@ -512,7 +512,7 @@
 /// | ota_0   | app  | ota_0    | 6M     | First application partition (toggles to second on successful update) |
 /// | ota_1   | app  | ota_1    | 6M     | Second application partition (toggles to first on successful update) |
 /// | nvs     | data | nvs      | 6M     | Stores settings, locomotives and accessories                         |
-/// | data    | data | littlefs | 14272K | Stores additional data (e.g. images)                                 |
+/// | data    | data | littlefs | 14272K | Stores additional data (e.g. web frontend)                           |
 // clang-format on
 /// \page page_config Configuration
 /// \details \tableofcontents
@@ -524,7 +524,8 @@
 ///
 /// \subsection subsection_config_ota OTA
 /// The `ota_0` and `ota_1` entries are the actual app partitions, i.e. the
-/// complete firmware **including the frontend** is stored here. The
+/// complete firmware **including the frontend** (unless built with
+/// `OPENREMISE_FRONTEND_EMBED=OFF`) is stored here. The
 /// abbreviation
 /// [OTA](https://docs.espressif.com/projects/esp-idf/en/\idf_ver/esp32s3/api-reference/system/ota.html)
 /// refers to the so-called <b>O</b>ver <b>T</b>he <b>A</b>ir update capability
@@ -540,9 +541,12 @@
 /// are included when flashing a firmware.
 ///
 /// \subsection subsection_config_data Data
-/// The data partition is currently reserved but unused. It is planned to use a
+/// The data partition contains a
 /// [LittleFS](https://docs.espressif.com/projects/esp-idf/en/\idf_ver/esp32s3/api-guides/file-system-considerations.html#littlefs-fs-section)
-/// file system for this partition.
+/// file system. It can hold the web frontend, which can then be updated
+/// independently of the firmware through the `/frontend/` endpoint (see
+/// \ref page_mw_frontend). Files stored there take precedence over the
+/// embedded ones.
 ///
 /// \section section_config_performance Performance
 /// To ensure that the firmware runs smoothly, there are a few important points
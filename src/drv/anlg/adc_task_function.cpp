@@ -22,6 +22,7 @@
 #include <driver/gpio.h>
 #include <span>
 #include <ztl/fixed_string.hpp>
+#include "convert.hpp"
 #include "drv/led/bug.hpp"
 #include "init.hpp"
 #include "log.h"
@@ -42,6 +43,12 @@ uint8_t short_circuit_time{};
 
 namespace {
 
+/// Sums of all voltage and current samples of a conversion frame
+struct FrameSums {
+  int32_t supply_voltage{};
+  int32_t current{};
+};
+
 /// Send item to queue (even if full)
 ///
 /// Small FreeRTOS-style helper to post an item on a queue. As long as there is
@@ -125,11 +132,14 @@ esp_err_t detect_revision(std::span<uint8_t> stack) {
 /// \tparam revision          Hardware revision
 /// \param  conversion_frame  Conversion frame
 /// \param  filtered_current  Filtered current
+/// \param  sums              Sums of supply voltage and current samples
 /// \return Number of current samples indicating short circuit
 template<ztl::fixed_string revision>
 size_t parse(std::span<uint8_t const> conversion_frame,
-             FilteredCurrent& filtered_current) {
+             FilteredCurrent& filtered_current,
+             FrameSums& sums) {
   size_t short_circuit_count{};
+  sums = {};
   for (auto i{0uz}; i < size(conversion_frame);
        i += SOC_ADC_DIGI_RESULT_BYTES) {
     auto const output{
@@ -142,12 +152,14 @@ size_t parse(std::span<uint8_t const> conversion_frame,
         break;
       case supply_voltage_channel:
         xQueueSendOverwriteOldest(supply_voltages_queue.handle, &data);
+        sums.supply_voltage += data;
         if constexpr (ztl::strcmp(revision.c_str(), "0.1.2"))
           xQueueSendOverwriteOldest(vcc_voltages_queue.handle, &data);
         break;
       case current_channel:
         xQueueSendOverwriteOldest(currents_queue.handle, &data);
         filtered_current += data;
+        sums.current += data;
         short_circuit_count += data == max_measurement;
         break;
       default: assert(false); break;
@@ -158,6 +170,38 @@ size_t parse(std::span<uint8_t const> conversion_frame,
   return short_circuit_count;
 }
 
+/// Integrate track energy
+///
+/// The mean supply voltage and current of a conversion frame get converted to
+/// SI units once and multiplied, so the cost per frame stays constant. The
+/// resulting energy is added to the counter of the currently active operating
+/// mode. Every \ref energies_publish_frames "n" frames the counters get
+/// published to \ref energies.
+///
+/// \param  sums      Sums of supply voltage and current samples
+/// \param  counters  Energy counters
+void integrate_energy(FrameSums const& sums, Energies& counters) {
+  static constexpr auto n{
+    static_cast<int32_t>(conversion_frame_samples_per_channel)};
+  static size_t frame_count{};
+
+  auto const mV{measurement2mV(
+    SupplyVoltageMeasurement(static_cast<int16_t>(sums.supply_voltage / n)))};
+  auto const mA{measurement2mA(
+    CurrentMeasurement(static_cast<int16_t>(sums.current / n)))};
+
+  // [mV] * [mA] * [us] = [pJ]
+  auto const pJ{static_cast<uint64_t>(std::max<int32_t>(mV, 0)) *
+                static_cast<uint64_t>(std::max<int32_t>(mA, 0)) *
+                conversion_frame_time};
+  counters[state2energies_index(state.load())] += pJ / 1000u;
+
+  if (++frame_count >= energies_publish_frames) {
+    frame_count = 0uz;
+    energies.store(counters);
+  }
+}
+
 /// Detect short circuits
 ///
 /// \param  short_circuit_count Number of current samples indicating short
@@ -180,7 +224,8 @@ void detect_short_circuit(uint8_t short_circuit_count) {
   if (short_circuit_time >= nvs_short_circuit_time.load()) {
     state.store(State::ShortCircuit);
     led::bug(true);
-    mw::roco::z21::service->broadcastTrackShortCircuit();
+    mw::roco::z21::service->post(
+      [] { mw::roco::z21::service->broadcastTrackShortCircuit(); });
   }
 }
 
@@ -229,7 +274,9 @@ void adc_task_notify_resume() {
 /// vcc_voltages_queue "VCC voltages",
 /// \ref supply_voltages_queue "supply voltages",
 /// \ref currents_queue "currents" and
-/// \ref filtered_current_queue "filtered current" queue.
+/// \ref filtered_current_queue "filtered current" queue. The product of
+/// voltage and current is integrated over time into the \ref energies
+/// "energy counters".
 ///
 /// If the measured currents indicate a short circuit, the \ref led::bug
 /// "bug LED" is switched on, \ref state is set to \ref State::ShortCircuit
@@ -238,6 +285,8 @@ void adc_task_notify_resume() {
 [[noreturn]] void adc_task_function(void*) {
   std::array<uint8_t, conversion_frame_size> stack;
   FilteredCurrent filtered_current;
+  FrameSums sums;
+  Energies energy_counters{};
 
   // Detect hardware revision by trying to measure VCC
   ESP_ERROR_CHECK(detect_revision(stack));
@@ -254,7 +303,10 @@ void adc_task_notify_resume() {
 
     // Parse conversion frame
     auto const short_circuit_count{
-      parse_fn(conversion_frame, filtered_current)};
+      parse_fn(conversion_frame, filtered_current, sums)};
+
+    // Integrate energy
+    integrate_energy(sums, energy_counters);
 
     // Detect short circuits
     detect_short_circuit(short_circuit_count);
@@ -36,7 +36,7 @@ namespace intf {
 /// | \subpage page_intf_dns  | \ref dns  | Register DNS services                                                              |
 /// | \subpage page_intf_http | \ref http | Access point (AP) and station (STA) HTTP servers                                   |
 /// | \subpage page_intf_mdns | \ref mdns | Register mDNS services                                                             |
-/// | \subpage page_intf_udp  | \ref udp  | Create and bind UDP socket                                                         |
+/// | \subpage page_intf_udp  | \ref udp  | Create and bind UDP sockets                                                        |
 /// | \subpage page_intf_usb  | \ref usb  | Create [CDC](https://en.wikipedia.org/wiki/USB_communications_device_class) device |
 // clang-format on
 /// \page page_intf Interface
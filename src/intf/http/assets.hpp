@@ -0,0 +1,169 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Static asset table
+///
+/// \file   intf/http/assets.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <utility>
+
+namespace intf::http {
+
+/// Embedded (gzip compressed) frontend file
+struct Asset {
+  std::string_view uri{};      ///< Path relative to web root
+  char const* type{};          ///< Content type
+  char const* etag{};          ///< Strong entity tag (quoted)
+  char const* cache_control{}; ///< Cache-Control header
+  char const* start{};         ///< Start of embedded binary
+  char const* end{};           ///< End of embedded binary
+};
+
+/// Get content type from file extension
+///
+/// \param  path  File path
+/// \return Content type
+constexpr char const* content_type(std::string_view path) {
+  using namespace std::literals;
+  constexpr std::array types{
+    std::pair{".bin"sv, "application/octet-stream"},
+    std::pair{".css"sv, "text/css"},
+    std::pair{".gif"sv, "image/gif"},
+    std::pair{".html"sv, "text/html"},
+    std::pair{".ico"sv, "image/vnd.microsoft.icon"},
+    std::pair{".js"sv, "text/javascript"},
+    std::pair{".json"sv, "application/json"},
+    std::pair{".otf"sv, "font/otf"},
+    std::pair{".png"sv, "image/png"},
+    std::pair{".svg"sv, "image/svg+xml"},
+    std::pair{".ttf"sv, "font/ttf"},
+    std::pair{".wasm"sv, "application/wasm"},
+  };
+  auto const it{std::ranges::find_if(
+    types, [path](auto&& t) { return path.ends_with(t.first); })};
+  return it != cend(types) ? it->second : "text/html";
+}
+
+/// Check whether file name contains a content hash
+///
+/// A content hash is any dot or dash separated part of the file name which
+/// consists of at least 8 hex digits (e.g. main.3f2a9c1d.js).
+///
+/// \param  path  File path
+/// \retval true  File name contains content hash
+/// \retval false File name contains no content hash
+constexpr bool is_hashed(std::string_view path) {
+  auto name{path.substr(path.find_last_of('/') + 1uz)};
+  while (!empty(name)) {
+    auto const n{std::min(name.find_first_of(".-"), size(name))};
+    if (n >= 8uz && std::ranges::all_of(name.substr(0uz, n), [](char c) {
+          return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+                 (c >= 'A' && c <= 'F');
+        }))
+      return true;
+    name.remove_prefix(std::min(n + 1uz, size(name)));
+  }
+  return false;
+}
+
+/// Get Cache-Control header for file
+///
+/// Files with a content hash in their name never change and may be cached
+/// forever. Everything else must be revalidated using its ETag.
+///
+/// \param  path  File path
+/// \return Cache-Control header
+constexpr char const* cache_control(std::string_view path) {
+  return is_hashed(path) ? "public, max-age=31536000, immutable" : "no-cache";
+}
+
+/// Create sorted asset table from embedded files
+///
+/// \tparam N       Number of embedded files
+/// \param  embeds  Path, ETag, start and end of each embedded file
+/// \return Asset table sorted by path
+template<size_t N>
+constexpr std::array<Asset, N>
+make_assets(std::array<std::array<char const*, 4uz>, N> const& embeds) {
+  std::array<Asset, N> assets;
+  std::ranges::transform(embeds, begin(assets), [](auto&& embed) {
+    auto const& [uri, etag, start, end]{embed};
+    return Asset{.uri = uri,
+                 .type = content_type(uri),
+                 .etag = etag,
+                 .cache_control = cache_control(uri),
+                 .start = start,
+                 .end = end};
+  });
+  std::ranges::sort(assets, {}, &Asset::uri);
+  return assets;
+}
+
+/// Get path relative to web root from request URI
+///
+/// Leading slashes, query strings and fragments are removed.
+///
+/// \param  uri Request URI
+/// \return Path relative to web root
+constexpr std::string_view normalize_uri(std::string_view uri) {
+  uri = uri.substr(0uz, uri.find_first_of("?#"));
+  uri.remove_prefix(std::min(uri.find_first_not_of('/'), size(uri)));
+  return uri;
+}
+
+/// Find asset for request URI
+///
+/// \tparam N       Number of assets
+/// \param  assets  Asset table sorted by path
+/// \param  uri     Request URI
+/// \return Pointer to asset or nullptr if not found
+template<size_t N>
+constexpr Asset const* find_asset(std::array<Asset, N> const& assets,
+                                  std::string_view uri) {
+  uri = normalize_uri(uri);
+  auto const it{std::ranges::lower_bound(assets, uri, {}, &Asset::uri)};
+  return it != cend(assets) && it->uri == uri ? &*it : nullptr;
+}
+
+/// Check whether If-None-Match header matches ETag
+///
+/// If-None-Match uses the weak comparison, so W/ prefixes are ignored.
+///
+/// \param  if_none_match If-None-Match header
+/// \param  etag          Strong entity tag (quoted)
+/// \retval true          Header matches
+/// \retval false         Header does not match
+constexpr bool etag_match(std::string_view if_none_match,
+                          std::string_view etag) {
+  while (!empty(if_none_match)) {
+    auto const n{std::min(if_none_match.find(','), size(if_none_match))};
+    auto tag{if_none_match.substr(0uz, n)};
+    tag.remove_prefix(std::min(tag.find_first_not_of(' '), size(tag)));
+    tag = tag.substr(0uz, tag.find_last_not_of(' ') + 1uz);
+    if (tag.starts_with("W/")) tag.remove_prefix(2uz);
+    if (tag == "*" || tag == etag) return true;
+    if_none_match.remove_prefix(std::min(n + 1uz, size(if_none_match)));
+  }
+  return false;
+}
+
+} // namespace intf::http
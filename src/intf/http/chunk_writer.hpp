@@ -0,0 +1,122 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Chunked JSON serialization
+///
+/// \file   intf/http/chunk_writer.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <optional>
+#include "response.hpp"
+
+namespace intf::http {
+
+/// ArduinoJson writer which sends its output in chunks of up to N bytes
+///
+/// Output gets collected in a fixed buffer, which is handed to \ref Send
+/// whenever it's full. Once sending fails, any further output is discarded.
+///
+/// \tparam N Buffer size
+template<size_t N>
+class ChunkWriter {
+public:
+  explicit ChunkWriter(Send const& send) : _send{send} {}
+
+  /// Write single byte
+  ///
+  /// \param  c Byte
+  /// \return Number of bytes written
+  size_t write(uint8_t c) { return write(&c, 1uz); }
+
+  /// Write bytes
+  ///
+  /// \param  s Pointer to bytes
+  /// \param  n Number of bytes
+  /// \return Number of bytes written
+  size_t write(uint8_t const* s, size_t n) {
+    for (auto i{0uz}; i < n && _ok;) {
+      auto const count{std::min(n - i, N - _size)};
+      std::copy_n(s + i, count, begin(_buf) + _size);
+      _size += count;
+      i += count;
+      if (_size == N) flush();
+    }
+    return _ok ? n : 0uz;
+  }
+
+  /// Send buffered bytes
+  ///
+  /// \retval true  All bytes sent
+  /// \retval false Sending failed
+  bool flush() {
+    if (_ok && _size) _ok = _send({data(_buf), _size});
+    _size = 0uz;
+    return _ok;
+  }
+
+  /// Check whether sending has failed so far
+  ///
+  /// \retval true  No failures
+  /// \retval false Sending failed
+  bool ok() const { return _ok; }
+
+private:
+  Send const& _send;
+  std::array<char, N> _buf;
+  size_t _size{};
+  bool _ok{true};
+};
+
+/// Serialize JSON array element by element
+///
+/// Produces exactly the same output as serializing a single JsonDocument
+/// containing all elements. Only one element is kept in memory at any time,
+/// so peak memory doesn't depend on the number of elements.
+///
+/// Elements are either JsonDocuments or already serialized strings, which get
+/// copied as is.
+///
+/// \tparam N     Buffer size
+/// \tparam F     Callable returning next element or std::nullopt at the end
+/// \param  send  Function sending a single chunk
+/// \param  next  Callable returning next element or std::nullopt at the end
+/// \retval true  All chunks sent
+/// \retval false Sending failed
+template<size_t N, std::invocable F>
+bool serialize_json_array(Send const& send, F&& next) {
+  ChunkWriter<N> writer{send};
+  writer.write('[');
+  for (auto first{true}; writer.ok(); first = false) {
+    auto const element{next()};
+    if (!element) break;
+    if (!first) writer.write(',');
+    if constexpr (std::convertible_to<decltype(*element), std::string_view>) {
+      std::string_view const str{*element};
+      writer.write(std::bit_cast<uint8_t const*>(data(str)), size(str));
+    } else serializeJson(*element, writer);
+  }
+  writer.write(']');
+  return writer.flush();
+}
+
+} // namespace intf::http
@@ -62,19 +62,23 @@ namespace intf::http {
 ///   - POST
 /// - /dcc/locos/
 ///   - DELETE
-///   - GET
-///   - PUT
+///   - GET (`?since=<revision>` only returns changes)
+///   - PUT (array on collection imports all items at once)
 /// - /dcc/turnouts/
 ///   - DELETE
-///   - GET
-///   - PUT
+///   - GET (`?since=<revision>` only returns changes)
+///   - PUT (array on collection imports all items at once)
+/// - /events/
+///   - WebSocket (pushes state changes)
+/// - /frontend/
+///   - WebSocket (uploads frontend to LittleFS)
 /// - /settings/
 ///   - GET
 ///   - POST
 /// - /sys/
 ///   - GET
 /// - /*
-///   - GET
+///   - GET (`If-None-Match` gets `304 Not Modified`)
 ///
 /// WebSockets?
 ///
@@ -84,8 +88,43 @@ namespace intf::http {
 /// be specified. Furthermore, a distinction is made between synchronous (HTTP)
 /// and asynchronous (WebSocket) connections.
 ///
-/// Both subscription types are stored in a `std::map` with a custom key
-/// comparator.
+/// Both subscription types are stored in a prefix trie with one root per
+/// method and one node per path segment. Routing walks the URI once and stops
+/// at the query or the last segment. The last segment (e.g. the address in
+/// `/dcc/locos/3`) is parsed during routing and passed on with the request.
+/// HTTP endpoints take a single subscriber, WebSocket messages get fanned out
+/// to all subscribers.
+///
+/// \subsection subsection_intf_http_sta_workers Workers
+/// Synchronous requests are not handled by the server task itself. Instead
+/// they get detached with `httpd_req_async_handler_begin` and queued for a
+/// small pool of worker tasks, so that slow endpoints (e.g. `/settings/` which
+/// writes to NVS) don't block other clients or WebSocket traffic. Each endpoint
+/// may only have a limited number of requests queued or in progress, anything
+/// above that gets answered with `503 Service Unavailable`. Pool size, queue
+/// size and limits are set in config.hpp. Requests, rejections, queue wait and
+/// service time of each endpoint are reported by `/sys/`.
+///
+/// \subsection subsection_intf_http_sta_compression Compression
+/// JSON responses of GET requests get gzip compressed on the fly if the
+/// `Accept-Encoding` header allows it. Bodies below a size threshold are sent
+/// as is, collections which are streamed in chunks are always compressed. The
+/// GzipWriter uses LZ77 over a small sliding window followed by fixed Huffman
+/// codes, so memory stays bounded and no second pass is required. Loco rosters
+/// typically shrink by a factor of 9.
+///
+/// \subsection subsection_intf_http_sta_wildcard /*
+/// The wildcard GET endpoint serves the frontend, which is stored gzip
+/// compressed either on LittleFS or embedded into the firmware. Files on
+/// LittleFS take precedence and are streamed in chunks. At build time a table
+/// containing path and strong ETag (a hash of the compressed content) of each
+/// embedded file gets generated. Content type and Cache-Control header are
+/// derived from the path at compile time and the table is sorted, so that a
+/// request only costs a binary search. Files with a content hash in their name
+/// may be cached forever, everything else has to be revalidated.
+///
+/// \subsection subsection_intf_http_sta_outbox Outbox
+/// \copydetails Outbox
 ///
 /// <div class="section_buttons">
 /// | Previous           | Next                |
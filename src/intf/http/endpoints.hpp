@@ -22,12 +22,17 @@
 #pragma once
 
 #include <esp_http_server.h>
+#include <algorithm>
 #include <cassert>
+#include <charconv>
 #include <concepts>
+#include <cstdint>
 #include <functional>
-#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <ztl/fail.hpp>
 #include <ztl/type_traits.hpp>
@@ -39,107 +44,320 @@
 
 namespace intf::http {
 
+/// HTTP and WebSocket endpoints
 ///
+/// Subscriptions are stored in a prefix trie with one root per method and one
+/// node per path segment. Routing a request walks its URI once, the segment
+/// after the last slash (e.g. a loco address) is parsed on the way.
 class Endpoints {
-  using key_type = httpd_uri_t;
+public:
+  /// Instrumentation of an HTTP endpoint
+  struct Stats {
+    uint32_t requests{};       ///< Handled requests
+    uint32_t rejected{};       ///< Requests rejected due to queue limit
+    uint32_t pending{};        ///< Requests queued or being handled
+    uint32_t limit{};          ///< Queue limit
+    uint64_t wait_us{};        ///< Total time spent waiting for a worker
+    uint64_t service_us{};     ///< Total time spent handling
+    uint32_t max_wait_us{};    ///< Longest time spent waiting for a worker
+    uint32_t max_service_us{}; ///< Longest time spent handling
+  };
 
-  /// Mapped type for HTTP requests
-  using sync_mapped_type = std::vector<std::function<Response(Request const&)>>;
+private:
+  using key_type = httpd_uri_t;
 
-  /// Mapped type for WebSockets
-  using async_mapped_type = std::vector<std::function<esp_err_t(Message&)>>;
+  /// Node of the route trie
+  struct Node {
+    std::string segment{};          ///< Path segment without slashes
+    key_type key{};                 ///< Endpoint if subscribed
+    std::vector<size_t> children{}; ///< Indices of child nodes
+    std::function<Response(Request const&)> sync{};
+    std::vector<std::function<esp_err_t(Message&)>> async{};
+    Stats stats{};
+  };
 
 public:
-  /// \todo document
+  /// Subscribe to endpoint
+  ///
+  /// HTTP endpoints take a single subscriber. WebSocket messages get fanned
+  /// out to all subscribers in order of subscription.
+  ///
+  /// \param  key Method and URI, URI must start and end with a slash
+  /// \param  t   Subscriber
+  /// \param  f   Member function of subscriber
   template<typename T, typename F>
   void subscribe(key_type const& key, std::shared_ptr<T> t, F&& f) {
-    assert(key.uri && strlen(key.uri) && key.uri[strlen(key.uri) - 1uz] == '/');
+    assert(key.uri && strlen(key.uri) && key.uri[0uz] == '/' &&
+           key.uri[strlen(key.uri) - 1uz] == '/');
+    auto& node{_nodes[insert(key)]};
     if constexpr (std::invocable<typename ztl::signature<F>::type,
                                  T*,
-                                 Request const&>)
-      _sync_map[key].push_back([t, f](auto&&... args) {
+                                 Request const&>) {
+      assert(!node.sync);
+      node.sync = [t, f](auto&&... args) {
         return std::invoke(f, *t, std::forward<decltype(args)>(args)...);
-      });
+      };
+      node.stats.limit = queue_limit(key.uri);
+    }
     else if constexpr (std::invocable<typename ztl::signature<F>::type,
                                       T*,
                                       Message&>)
-      _async_map[key].push_back([t, f](auto&&... args) {
+      node.async.push_back([t, f](auto&&... args) {
         return std::invoke(f, *t, std::forward<decltype(args)>(args)...);
       });
     else ztl::fail();
   }
 
 protected:
+  /// Routed request
+  struct Route {
+    Node* node{};                      ///< Matching node
+    std::optional<uint16_t> address{}; ///< Numeric last path segment
+  };
+
+  /// Route request
+  ///
+  /// The URI matches if everything up to its last slash (query excluded)
+  /// equals a node of the trie. The segment after the last slash is passed on
+  /// as address if it's numeric.
+  ///
+  /// \param  method  Method
+  /// \param  uri     URI
+  /// \return Route or std::nullopt if no node matches
+  std::optional<Route> route(httpd_method_t method, std::string_view uri) {
+    auto const root{std::ranges::find(_roots, method, &Root::method)};
+    if (root == cend(_roots) || !uri.starts_with('/')) return std::nullopt;
+    auto i{root->node};
+
+    // Descend one segment at a time until query or last segment is reached
+    auto first{cbegin(uri) + 1};
+    auto it{first};
+    for (; it != cend(uri) && *it != '?'; ++it) {
+      if (*it != '/') continue;
+      std::string_view const segment{first, it};
+      auto const n{i};
+      for (auto const c : _nodes[n].children)
+        if (_nodes[c].segment == segment) {
+          i = c;
+          break;
+        }
+      if (i == n) return std::nullopt;
+      first = it + 1;
+    }
+
+    //
+    Route r{.node = &_nodes[i]};
+    if (first != it) {
+      uint16_t addr{};
+      auto const last{std::to_address(it)};
+      if (auto const [ptr, ec]{
+            std::from_chars(std::to_address(first), last, addr)};
+          ec == std::errc{} && ptr == last)
+        r.address = addr;
+    }
+    return r;
+  }
+
+  /// \copydoc route
+  std::optional<Route> route(httpd_req_t* req) {
+    return route(static_cast<httpd_method_t>(req->method), req->uri);
+  }
+
   /// \todo document
   Response syncResponse(httpd_req_t* req) {
     static constexpr auto chunk_size{16384uz};
 
-    auto const key{req2key(req)};
-    auto const it{_sync_map.find(key)};
-    if (it == cend(_sync_map))
+    auto const r{route(req)};
+    if (!r || !r->node->sync)
       return std::unexpected<std::string>{"501 Not Implemented"};
 
     // Request body can be red in chunks which avoids triggering the servers
     // receive timeout
-    Request r{.uri = std::string(req->uri),
-              .body = std::string(req->content_len, '\0')};
+    Request request{.uri = std::string(req->uri),
+                    .body = std::string(req->content_len, '\0'),
+                    .address = r->address};
     int bytes_red{};
     while (bytes_red < req->content_len) {
       if (auto const tmp{
-            httpd_req_recv(req, data(r.body) + bytes_red, chunk_size)};
+            httpd_req_recv(req, data(request.body) + bytes_red, chunk_size)};
           tmp > 0)
         bytes_red += tmp;
       else return std::unexpected<std::string>{"500 Internal Server Error"};
     }
 
-    /// \todo properly iterating over vector...
-    return it->second[0uz](r);
+    return r->node->sync(request);
   }
 
   /// \todo document
   esp_err_t asyncResponse(httpd_req_t* req) {
-    auto const key{req2key(req)};
-    auto const it{_async_map.find(key)};
-    if (it == cend(_async_map)) return ESP_FAIL;
+    auto const r{route(req)};
+    if (!r || empty(r->node->async)) return ESP_FAIL;
     httpd_ws_frame_t frame{};
     if (httpd_ws_recv_frame(req, &frame, 0uz)) return ESP_FAIL;
 
     // WebSocket frame must be red in one go
     Message msg{.sock_fd = httpd_req_to_sockfd(req),
                 .type = frame.type,
-                .payload = std::vector<uint8_t>(frame.len)};
+                .payload = payload_pool.acquire(frame.len)};
     if (frame.len) {
       frame.payload = data(msg.payload);
       if (httpd_ws_recv_frame(req, &frame, frame.len)) return ESP_FAIL;
     }
 
-    return it->second[0uz](msg);
+    return asyncResponse(req, msg);
   }
 
-private:
-  /// \todo document
-  httpd_uri_t req2key(httpd_req_t* req) const {
-    return {.uri = req->uri,
-            .method = static_cast<httpd_method_t>(req->method)};
+  /// Fan WebSocket message out to all subscribers
+  ///
+  /// Subscribers are free to move from the message, so all but the last one
+  /// get a copy.
+  ///
+  /// \param  req Request
+  /// \param  msg Message
+  /// \return First error returned by any subscriber
+  esp_err_t asyncResponse(httpd_req_t* req, Message& msg) {
+    auto const r{route(req)};
+    if (!r || empty(r->node->async)) return ESP_FAIL;
+    auto const& fs{r->node->async};
+    esp_err_t retval{ESP_OK};
+    for (auto i{0uz}; i < size(fs); ++i) {
+      auto const err{[&] {
+        if (i + 1uz == size(fs)) return fs[i](msg);
+        Message cpy{msg};
+        return fs[i](cpy);
+      }()};
+      if (retval == ESP_OK) retval = err;
+    }
+    return retval;
   }
 
-  /// \todo document
-  struct key_compare {
-    bool operator()(key_type const& lhs, key_type const& rhs) const {
-      // Different method
-      if (lhs.method != rhs.method) return lhs.method < rhs.method;
-      // Compare URI up to prefix length
-      else if (auto const lhs_prefix_len{strrchr(lhs.uri, '/') - lhs.uri + 1},
-               rhs_prefix_len{strrchr(rhs.uri, '/') - rhs.uri + 1};
-               lhs_prefix_len == rhs_prefix_len)
-        return strncmp(lhs.uri, rhs.uri, lhs_prefix_len) < 0;
-      // Compare URI as is
-      else return strcmp(lhs.uri, rhs.uri) < 0;
+  /// Admit HTTP request to the worker queue
+  ///
+  /// Requests of unknown endpoints are always admitted and later answered by
+  /// \ref syncResponse.
+  ///
+  /// \param  req   Request
+  /// \retval true  Request admitted, must be followed by \ref finish
+  /// \retval false Endpoint queue limit reached
+  bool admit(httpd_req_t* req) {
+    auto const r{route(req)};
+    if (!r || !r->node->sync) return true;
+    std::scoped_lock lock{_stats_mutex};
+    auto& stats{r->node->stats};
+    if (stats.pending >= stats.limit) {
+      ++stats.rejected;
+      return false;
     }
+    ++stats.pending;
+    return true;
+  }
+
+  /// Release admitted HTTP request and record its timings
+  ///
+  /// \param  req         Request
+  /// \param  wait_us     Time spent waiting for a worker [us]
+  /// \param  service_us  Time spent handling [us]
+  void finish(httpd_req_t* req, uint32_t wait_us, uint32_t service_us) {
+    auto const r{route(req)};
+    if (!r || !r->node->sync) return;
+    std::scoped_lock lock{_stats_mutex};
+    auto& stats{r->node->stats};
+    assert(stats.pending);
+    --stats.pending;
+    ++stats.requests;
+    stats.wait_us += wait_us;
+    stats.service_us += service_us;
+    stats.max_wait_us = std::max(stats.max_wait_us, wait_us);
+    stats.max_service_us = std::max(stats.max_service_us, service_us);
+  }
+
+  /// Release admitted HTTP request which never got handled
+  ///
+  /// \param  req Request
+  void cancel(httpd_req_t* req) {
+    auto const r{route(req)};
+    if (!r || !r->node->sync) return;
+    std::scoped_lock lock{_stats_mutex};
+    auto& stats{r->node->stats};
+    assert(stats.pending);
+    --stats.pending;
+    ++stats.rejected;
+  }
+
+  /// Visit instrumentation of all HTTP endpoints
+  ///
+  /// \param  f Invocable taking endpoint and a copy of its \ref Stats
+  template<std::invocable<key_type const&, Stats const&> F>
+  void visitStats(F&& f) const {
+    for (auto const& node : _nodes) {
+      if (!node.sync) continue;
+      auto const stats{[&] {
+        std::scoped_lock lock{_stats_mutex};
+        return node.stats;
+      }()};
+      std::invoke(f, node.key, stats);
+    }
+  }
+
+private:
+  /// Root of the route trie
+  struct Root {
+    httpd_method_t method{};
+    size_t node{};
   };
 
-  std::map<key_type, sync_mapped_type, key_compare> _sync_map;
-  std::map<key_type, async_mapped_type, key_compare> _async_map;
+  /// Insert nodes of endpoint into route trie
+  ///
+  /// \param  key Method and URI
+  /// \return Index of node
+  size_t insert(key_type const& key) {
+    auto root{std::ranges::find(_roots, key.method, &Root::method)};
+    if (root == cend(_roots)) {
+      _roots.push_back({.method = key.method, .node = size(_nodes)});
+      _nodes.emplace_back();
+      root = std::prev(end(_roots));
+    }
+    auto i{root->node};
+
+    //
+    std::string_view uri{key.uri};
+    uri.remove_prefix(1uz);
+    while (!empty(uri)) {
+      auto const pos{uri.find('/')};
+      auto const segment{uri.substr(0uz, pos)};
+      auto const& children{_nodes[i].children};
+      if (auto const it{std::ranges::find_if(
+            children, [&](size_t c) { return _nodes[c].segment == segment; })};
+          it != cend(children))
+        i = *it;
+      else {
+        auto const c{size(_nodes)};
+        _nodes.push_back({.segment = std::string{segment}});
+        _nodes[i].children.push_back(c);
+        i = c;
+      }
+      uri.remove_prefix(pos + 1uz);
+    }
+
+    _nodes[i].key = key;
+    return i;
+  }
+
+  /// Queue limit of endpoint
+  ///
+  /// \param  uri URI of endpoint
+  /// \return Queue limit
+  static uint32_t queue_limit(std::string_view uri) {
+    auto const it{std::ranges::find_if(
+      endpoint_queue_limits, [uri](auto const& p) { return p.first == uri; })};
+    return static_cast<uint32_t>(it == cend(endpoint_queue_limits)
+                                   ? endpoint_queue_limit
+                                   : it->second);
+  }
+
+  std::vector<Root> _roots;
+  std::vector<Node> _nodes;
+  mutable std::mutex _stats_mutex;
 };
 
 } // namespace intf::http
@@ -0,0 +1,319 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Streaming gzip compression
+///
+/// \file   intf/http/gzip.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ranges>
+#include <string_view>
+#include "chunk_writer.hpp"
+#include "crc32.hpp"
+
+namespace intf::http {
+
+/// Check whether Accept-Encoding header allows gzip
+///
+/// \param  accept_encoding Value of Accept-Encoding header
+/// \retval true            gzip (or *) is listed without q=0
+/// \retval false           gzip is not acceptable
+constexpr bool accepts_gzip(std::string_view accept_encoding) {
+  auto const trim{[](std::string_view str) {
+    auto const first{str.find_first_not_of(" \t")};
+    if (first == std::string_view::npos) return std::string_view{};
+    return str.substr(first, str.find_last_not_of(" \t") - first + 1uz);
+  }};
+  for (auto const range : accept_encoding | std::views::split(',')) {
+    std::string_view const item{range};
+    auto const semicolon{item.find(';')};
+    auto const coding{trim(item.substr(0uz, semicolon))};
+    if (coding != "gzip" && coding != "x-gzip" && coding != "*") continue;
+    if (semicolon == std::string_view::npos) return true;
+    // Only q=0 (e.g. "q=0", "q=0.0", "q=0.000") rejects a coding
+    auto const q{trim(item.substr(semicolon + 1uz))};
+    if (!q.starts_with("q=0")) return true;
+    if (q.substr(3uz).find_first_not_of(".0") != std::string_view::npos)
+      return true;
+  }
+  return false;
+}
+
+/// Writer which compresses its output to gzip (RFC 1951, RFC 1952)
+///
+/// The compressor does LZ77 over a sliding window of WindowSize bytes with
+/// hash chains, followed by fixed Huffman codes. Compared to dynamic codes this
+/// costs a few percent of ratio on JSON, but needs neither symbol statistics
+/// nor a second pass. Memory is bounded by 4 * WindowSize bytes plus the hash
+/// table and the output buffer. Compressed output is sent in chunks of up to N
+/// bytes through a \ref ChunkWriter.
+///
+/// The writer satisfies the ArduinoJson writer interface, so JSON can be
+/// serialized directly into it.
+///
+/// \tparam N           Output buffer size
+/// \tparam WindowSize  LZ77 window size (power of 2, 512 to 32768)
+template<size_t N, size_t WindowSize>
+class GzipWriter {
+  static_assert(std::has_single_bit(WindowSize) && WindowSize >= 512uz &&
+                WindowSize <= 32768uz);
+
+  static constexpr auto min_match{3uz};
+  static constexpr auto max_match{258uz};
+  static constexpr auto max_chain{8uz};
+  static constexpr auto hash_bits{std::bit_width(WindowSize) - 1uz};
+  static constexpr auto hash_size{1uz << hash_bits};
+
+  /// Fixed Huffman code, bit reversed so that it can be written LSB first
+  struct Code {
+    uint16_t bits{};
+    uint8_t len{};
+  };
+
+  static constexpr Code reversed(uint32_t code, uint8_t len) {
+    uint32_t bits{};
+    for (auto i{0u}; i < len; ++i) bits |= (code >> i & 1u) << (len - 1u - i);
+    return {.bits = static_cast<uint16_t>(bits), .len = len};
+  }
+
+  /// Fixed literal/length codes (RFC 1951 3.2.6)
+  static constexpr auto litlen_codes{[] {
+    std::array<Code, 288uz> codes{};
+    for (auto i{0u}; i < size(codes); ++i)
+      if (i < 144u) codes[i] = reversed(0x30u + i, 8u);
+      else if (i < 256u) codes[i] = reversed(0x190u + i - 144u, 9u);
+      else if (i < 280u) codes[i] = reversed(i - 256u, 7u);
+      else codes[i] = reversed(0xC0u + i - 280u, 8u);
+    return codes;
+  }()};
+
+  static constexpr std::array<uint16_t, 29uz> length_bases{
+    3u,  4u,  5u,  6u,  7u,   8u,   9u,   10u,  11u,  13u,
+    15u, 17u, 19u, 23u, 27u,  31u,  35u,  43u,  51u,  59u,
+    67u, 83u, 99u, 115u, 131u, 163u, 195u, 227u, 258u};
+  static constexpr std::array<uint8_t, 29uz> length_extra{
+    0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 1u, 1u, 1u, 1u, 2u, 2u, 2u,
+    2u, 3u, 3u, 3u, 3u, 4u, 4u, 4u, 4u, 5u, 5u, 5u, 5u, 0u};
+  static constexpr std::array<uint16_t, 30uz> distance_bases{
+    1u,    2u,    3u,    4u,    5u,    7u,     9u,     13u,    17u,    25u,
+    33u,   49u,   65u,   97u,   129u,  193u,   257u,   385u,   513u,   769u,
+    1025u, 1537u, 2049u, 3073u, 4097u, 6145u,  8193u,  12289u, 16385u, 24577u};
+  static constexpr std::array<uint8_t, 30uz> distance_extra{
+    0u, 0u, 0u, 0u, 1u, 1u, 2u,  2u,  3u,  3u,  4u,  4u,  5u,  5u,  6u,
+    6u, 7u, 7u, 8u, 8u, 9u, 9u, 10u, 10u, 11u, 11u, 12u, 12u, 13u, 13u};
+
+  static constexpr uint16_t end_of_block{256u};
+
+public:
+  /// Ctor writes gzip header and starts first block
+  ///
+  /// \param  send  Function sending a single chunk
+  explicit GzipWriter(Send const& send) : _out{send} {
+    static constexpr std::array<uint8_t, 10uz> header{
+      0x1Fu, 0x8Bu, 0x08u, 0u, 0u, 0u, 0u, 0u, 0u, 0xFFu};
+    _out.write(data(header), size(header));
+    writeBlockHeader(false);
+  }
+
+  /// Write single byte
+  ///
+  /// \param  c Byte
+  /// \return Number of bytes written
+  size_t write(uint8_t c) { return write(&c, 1uz); }
+
+  /// Write bytes
+  ///
+  /// \param  s Pointer to bytes
+  /// \param  n Number of bytes
+  /// \return Number of bytes written
+  size_t write(uint8_t const* s, size_t n) {
+    _crc = crc32(_crc, s, n);
+    _isize += static_cast<uint32_t>(n);
+    for (auto i{0uz}; i < n && _out.ok();) {
+      if (_end == 2uz * WindowSize) slide();
+      auto const count{std::min(n - i, 2uz * WindowSize - _end)};
+      std::copy_n(s + i, count, _buf.get() + _end);
+      _end += count;
+      i += count;
+      // Only compress while a match of maximum length would still fit
+      while (_end - _pos >= max_match) compressOne();
+    }
+    return _out.ok() ? n : 0uz;
+  }
+
+  /// Write string
+  ///
+  /// \param  str String
+  /// \return Number of bytes written
+  size_t write(std::string_view str) {
+    return write(std::bit_cast<uint8_t const*>(data(str)), size(str));
+  }
+
+  /// Compress remaining input, write trailer and send buffered bytes
+  ///
+  /// \retval true  All bytes sent
+  /// \retval false Sending failed
+  bool finish() {
+    while (_pos < _end) compressOne();
+    writeCode(litlen_codes[end_of_block]);
+    // Empty final block, the first one couldn't know it's the last
+    writeBlockHeader(true);
+    writeCode(litlen_codes[end_of_block]);
+    if (_bit_count) writeBits(0u, 8u - _bit_count);
+    for (auto const v : {_crc, _isize})
+      for (auto i{0u}; i < 32u; i += 8u)
+        _out.write(static_cast<uint8_t>(v >> i));
+    return _out.flush();
+  }
+
+  /// Check whether sending has failed so far
+  ///
+  /// \retval true  No failures
+  /// \retval false Sending failed
+  bool ok() const { return _out.ok(); }
+
+private:
+  /// Move second half of buffer to the front
+  void slide() {
+    std::copy_n(_buf.get() + WindowSize, WindowSize, _buf.get());
+    _pos -= WindowSize;
+    _end -= WindowSize;
+    auto const rebase{[](uint16_t& p) {
+      p = p >= WindowSize ? static_cast<uint16_t>(p - WindowSize) : 0u;
+    }};
+    std::for_each_n(_head.get(), hash_size, rebase);
+    std::for_each_n(_prev.get(), WindowSize, rebase);
+  }
+
+  /// Emit literal or match at current position
+  void compressOne() {
+    auto const lookahead{std::min(max_match, _end - _pos)};
+    size_t best_len{};
+    size_t best_dist{};
+
+    //
+    if (lookahead >= min_match) {
+      auto const h{hash(_pos)};
+      auto cand{static_cast<size_t>(_head[h])};
+      for (auto chain{max_chain}; chain-- && cand < _pos &&
+                                  _pos - cand <= WindowSize;) {
+        auto const p{_buf.get() + _pos};
+        auto const q{_buf.get() + cand};
+        size_t len{};
+        while (len < lookahead && p[len] == q[len]) ++len;
+        if (len > best_len) {
+          best_len = len;
+          best_dist = _pos - cand;
+          if (len == lookahead) break;
+        }
+        auto const next{static_cast<size_t>(_prev[cand & (WindowSize - 1uz)])};
+        if (next >= cand) break;
+        cand = next;
+      }
+    }
+
+    //
+    if (best_len >= min_match) writeMatch(best_len, best_dist);
+    else {
+      best_len = 1uz;
+      writeCode(litlen_codes[_buf[_pos]]);
+    }
+
+    // Remember positions covered by literal or match
+    for (auto const last{_pos + best_len}; _pos < last; ++_pos)
+      if (_end - _pos >= min_match) insert(_pos);
+  }
+
+  /// Hash of next 3 bytes
+  ///
+  /// \param  pos Position
+  /// \return Hash
+  size_t hash(size_t pos) const {
+    auto const p{_buf.get() + pos};
+    auto const v{static_cast<uint32_t>(p[0uz]) << 16u |
+                 static_cast<uint32_t>(p[1uz]) << 8u | p[2uz]};
+    return (v * 0x9E37'79B1u) >> (32u - hash_bits);
+  }
+
+  /// Insert position into hash chains
+  ///
+  /// \param  pos Position
+  void insert(size_t pos) {
+    auto const h{hash(pos)};
+    _prev[pos & (WindowSize - 1uz)] = _head[h];
+    _head[h] = static_cast<uint16_t>(pos);
+  }
+
+  /// Write length/distance pair
+  ///
+  /// \param  len   Length
+  /// \param  dist  Distance
+  void writeMatch(size_t len, size_t dist) {
+    auto const l{static_cast<size_t>(
+      std::ranges::upper_bound(length_bases, len) - cbegin(length_bases) - 1)};
+    writeCode(litlen_codes[257uz + l]);
+    writeBits(static_cast<uint32_t>(len - length_bases[l]), length_extra[l]);
+    auto const d{
+      static_cast<size_t>(std::ranges::upper_bound(distance_bases, dist) -
+                          cbegin(distance_bases) - 1)};
+    writeCode(reversed(static_cast<uint32_t>(d), 5u));
+    writeBits(static_cast<uint32_t>(dist - distance_bases[d]),
+              distance_extra[d]);
+  }
+
+  /// Write block header of fixed Huffman block
+  ///
+  /// \param  final Last block
+  void writeBlockHeader(bool final) { writeBits(final | 0b01u << 1u, 3u); }
+
+  /// Write Huffman code
+  ///
+  /// \param  code  Code
+  void writeCode(Code code) { writeBits(code.bits, code.len); }
+
+  /// Write bits LSB first
+  ///
+  /// \param  bits  Bits
+  /// \param  n     Number of bits
+  void writeBits(uint32_t bits, size_t n) {
+    _bits |= bits << _bit_count;
+    _bit_count += n;
+    for (; _bit_count >= 8uz; _bit_count -= 8uz, _bits >>= 8u)
+      _out.write(static_cast<uint8_t>(_bits));
+  }
+
+  ChunkWriter<N> _out;
+  std::unique_ptr<uint8_t[]> _buf{
+    std::make_unique_for_overwrite<uint8_t[]>(2uz * WindowSize)};
+  std::unique_ptr<uint16_t[]> _head{std::make_unique<uint16_t[]>(hash_size)};
+  std::unique_ptr<uint16_t[]> _prev{std::make_unique<uint16_t[]>(WindowSize)};
+  size_t _pos{}; ///< Next byte to compress
+  size_t _end{}; ///< End of buffered bytes
+  uint32_t _bits{};
+  size_t _bit_count{};
+  uint32_t _crc{};
+  uint32_t _isize{};
+};
+
+} // namespace intf::http
@@ -22,14 +22,211 @@
 #pragma once
 
 #include <esp_http_server.h>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 namespace intf::http {
 
+class PayloadPool;
+
+/// WebSocket payload
+///
+/// Payloads acquired from a \ref PayloadPool return their storage to it when
+/// destroyed. Copies of such payloads get their storage from the same pool.
+class Payload : public std::vector<uint8_t> {
+public:
+  using std::vector<uint8_t>::vector;
+  Payload() = default;
+  Payload(Payload const& other);
+  Payload(Payload&& other) noexcept
+    : std::vector<uint8_t>{std::move(other)},
+      _pool{std::exchange(other._pool, nullptr)} {}
+  Payload& operator=(Payload const& other) {
+    std::vector<uint8_t>::operator=(other);
+    return *this;
+  }
+  Payload& operator=(Payload&& other) noexcept {
+    if (this == &other) return *this;
+    recycle();
+    std::vector<uint8_t>::operator=(std::move(other));
+    _pool = std::exchange(other._pool, nullptr);
+    return *this;
+  }
+  ~Payload() { recycle(); }
+
+private:
+  friend PayloadPool;
+  void recycle();
+
+  PayloadPool* _pool{};
+};
+
 struct Message {
   int sock_fd;
   httpd_ws_type_t type;
-  std::vector<uint8_t> payload;
+  Payload payload;
+};
+
+/// Pool of inbound WebSocket payloads
+///
+/// Every received frame needs storage for its payload which is only released
+/// once the subscribed service has processed it. Instead of allocating it per
+/// frame, released storage is kept (with its capacity) and handed out again.
+/// Only if all kept storage is in use a new payload gets allocated, which is
+/// counted as miss. Storage which grew beyond a maximum capacity gets freed
+/// instead, so a single burst of large frames doesn't pin that memory.
+class PayloadPool {
+public:
+  /// Ctor
+  ///
+  /// \param  n             Number of payloads kept for reuse
+  /// \param  max_capacity  Largest capacity of payloads kept for reuse
+  explicit PayloadPool(size_t n, size_t max_capacity = SIZE_MAX)
+    : _max_capacity{max_capacity} {
+    _free.reserve(n);
+  }
+
+  /// Acquire payload
+  ///
+  /// \param  n Size of payload
+  /// \return Payload of size n
+  Payload acquire(size_t n) {
+    Payload payload;
+    {
+      std::scoped_lock lock{_mutex};
+      if (empty(_free)) ++_misses;
+      else {
+        static_cast<std::vector<uint8_t>&>(payload) = std::move(_free.back());
+        _free.pop_back();
+      }
+    }
+    payload.resize(n);
+    payload._pool = this;
+    return payload;
+  }
+
+  /// Release storage of payload
+  ///
+  /// \param  storage Storage of payload previously returned by acquire()
+  void release(std::vector<uint8_t>&& storage) {
+    if (!storage.capacity() || storage.capacity() > _max_capacity) return;
+    std::scoped_lock lock{_mutex};
+    if (size(_free) == _free.capacity()) return;
+    storage.clear();
+    _free.push_back(std::move(storage));
+  }
+
+  /// Get number of payloads which had to be allocated
+  ///
+  /// \return Number of misses
+  uint32_t misses() const {
+    std::scoped_lock lock{_mutex};
+    return _misses;
+  }
+
+private:
+  mutable std::mutex _mutex;
+  std::vector<std::vector<uint8_t>> _free;
+  size_t _max_capacity;
+  uint32_t _misses{};
 };
 
+inline Payload::Payload(Payload const& other)
+  : Payload{other._pool ? other._pool->acquire(0uz) : Payload{}} {
+  assign(other.cbegin(), other.cend());
+}
+
+inline void Payload::recycle() {
+  if (auto const pool{std::exchange(_pool, nullptr)})
+    pool->release(std::move(static_cast<std::vector<uint8_t>&>(*this)));
+}
+
+/// Fixed pool of outbound WebSocket messages
+///
+/// All slots get their payload capacity reserved upfront. Released slots only
+/// clear their payload, so the capacity (which might have grown for larger
+/// frames) is kept and reused. Free slots are tracked in a single bitmask which
+/// makes acquire() and release() lock-free. If no slot is available the message
+/// gets dropped and counted instead of allocating more memory.
+///
+/// \tparam N Number of slots
+template<size_t N>
+requires(N <= sizeof(uint32_t) * CHAR_BIT)
+class MessagePool {
+public:
+  /// Ctor
+  ///
+  /// \param  capacity  Payload capacity reserved per slot
+  explicit MessagePool(size_t capacity) {
+    for (auto& slot : _slots) slot.payload.reserve(capacity);
+  }
+
+  /// Acquire free slot
+  ///
+  /// \return Pointer to free slot or nullptr if the pool is exhausted
+  Message* acquire() {
+    auto mask{_free.load(std::memory_order_relaxed)};
+    while (mask) {
+      auto const i{std::countr_zero(mask)};
+      if (_free.compare_exchange_weak(mask,
+                                      mask & ~(1u << i),
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed))
+        return &_slots[static_cast<size_t>(i)];
+    }
+    _drops.fetch_add(1u, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  /// Release slot
+  ///
+  /// \param  msg Pointer to slot previously returned by acquire()
+  void release(Message* msg) {
+    auto const i{msg - data(_slots)};
+    msg->payload.clear();
+    _free.fetch_or(1u << i, std::memory_order_release);
+  }
+
+  /// Check whether message belongs to this pool
+  ///
+  /// \param  msg   Pointer to message
+  /// \retval true  Message is a slot of this pool
+  /// \retval false Message is not a slot of this pool
+  bool contains(Message const* msg) const {
+    return std::greater_equal{}(msg, data(_slots)) &&
+           std::less{}(msg, data(_slots) + N);
+  }
+
+  /// Get number of dropped messages
+  ///
+  /// \return Number of dropped messages
+  uint32_t drops() const { return _drops.load(std::memory_order_relaxed); }
+
+  /// Get number of slots in use
+  ///
+  /// \return Number of slots in use
+  size_t used() const {
+    return N - static_cast<size_t>(
+                 std::popcount(_free.load(std::memory_order_relaxed)));
+  }
+
+private:
+  std::array<Message, N> _slots{};
+  std::atomic<uint32_t> _free{N == 32uz ? ~0u : (1u << N) - 1u};
+  std::atomic<uint32_t> _drops{};
+};
+
+/// Outbound WebSocket messages
+inline MessagePool<message_pool_size> message_pool{message_payload_capacity};
+
+/// Inbound WebSocket payloads
+inline PayloadPool payload_pool{payload_pool_size, payload_pool_max_capacity};
+
 } // namespace intf::http
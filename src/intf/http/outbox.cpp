@@ -0,0 +1,255 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Per-client outbound WebSocket queues
+///
+/// \file   intf/http/outbox.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "outbox.hpp"
+#include <esp_http_server.h>
+#include <algorithm>
+#include <bit>
+#include "log.h"
+
+namespace intf::http {
+
+/// Queue acknowledge frame
+///
+/// Acknowledge frames are never dropped once queued. If \ref message_pool is
+/// exhausted the message gets allocated on the heap instead. To bound that
+/// memory at most \ref outbox_ack_depth acknowledge frames get queued per
+/// socket, further ones get rejected so that producers apply backpressure.
+///
+/// \param  sock_fd         Socket descriptor
+/// \param  payload         Payload
+/// \param  type            Frame type
+/// \retval ESP_OK          Frame queued
+/// \retval ESP_ERR_NO_MEM  Too many acknowledge frames queued
+/// \return Error code from httpd_queue_work if no drain job could be queued,
+///         callers waiting for a response should abort
+esp_err_t Outbox::ack(int sock_fd,
+                      std::span<uint8_t const> payload,
+                      httpd_ws_type_t type) {
+  return push(sock_fd, payload, 0u, true, type);
+}
+
+/// Queue state frame
+///
+/// If a frame with the same key is still queued, its payload gets replaced.
+/// Otherwise, if the queue has reached \ref outbox_depth, the oldest state
+/// frame gets dropped.
+///
+/// \param  sock_fd         Socket descriptor
+/// \param  payload         Payload
+/// \param  key             Key for coalescing, 0 never coalesces
+/// \param  type            Frame type
+/// \retval ESP_OK          Frame queued
+/// \retval ESP_ERR_NO_MEM  Frame dropped
+/// \return Error code from httpd_queue_work if no drain job could be queued
+esp_err_t Outbox::state(int sock_fd,
+                        std::span<uint8_t const> payload,
+                        uint32_t key,
+                        httpd_ws_type_t type) {
+  return push(sock_fd, payload, key, false, type);
+}
+
+/// Queue ping frame
+///
+/// Ping frames are never dropped, just like acknowledge frames.
+///
+/// \param  sock_fd         Socket descriptor
+/// \retval ESP_OK          Frame queued
+/// \retval ESP_ERR_NO_MEM  Too many acknowledge frames queued
+esp_err_t Outbox::ping(int sock_fd) {
+  return push(sock_fd, {}, 0u, true, HTTPD_WS_TYPE_PING);
+}
+
+/// Discard queue of a socket
+///
+/// Gets called by the HTTP servers close callback once a socket is closed.
+/// Otherwise a later session which reuses the same descriptor would receive
+/// stale frames.
+///
+/// \param  sock_fd Socket descriptor
+void Outbox::erase(int sock_fd) {
+  std::lock_guard lock{_mutex};
+  if (auto const it{_queues.find(sock_fd)}; it != cend(_queues)) {
+    for (auto const& e : it->second.entries) release(e.msg);
+    _queues.erase(it);
+  }
+}
+
+/// Get number of queued frames of a socket
+///
+/// Lets producers of large amounts of acknowledge frames apply backpressure.
+///
+/// \param  sock_fd Socket descriptor
+/// \return Number of queued frames
+size_t Outbox::depth(int sock_fd) const {
+  std::lock_guard lock{_mutex};
+  auto const it{_queues.find(sock_fd)};
+  return it != cend(_queues) ? size(it->second.entries) : 0uz;
+}
+
+/// Get queue statistics of all clients
+///
+/// \return Queue statistics of all clients
+std::vector<Outbox::Stats> Outbox::stats() const {
+  std::vector<Stats> retval;
+  std::lock_guard lock{_mutex};
+  for (auto const& [sock_fd, queue] : _queues)
+    retval.push_back({.sock_fd = sock_fd,
+                      .depth = size(queue.entries),
+                      .drops = queue.drops});
+  return retval;
+}
+
+/// Queue frame and make sure a drain job is pending
+///
+/// If no drain job can be queued the frame stays queued and goes out with the
+/// next drain, but the error is returned. Stop-and-wait protocols would
+/// otherwise wait forever for an acknowledge frame that never gets sent.
+///
+/// \param  sock_fd Socket descriptor
+/// \param  payload Payload
+/// \param  key     Key for coalescing, 0 never coalesces
+/// \param  ack     Acknowledge frame which must not be dropped
+/// \param  type    Frame type
+/// \retval ESP_OK  Frame queued
+/// \return Error code otherwise
+esp_err_t Outbox::push(int sock_fd,
+                       std::span<uint8_t const> payload,
+                       uint32_t key,
+                       bool ack,
+                       httpd_ws_type_t type) {
+  std::lock_guard lock{_mutex};
+  auto& queue{_queues[sock_fd]};
+
+  // Coalesce with queued frame
+  if (key)
+    if (auto const it{std::ranges::find_if(
+          queue.entries,
+          [key](Entry const& e) { return !e.ack && e.key == key; })};
+        it != cend(queue.entries)) {
+      it->msg->payload.assign(cbegin(payload), cend(payload));
+      return schedule(sock_fd, queue);
+    }
+
+  // Reject acknowledge frame if too many are queued
+  if (ack && std::ranges::count_if(queue.entries, &Entry::ack) >=
+               static_cast<ptrdiff_t>(outbox_ack_depth)) {
+    ++queue.drops;
+    return ESP_ERR_NO_MEM;
+  }
+
+  // Make room by dropping oldest state frame
+  if (!ack && size(queue.entries) >= outbox_depth) {
+    auto const it{std::ranges::find_if(queue.entries,
+                                       [](Entry const& e) { return !e.ack; })};
+    if (it == cend(queue.entries)) {
+      ++queue.drops;
+      return ESP_ERR_NO_MEM;
+    }
+    release(it->msg);
+    queue.entries.erase(it);
+    ++queue.drops;
+  }
+
+  //
+  auto msg{message_pool.acquire()};
+  if (!msg) {
+    if (!ack) {
+      ++queue.drops;
+      return ESP_ERR_NO_MEM;
+    }
+    msg = new Message{};
+  }
+  msg->sock_fd = sock_fd;
+  msg->type = type;
+  msg->payload.assign(cbegin(payload), cend(payload));
+  queue.entries.push_back({.msg = msg, .key = key, .ack = ack});
+
+  return schedule(sock_fd, queue);
+}
+
+/// Queue drain job for socket unless one is already pending
+///
+/// \param  sock_fd Socket descriptor
+/// \param  queue   Queue of socket
+/// \retval ESP_OK  Drain job pending
+/// \return Error code from httpd_queue_work otherwise
+esp_err_t Outbox::schedule(int sock_fd, Queue& queue) {
+  if (queue.scheduled) return ESP_OK;
+  auto const err{httpd_queue_work(
+    handle,
+    [](void* arg) {
+      outbox.drain(static_cast<int>(std::bit_cast<intptr_t>(arg)));
+    },
+    std::bit_cast<void*>(static_cast<intptr_t>(sock_fd)))};
+  if (err) LOGW("httpd_queue_work failed %s", esp_err_to_name(err));
+  else queue.scheduled = true;
+  return err;
+}
+
+/// Send all queued frames of a socket
+///
+/// This gets called by the HTTP server task. If sending fails the socket is
+/// considered closed and its queue gets discarded.
+///
+/// \param  sock_fd Socket descriptor
+void Outbox::drain(int sock_fd) {
+  for (;;) {
+    Entry entry;
+    {
+      std::lock_guard lock{_mutex};
+      auto const it{_queues.find(sock_fd)};
+      if (it == cend(_queues)) return;
+      if (empty(it->second.entries)) {
+        it->second.scheduled = false;
+        return;
+      }
+      entry = it->second.entries.front();
+      it->second.entries.pop_front();
+    }
+
+    //
+    httpd_ws_frame_t frame{
+      .type = entry.msg->type,
+      .payload = data(entry.msg->payload),
+      .len = size(entry.msg->payload),
+    };
+    auto const err{httpd_ws_send_frame_async(handle, sock_fd, &frame)};
+    release(entry.msg);
+
+    //
+    if (err) {
+      LOGD("httpd_ws_send_frame_async failed %s", esp_err_to_name(err));
+      erase(sock_fd);
+      return;
+    }
+  }
+}
+
+/// Return message to \ref message_pool or delete it
+///
+/// \param  msg Message
+void Outbox::release(Message* msg) {
+  if (message_pool.contains(msg)) message_pool.release(msg);
+  else delete msg;
+}
+
+} // namespace intf::http
@@ -0,0 +1,99 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Per-client outbound WebSocket queues
+///
+/// \file   intf/http/outbox.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <esp_err.h>
+#include <esp_http_server.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <span>
+#include <vector>
+#include "message.hpp"
+
+namespace intf::http {
+
+/// Per-client outbound WebSocket queues
+///
+/// Producers never wait for the HTTP server. Frames are put into a bounded
+/// queue per socket, which gets drained by the HTTP server task. At most one
+/// drain job per socket is queued at any time, so the server's work queue
+/// can't fill up even if a client is slow to receive.
+///
+/// Frames are queued by one of two policies:
+/// - ack() frames are never dropped once queued, but at most
+///   \ref outbox_ack_depth of them get queued per socket
+/// - state() frames replace an older queued frame with the same key. If the
+///   queue is full the oldest state frame gets dropped.
+class Outbox {
+public:
+  esp_err_t ack(int sock_fd,
+                std::span<uint8_t const> payload,
+                httpd_ws_type_t type = HTTPD_WS_TYPE_BINARY);
+  esp_err_t state(int sock_fd,
+                  std::span<uint8_t const> payload,
+                  uint32_t key = 0u,
+                  httpd_ws_type_t type = HTTPD_WS_TYPE_BINARY);
+  esp_err_t ping(int sock_fd);
+  void erase(int sock_fd);
+  size_t depth(int sock_fd) const;
+
+  /// Queue statistics of a single client
+  struct Stats {
+    int sock_fd;
+    size_t depth;
+    uint32_t drops;
+  };
+  std::vector<Stats> stats() const;
+
+private:
+  ///
+  struct Entry {
+    Message* msg;
+    uint32_t key;
+    bool ack;
+  };
+
+  ///
+  struct Queue {
+    std::deque<Entry> entries;
+    uint32_t drops;
+    bool scheduled;
+  };
+
+  esp_err_t push(int sock_fd,
+                 std::span<uint8_t const> payload,
+                 uint32_t key,
+                 bool ack,
+                 httpd_ws_type_t type = HTTPD_WS_TYPE_BINARY);
+  esp_err_t schedule(int sock_fd, Queue& queue);
+  void drain(int sock_fd);
+  static void release(Message* msg);
+
+  std::map<int, Queue> _queues;
+  mutable std::mutex _mutex;
+};
+
+/// Outbound WebSocket frames of all clients
+inline Outbox outbox;
+
+} // namespace intf::http
@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 namespace intf::http {
@@ -28,6 +30,7 @@ namespace intf::http {
 struct Request {
   std::string uri; // endpoint + query
   std::string body;
+  std::optional<uint16_t> address{}; // numeric segment after endpoint
 };
 
 } // namespace intf::http
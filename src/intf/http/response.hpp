@@ -22,10 +22,22 @@
 #pragma once
 
 #include <expected>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <variant>
 
 namespace intf::http {
 
-using Response = std::expected<std::string, std::string>;
+/// Sends a single chunk of a response body, returns false on failure
+using Send = std::function<bool(std::string_view)>;
+
+/// Response body which gets produced chunk by chunk
+///
+/// Gets called by the server once headers are sent. Returns false if any chunk
+/// couldn't be sent.
+using Chunks = std::function<bool(Send const&)>;
+
+using Response = std::expected<std::variant<std::string, Chunks>, std::string>;
 
 } // namespace intf::http
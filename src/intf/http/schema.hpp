@@ -0,0 +1,183 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Declarative JSON request schema
+///
+/// \file   intf/http/schema.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+namespace intf::http {
+
+/// Parse JSON request body
+///
+/// Bodies used to be parsed twice, once by validate_json() and once more to
+/// actually deserialize them. Errors get mapped to the same status codes.
+///
+/// \param  body  Request body
+/// \return Document or status on error
+inline std::expected<JsonDocument, std::string>
+parse_json(std::string_view body) {
+  JsonDocument doc;
+  switch (deserializeJson(doc, body).code()) {
+    case DeserializationError::Ok: return doc;
+    case DeserializationError::NoMemory:
+      return std::unexpected<std::string>{"500 Internal Server Error"};
+    default: return std::unexpected<std::string>{"415 Unsupported Media Type"};
+  }
+}
+
+/// Member of a JSON object bound to a member of a struct
+///
+/// Integers must lie within [min, max], strings must have a length within
+/// [min, max]. Booleans ignore both. Constraints which can't be expressed by a
+/// range (e.g. sets of allowed values) are checked by an optional predicate,
+/// which only gets called for values of the right type and range.
+///
+/// \tparam S Target struct
+template<typename S>
+struct Field {
+  using Member = std::variant<std::optional<bool> S::*,
+                              std::optional<uint8_t> S::*,
+                              std::optional<uint16_t> S::*,
+                              std::optional<uint32_t> S::*,
+                              std::optional<std::string> S::*>;
+
+  std::string_view key{};            ///< Key of JSON member
+  Member member{};                   ///< Bound member
+  uint32_t min{};                    ///< Minimum value or length
+  uint32_t max{};                    ///< Maximum value or length
+  bool (*valid)(JsonVariantConst){}; ///< Additional check
+};
+
+namespace detail {
+
+/// Get default maximum value or length of member type
+///
+/// \tparam T Member type
+/// \return Default maximum
+template<typename T>
+constexpr uint32_t max_of() {
+  if constexpr (std::is_integral_v<T>) return std::numeric_limits<T>::max();
+  else return std::numeric_limits<uint32_t>::max();
+}
+
+} // namespace detail
+
+/// Create field whose range defaults to the limits of its type
+///
+/// \tparam S       Target struct
+/// \tparam T       Member type
+/// \param  key     Key of JSON member
+/// \param  member  Bound member
+/// \param  min     Minimum value or length
+/// \param  max     Maximum value or length
+/// \param  valid   Additional check
+/// \return Field
+template<typename S, typename T>
+constexpr Field<S>
+field(std::string_view key,
+      std::optional<T> S::* member,
+      uint32_t min = 0u,
+      uint32_t max = detail::max_of<T>(),
+      bool (*valid)(JsonVariantConst) = nullptr) {
+  return {.key = key, .member = member, .min = min, .max = max, .valid = valid};
+}
+
+namespace detail {
+
+/// Check JSON value against field and assign it
+///
+/// \tparam T     Member type
+/// \param  dst   Bound member
+/// \param  v     JSON value
+/// \param  min   Minimum value or length
+/// \param  max   Maximum value or length
+/// \retval true  Value assigned
+/// \retval false Value has wrong type or is out of range
+template<typename T>
+bool assign(std::optional<T>& dst,
+            JsonVariantConst v,
+            uint32_t min,
+            uint32_t max) {
+  if constexpr (std::same_as<T, bool>) {
+    if (!v.is<bool>()) return false;
+    dst = v.as<bool>();
+  } else if constexpr (std::same_as<T, std::string>) {
+    if (!v.is<JsonString>()) return false;
+    auto const str{v.as<JsonString>()};
+    if (str.size() < min || str.size() > max) return false;
+    dst.emplace(str.c_str(), str.size());
+  } else {
+    // Negative values and floats are never valid
+    if (!v.is<uint32_t>()) return false;
+    auto const value{v.as<uint32_t>()};
+    if (value < min || value > max) return false;
+    dst = static_cast<T>(value);
+  }
+  return true;
+}
+
+} // namespace detail
+
+/// Bind JSON object to struct
+///
+/// The object gets walked once and every member which has a field gets type
+/// and range checked and assigned. Members without a field are ignored, so
+/// that clients may send more than an endpoint understands. Members of the
+/// struct which are missing in the object stay std::nullopt.
+///
+/// \tparam S       Target struct
+/// \tparam N       Number of fields
+/// \param  doc     JSON object
+/// \param  fields  Fields
+/// \return Bound struct or key of first invalid member (empty if doc isn't an
+///         object)
+template<typename S, size_t N>
+std::expected<S, std::string_view>
+bind_json(JsonVariantConst doc, std::array<Field<S>, N> const& fields) {
+  JsonObjectConst obj{doc.as<JsonObjectConst>()};
+  if (!obj) return std::unexpected<std::string_view>{std::string_view{}};
+
+  S retval{};
+  for (JsonPairConst kv : obj) {
+    std::string_view const key{kv.key().c_str(), kv.key().size()};
+    auto const it{std::ranges::find(fields, key, &Field<S>::key)};
+    if (it == cend(fields)) continue;
+    if (!std::visit(
+          [&](auto member) {
+            return detail::assign(retval.*member, kv.value(), it->min, it->max);
+          },
+          it->member) ||
+        (it->valid && !it->valid(kv.value())))
+      return std::unexpected<std::string_view>{it->key};
+  }
+  return retval;
+}
+
+} // namespace intf::http
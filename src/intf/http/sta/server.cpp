@@ -23,26 +23,161 @@
 #include <ArduinoJson.h>
 #include <driver/gpio.h>
 #include <esp_app_desc.h>
-#include <esp_wifi.h>
+#include <esp_timer.h>
+#include <lwip/sockets.h>
+#include <array>
+#include <cstdio>
 #include <dcc/dcc.hpp>
 #include <gsl/util>
-#include <ztl/string.hpp>
-#include "drv/anlg/convert.hpp"
 #include "frontend_embeds.hpp"
+#include "intf/http/assets.hpp"
+#include "intf/http/gzip.hpp"
+#include "intf/http/outbox.hpp"
 #include "log.h"
+#include "mem/littlefs/frontend.hpp"
 #include "mem/nvs/settings.hpp"
+#include "settings.hpp"
 #include "utility.hpp"
 
 namespace intf::http::sta {
 
 using namespace std::literals;
 
+namespace {
+
+/// Check whether client accepts gzip compressed responses
+///
+/// \param  req   Request
+/// \retval true  Accept-Encoding header allows gzip
+/// \retval false Accept-Encoding header missing or doesn't allow gzip
+bool gzip_accepted(httpd_req_t* req) {
+  std::array<char, 64uz> accept_encoding{};
+  // Truncated values are still good enough
+  if (auto const err{httpd_req_get_hdr_value_str(req,
+                                                 "Accept-Encoding",
+                                                 data(accept_encoding),
+                                                 size(accept_encoding))};
+      err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC)
+    return false;
+  return accepts_gzip(data(accept_encoding));
+}
+
+/// Send gzip compressed response body
+///
+/// \param  req   Request
+/// \param  send  Function sending a single chunk
+/// \param  body  Response body
+/// \retval true  Body sent
+/// \retval false Sending failed
+bool send_gzip(httpd_req_t* req,
+               Send const& send,
+               Response::value_type const& body) {
+  httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+  // Keep window off the stack
+  auto const writer{
+    std::make_unique<GzipWriter<response_chunk_size, compression_window_size>>(
+      send)};
+  if (auto const str{std::get_if<std::string>(&body)}) writer->write(*str);
+  else
+    std::get<Chunks>(body)([&writer](std::string_view chunk) {
+      return writer->write(chunk) == size(chunk);
+    });
+  return writer->finish();
+}
+
+/// Send response body
+///
+/// Plain bodies are sent in one go. Chunked bodies get sent chunk by chunk
+/// using chunked transfer encoding. If the client accepts it, chunked bodies
+/// and plain bodies of at least \ref compression_threshold bytes get gzip
+/// compressed on the fly.
+///
+/// \param  req     Request
+/// \param  body    Response body
+/// \param  gzip    Client accepts gzip
+/// \retval ESP_OK  Body sent
+/// \retval ESP_FAIL Sending failed
+esp_err_t send_body(httpd_req_t* req,
+                    Response::value_type const& body,
+                    bool gzip = false) {
+  auto const str{std::get_if<std::string>(&body)};
+  if (str && (!gzip || size(*str) < compression_threshold))
+    return httpd_resp_send(req, data(*str), size(*str));
+  Send const send{[req](std::string_view chunk) {
+    return httpd_resp_send_chunk(req, data(chunk), size(chunk)) == ESP_OK;
+  }};
+  auto const ok{gzip ? send_gzip(req, send, body)
+                     : std::get<Chunks>(body)(send)};
+  // Terminate chunked response
+  return httpd_resp_send_chunk(req, NULL, 0) == ESP_OK && ok ? ESP_OK
+                                                             : ESP_FAIL;
+}
+
+/// Frontend files sorted by path
+constexpr auto frontend_assets{make_assets(frontend_embeds)};
+
+/// Set validators and caching policy and answer conditional request
+///
+/// \param  req           Request
+/// \param  etag          Strong entity tag (quoted)
+/// \param  cache_control Cache-Control header
+/// \retval true          Client already got this version, 304 sent
+/// \retval false         Client needs the file
+bool not_modified(httpd_req_t* req,
+                  char const* etag,
+                  char const* cache_control) {
+  httpd_resp_set_hdr(req, "ETag", etag);
+  httpd_resp_set_hdr(req, "Cache-Control", cache_control);
+
+  auto const len{httpd_req_get_hdr_value_len(req, "If-None-Match")};
+  if (!len) return false;
+  std::string if_none_match(len, '\0');
+  if (httpd_req_get_hdr_value_str(
+        req, "If-None-Match", data(if_none_match), len + 1uz) != ESP_OK ||
+      !etag_match(if_none_match, etag))
+    return false;
+
+  httpd_resp_set_status(req, "304 Not Modified");
+  httpd_resp_send(req, NULL, 0);
+  return true;
+}
+
+/// Stream frontend file from LittleFS
+///
+/// \param  req               Request
+/// \param  file              Frontend file
+/// \retval ESP_OK            File sent
+/// \retval ESP_ERR_NOT_FOUND File could not be opened, nothing sent
+/// \retval ESP_FAIL          Sending failed
+esp_err_t send_file(httpd_req_t* req, mem::littlefs::FrontendFile const& file) {
+  auto const path{std::string{mem::littlefs::frontend_path} + '/' + file.uri};
+  auto const fp{fopen(data(path), "rb")};
+  if (!fp) return ESP_ERR_NOT_FOUND;
+  auto const _{gsl::finally([fp] { fclose(fp); })};
+
+  if (not_modified(req, data(file.etag), cache_control(file.uri)))
+    return ESP_OK;
+
+  // Set content encoding and type
+  httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+  httpd_resp_set_type(req, content_type(file.uri));
+
+  // Send file in chunks
+  auto const chunk{std::make_unique_for_overwrite<char[]>(file_chunk_size)};
+  while (auto const n{fread(chunk.get(), 1uz, file_chunk_size, fp)})
+    if (httpd_resp_send_chunk(req, chunk.get(), n) != ESP_OK) return ESP_FAIL;
+  return httpd_resp_send_chunk(req, NULL, 0) == ESP_OK ? ESP_OK : ESP_FAIL;
+}
+
+} // namespace
+
 /// Ctor
 ///
 /// \warning Endpoint order is important!
 Server::Server() {
   //
   mem::nvs::Settings nvs;
+  _http_exit_msg = nvs.getHttpExitMessage();
   httpd_config_t config = HTTPD_DEFAULT_CONFIG();
   config.stack_size = stack_size;
   config.core_id = WIFI_TASK_CORE_ID;
@@ -51,8 +186,18 @@ Server::Server() {
   config.recv_wait_timeout = nvs.getHttpReceiveTimeout();
   config.send_wait_timeout = nvs.getHttpTransmitTimeout();
   config.uri_match_fn = httpd_uri_match_wildcard;
+  // Setting a close callback means we have to close the socket ourselves
+  config.close_fn = [](httpd_handle_t, int sock_fd) {
+    outbox.erase(sock_fd);
+    close(sock_fd);
+  };
   ESP_ERROR_CHECK(httpd_start(&handle, &config));
 
+  // Workers need to exist before the first request comes in
+  work_queue.handle = xQueueCreate(work_queue.size, sizeof(Job));
+  assert(work_queue.handle);
+  workers.create(ztl::make_trampoline(this, &Server::workerTaskFunction));
+
   //
   httpd_uri_t uri{.uri = "/dcc/locos/*",
                   .method = HTTP_GET,
@@ -119,6 +264,34 @@ Server::Server() {
          .handler = ztl::make_trampoline(this, &Server::getHandler)};
   httpd_register_uri_handler(handle, &uri);
 
+  //
+  uri = {.uri = "/meter/*",
+         .method = HTTP_GET,
+         .handler = ztl::make_trampoline(this, &Server::getHandler)};
+  httpd_register_uri_handler(handle, &uri);
+
+  //
+  uri = {.uri = "/meter/*",
+         .method = HTTP_DELETE,
+         .handler = ztl::make_trampoline(this, &Server::deleteHandler)};
+  httpd_register_uri_handler(handle, &uri);
+
+  //
+  uri = {.uri = "/events/*",
+         .method = HTTP_GET,
+         .handler = ztl::make_trampoline(this, &Server::eventsWsHandler),
+         .is_websocket = true,
+         .handle_ws_control_frames = true};
+  httpd_register_uri_handler(handle, &uri);
+
+  //
+  uri = {.uri = "/frontend/*",
+         .method = HTTP_GET,
+         .handler = ztl::make_trampoline(this, &Server::frontendWsHandler),
+         .is_websocket = true,
+         .handle_ws_control_frames = true};
+  httpd_register_uri_handler(handle, &uri);
+
   //
   uri = {.uri = "/ota/*",
          .method = HTTP_GET,
@@ -186,6 +359,9 @@ Server::Server() {
 Server::~Server() {
   ESP_ERROR_CHECK(httpd_stop(&handle));
   handle = NULL;
+  workers.destroy();
+  vQueueDelete(work_queue.handle);
+  work_queue.handle = NULL;
 }
 
 /// \todo document
@@ -245,161 +421,72 @@ Response Server::settingsPostRequest(Request const& req) {
   LOGD("uri %s", req.uri.c_str());
   LOGD("body %s", req.body.c_str());
 
-  // Validate body
-  if (!validate_json(req.body))
-    return std::unexpected<std::string>{"415 Unsupported Media Type"};
-
-  // Deserialize (this only creates meta data which points to the source)
-  JsonDocument doc;
-  if (auto const err{deserializeJson(doc, req.body)}) {
-    LOGE("Deserialization failed %s", err.c_str());
-    return std::unexpected<std::string>{"500 Internal Server Error"};
+  // Deserialize
+  auto const doc{parse_json(req.body)};
+  if (!doc) return std::unexpected<std::string>{doc.error()};
+
+  // Type and range check everything before writing anything
+  auto const body{bind_json(*doc, settings_schema)};
+  if (!body) {
+    LOGE("Invalid setting %.*s",
+         static_cast<int>(size(body.error())),
+         data(body.error()));
+    return std::unexpected<std::string>{"422 Unprocessable Entity"};
   }
 
+  //
   mem::nvs::Settings nvs;
-
-  if (JsonVariantConst v{doc["sta_mdns"]}; v.is<std::string>())
-    if (auto const str{v.as<std::string>()}; nvs.setStationmDNS(str) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["sta_ssid"]}; v.is<std::string>())
-    if (auto const str{v.as<std::string>()}; nvs.setStationSSID(str) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["sta_pass"]}; v.is<std::string>())
-    if (auto const str{v.as<std::string>()};
-        nvs.setStationPassword(str) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["sta_alt_ssid"]}; v.is<std::string>())
-    if (auto const str{v.as<std::string>()};
-        nvs.setStationAlternativeSSID(str) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["sta_alt_pass"]}; v.is<std::string>())
-    if (auto const str{v.as<std::string>()};
-        nvs.setStationAlternativePassword(str) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["sta_ip"]}; v.is<std::string>())
-    if (auto const str{v.as<std::string>()}; nvs.setStationIP(str) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["sta_netmask"]}; v.is<std::string>())
-    if (auto const str{v.as<std::string>()};
-        nvs.setStationNetmask(str) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["sta_gateway"]}; v.is<std::string>())
-    if (auto const str{v.as<std::string>()};
-        nvs.setStationGateway(str) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["http_rx_timeout"]}; v.is<uint8_t>())
-    if (nvs.setHttpReceiveTimeout(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["http_tx_timeout"]}; v.is<uint8_t>())
-    if (nvs.setHttpTransmitTimeout(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["http_exit_msg"]}; v.is<bool>())
-    if (nvs.setHttpExitMessage(v.as<bool>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["cur_lim"]}; v.is<uint8_t>())
-    if (nvs.setCurrentLimit(static_cast<drv::out::track::CurrentLimit>(
-          v.as<uint8_t>())) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["cur_lim_serv"]}; v.is<uint8_t>())
-    if (nvs.setCurrentLimitService(static_cast<drv::out::track::CurrentLimit>(
-          v.as<uint8_t>())) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["cur_sc_time"]}; v.is<uint8_t>())
-    if (nvs.setCurrentShortCircuitTime(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["led_dc_bug"]}; v.is<uint8_t>())
-    if (nvs.setLedDutyCycleBug(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["led_dc_wifi"]}; v.is<uint8_t>())
-    if (nvs.setLedDutyCycleWiFi(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_preamble"]}; v.is<uint8_t>())
-    if (nvs.setDccPreamble(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_bit1_dur"]}; v.is<uint8_t>())
-    if (nvs.setDccBit1Duration(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_bit0_dur"]}; v.is<uint8_t>())
-    if (nvs.setDccBit0Duration(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_bidibit_dur"]}; v.is<uint8_t>())
-    if (nvs.setDccBiDiBitDuration(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_prog_type"]}; v.is<uint8_t>())
-    if (nvs.setDccProgrammingType(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_strtp_rs_pc"]}; v.is<uint8_t>())
-    if (nvs.setDccStartupResetPacketCount(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_cntn_rs_pc"]}; v.is<uint8_t>())
-    if (nvs.setDccContinueResetPacketCount(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_prog_pc"]}; v.is<uint8_t>())
-    if (nvs.setDccProgramPacketCount(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_verify_bit1"]}; v.is<bool>())
-    if (nvs.setDccBitVerifyTo1(v.as<bool>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_ack_cur"]}; v.is<uint8_t>())
-    if (nvs.setDccProgrammingAckCurrent(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_loco_flags"]}; v.is<uint8_t>())
-    if (nvs.setDccLocoFlags(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_accy_flags"]}; v.is<uint8_t>())
-    if (nvs.setDccAccessoryFlags(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_accy_swtime"]}; v.is<uint8_t>())
-    if (nvs.setDccAccessorySwitchTime(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["dcc_accy_pc"]}; v.is<uint8_t>())
-    if (nvs.setDccAccessorPacketCount(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
-
-  if (JsonVariantConst v{doc["ext_flags"]}; v.is<uint8_t>())
-    if (nvs.setExtensionFlags(v.as<uint8_t>()) != ESP_OK)
-      return std::unexpected<std::string>{"422 Unprocessable Entity"};
+  auto const set{[&nvs]<typename T, typename U>(
+                   std::optional<T> const& value,
+                   esp_err_t (mem::nvs::Settings::*setter)(U)) {
+    return !value || (nvs.*setter)(static_cast<U>(*value)) == ESP_OK;
+  }};
+  using S = mem::nvs::Settings;
+  if (!(set(body->sta_mdns, &S::setStationmDNS) &&
+        set(body->sta_ssid, &S::setStationSSID) &&
+        set(body->sta_pass, &S::setStationPassword) &&
+        set(body->sta_alt_ssid, &S::setStationAlternativeSSID) &&
+        set(body->sta_alt_pass, &S::setStationAlternativePassword) &&
+        set(body->sta_ip, &S::setStationIP) &&
+        set(body->sta_netmask, &S::setStationNetmask) &&
+        set(body->sta_gateway, &S::setStationGateway) &&
+        set(body->http_rx_timeout, &S::setHttpReceiveTimeout) &&
+        set(body->http_tx_timeout, &S::setHttpTransmitTimeout) &&
+        set(body->http_exit_msg, &S::setHttpExitMessage) &&
+        set(body->cur_lim, &S::setCurrentLimit) &&
+        set(body->cur_lim_serv, &S::setCurrentLimitService) &&
+        set(body->cur_sc_time, &S::setCurrentShortCircuitTime) &&
+        set(body->led_dc_bug, &S::setLedDutyCycleBug) &&
+        set(body->led_dc_wifi, &S::setLedDutyCycleWiFi) &&
+        set(body->dcc_preamble, &S::setDccPreamble) &&
+        set(body->dcc_bit1_dur, &S::setDccBit1Duration) &&
+        set(body->dcc_bit0_dur, &S::setDccBit0Duration) &&
+        set(body->dcc_bidibit_dur, &S::setDccBiDiBitDuration) &&
+        set(body->dcc_prog_type, &S::setDccProgrammingType) &&
+        set(body->dcc_strtp_rs_pc, &S::setDccStartupResetPacketCount) &&
+        set(body->dcc_cntn_rs_pc, &S::setDccContinueResetPacketCount) &&
+        set(body->dcc_prog_pc, &S::setDccProgramPacketCount) &&
+        set(body->dcc_verify_bit1, &S::setDccBitVerifyTo1) &&
+        set(body->dcc_ack_cur, &S::setDccProgrammingAckCurrent) &&
+        set(body->dcc_loco_flags, &S::setDccLocoFlags) &&
+        set(body->dcc_accy_flags, &S::setDccAccessoryFlags) &&
+        set(body->dcc_accy_swtime, &S::setDccAccessorySwitchTime) &&
+        set(body->dcc_accy_pc, &S::setDccAccessorPacketCount) &&
+        set(body->ext_flags, &S::setExtensionFlags)))
+    return std::unexpected<std::string>{"422 Unprocessable Entity"};
+  if (body->http_exit_msg) _http_exit_msg = *body->http_exit_msg;
 
   return {};
 }
 
 /// \todo document
 Response Server::sysGetRequest(Request const& req) {
-  using namespace drv::anlg;
+  auto const snap{mw::telem::snapshot.load()};
 
   //
   JsonDocument doc;
 
-  doc["state"] = magic_enum::enum_name(state.load());
+  doc["state"] = magic_enum::enum_name(snap.state);
 
   auto const app_desc{esp_app_get_description()};
   doc["version"] = app_desc->version;
@@ -407,55 +494,183 @@ Response Server::sysGetRequest(Request const& req) {
   doc["compile_time"] = app_desc->time;
   doc["compile_date"] = app_desc->date;
   doc["idf_version"] = app_desc->idf_ver + 1; // Remove 'v' prefix
+  std::array<char, 2uz * sizeof(app_desc->app_elf_sha256) + 1uz> elf_sha256{};
+  esp_app_get_elf_sha256(data(elf_sha256), size(elf_sha256));
+  doc["elf_sha256"] = data(elf_sha256); // Base delta patches have to match
 
   doc["revision"] = revision;
 
   doc["mdns"] = mdns::str;
   doc["ip"] = drv::wifi::ip_str;
   doc["mac"] = drv::wifi::mac_str;
-  if (wifi_ap_record_t ap_record;
-      esp_wifi_sta_get_ap_info(&ap_record) == ESP_OK)
-    doc["rssi"] = ap_record.rssi;
+  if (snap.rssi_valid) doc["rssi"] = snap.rssi;
+
+  doc["supply_voltage"] = snap.supply_voltage;
+  doc["vcc_voltage"] = snap.vcc_voltage;
+  doc["current"] = snap.filtered_current;
+  doc["temperature"] = snap.temperature;
+
+  doc["heap"] = snap.heap;
+  doc["internal_heap"] = snap.internal_heap;
+
+  doc["telem_version"] = snap.version;
+  doc["telem_update_time"] = snap.update_time;
+  doc["telem_max_update_time"] = snap.max_update_time;
+
+  doc["z21_wakeups"] = mw::roco::z21::wakeups.load();
+  doc["z21_datagrams"] = mw::roco::z21::datagrams.load();
+  doc["z21_max_datagrams"] = mw::roco::z21::max_datagrams_per_wakeup.load();
+  doc["z21_datagrams_saved"] = mw::roco::z21::datagrams_saved.load();
+  doc["z21_ingress_drops"] = mw::roco::z21::ingress_drops.load();
+  doc["z21_clients"] = mw::roco::z21::active_clients.load();
+  doc["z21_reaped_clients"] = mw::roco::z21::reaped_clients.load();
+  // Receive, exec and programming task together handle Z21 traffic
+  uint32_t z21_runtime{};
+  for (auto const handle : {mw::roco::z21::task.handle,
+                            mw::roco::z21::exec_task.handle,
+                            mw::roco::z21::prog_task.handle})
+    if (handle) z21_runtime += ulTaskGetRunTimeCounter(handle);
+  doc["z21_runtime"] = z21_runtime;
+  if (mw::dcc::task.handle)
+    doc["dcc_runtime"] = ulTaskGetRunTimeCounter(mw::dcc::task.handle);
+  auto const hits{mw::dcc::json_cache_hits.load()};
+  auto const misses{mw::dcc::json_cache_misses.load()};
+  doc["dcc_json_cache_hits"] = hits;
+  doc["dcc_json_cache_misses"] = misses;
+  if (hits + misses)
+    doc["dcc_json_cache_hit_rate"] =
+      static_cast<float>(hits) / static_cast<float>(hits + misses);
+
+  doc["events_clients"] = mw::events::clients.load();
+
+  JsonArray http_endpoints{doc["http_endpoints"].to<JsonArray>()};
+  visitStats([&](httpd_uri_t const& key, Stats const& stats) {
+    JsonObject obj{http_endpoints.add<JsonObject>()};
+    obj["uri"] = key.uri;
+    obj["method"] = http_method_str(static_cast<http_method>(key.method));
+    obj["requests"] = stats.requests;
+    obj["rejected"] = stats.rejected;
+    obj["pending"] = stats.pending;
+    obj["limit"] = stats.limit;
+    if (stats.requests) {
+      obj["avg_wait_us"] = stats.wait_us / stats.requests;
+      obj["avg_service_us"] = stats.service_us / stats.requests;
+    }
+    obj["max_wait_us"] = stats.max_wait_us;
+    obj["max_service_us"] = stats.max_service_us;
+  });
+
+  doc["ws_msg_used"] = message_pool.used();
+  doc["ws_msg_drops"] = message_pool.drops();
+  doc["ws_rx_misses"] = payload_pool.misses();
+  JsonArray ws_queues{doc["ws_queues"].to<JsonArray>()};
+  for (auto const& stats : outbox.stats()) {
+    JsonObject obj{ws_queues.add<JsonObject>()};
+    obj["sock_fd"] = stats.sock_fd;
+    obj["depth"] = stats.depth;
+    obj["drops"] = stats.drops;
+  }
 
-  if (SupplyVoltageMeasurement meas;
-      xQueuePeek(supply_voltages_queue.handle, &meas, 0u))
-    doc["supply_voltage"] = measurement2mV(meas).value();
+  //
+  std::string json;
+  json.reserve(4096uz);
+  serializeJson(doc, json);
 
-  if (VccVoltageMeasurement meas;
-      xQueuePeek(vcc_voltages_queue.handle, &meas, 0u))
-    doc["vcc_voltage"] = measurement2mV(meas).value();
+  //
+  if (req.uri.contains("restart")) esp_delayed_restart();
 
-  if (CurrentMeasurement meas;
-      xQueuePeek(filtered_current_queue.handle, &meas, 0u))
-    doc["current"] = measurement2mA(meas).value();
+  return json;
+}
 
-  if (TemperatureQueue::value_type temp;
-      xQueuePeek(temperature_queue.handle, &temp, 0u))
-    doc["temperature"] = temp;
+/// Handle queued HTTP requests
+///
+/// Workers keep slow endpoints (e.g. NVS writes or large rosters) from
+/// blocking the server task and thereby every other client.
+[[noreturn]] void Server::workerTaskFunction(void*) {
+  for (;;) {
+    Job job;
+    if (!xQueueReceive(work_queue.handle, &job, portMAX_DELAY)) continue;
+    auto const start_us{esp_timer_get_time()};
+    auto const err{(this->*job.work)(job.req)};
+    auto const end_us{esp_timer_get_time()};
+    finish(job.req,
+           static_cast<uint32_t>(start_us - job.queued_us),
+           static_cast<uint32_t>(end_us - start_us));
+    // Emulate what the server task does with failed handlers
+    if (err != ESP_OK)
+      httpd_sess_trigger_close(httpd_req_to_sockfd(job.req));
+    httpd_req_async_handler_complete(job.req);
+  }
+}
 
-  doc["heap"] = esp_get_free_heap_size();
-  doc["internal_heap"] = esp_get_free_internal_heap_size();
+/// Queue HTTP request for a worker
+///
+/// Requests to endpoints which reached their queue limit as well as requests
+/// which don't fit the work queue are answered with 503. Requests which can't
+/// be detached from the server task get handled inline.
+///
+/// \param  req     Request
+/// \param  work    Handler called by worker
+/// \retval ESP_OK  Request queued or answered
+/// \return Return value of handler if handled inline
+esp_err_t Server::queueWork(httpd_req_t* req, Work work) {
+  auto const busy{[req] {
+    LOGW("Endpoint %s busy", req->uri);
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_hdr(req, "Retry-After", "1");
+    httpd_resp_send(req, NULL, 0);
+    return ESP_OK;
+  }};
 
   //
-  std::string json;
-  json.reserve(1024uz);
-  serializeJson(doc, json);
+  if (!admit(req)) return busy();
+
+  // Handle inline
+  httpd_req_t* copy{};
+  if (httpd_req_async_handler_begin(req, &copy) != ESP_OK) {
+    auto const start_us{esp_timer_get_time()};
+    auto const err{(this->*work)(req)};
+    finish(req, 0u, static_cast<uint32_t>(esp_timer_get_time() - start_us));
+    return err;
+  }
 
   //
-  if (req.uri.contains("restart")) esp_delayed_restart();
+  if (Job const job{.req = copy,
+                    .work = work,
+                    .queued_us = esp_timer_get_time()};
+      !xQueueSend(work_queue.handle, &job, 0u)) {
+    httpd_req_async_handler_complete(copy);
+    cancel(req);
+    return busy();
+  }
 
-  return json;
+  return ESP_OK;
 }
 
 /// \todo document
 esp_err_t Server::getHandler(httpd_req_t* req) {
+  return queueWork(req, &Server::getWork);
+}
+
+/// \todo document
+esp_err_t Server::putPostHandler(httpd_req_t* req) {
+  return queueWork(req, &Server::putPostWork);
+}
+
+/// \todo document
+esp_err_t Server::deleteHandler(httpd_req_t* req) {
+  return queueWork(req, &Server::deleteWork);
+}
+
+/// \todo document
+esp_err_t Server::getWork(httpd_req_t* req) {
   LOGD("GET request %s", req->uri);
 
   //
   if (auto resp{syncResponse(req)}) {
     httpd_resp_set_type(req, HTTPD_TYPE_JSON);
-    httpd_resp_send(req, data(*resp), size(*resp));
-    return ESP_OK;
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    return send_body(req, *resp, gzip_accepted(req));
   }
   //
   else {
@@ -467,7 +682,7 @@ esp_err_t Server::getHandler(httpd_req_t* req) {
 }
 
 /// \todo document
-esp_err_t Server::putPostHandler(httpd_req_t* req) {
+esp_err_t Server::putPostWork(httpd_req_t* req) {
   LOGD("%s request %s", req->method == HTTP_PUT ? "PUT" : "POST", req->uri);
 
   // No content
@@ -476,10 +691,7 @@ esp_err_t Server::putPostHandler(httpd_req_t* req) {
     return ESP_FAIL;
   }
   //
-  else if (auto resp{syncResponse(req)}) {
-    httpd_resp_send(req, data(*resp), size(*resp));
-    return ESP_OK;
-  }
+  else if (auto resp{syncResponse(req)}) return send_body(req, *resp);
   //
   else {
     auto const& status{resp.error()};
@@ -490,14 +702,11 @@ esp_err_t Server::putPostHandler(httpd_req_t* req) {
 }
 
 /// \todo document
-esp_err_t Server::deleteHandler(httpd_req_t* req) {
+esp_err_t Server::deleteWork(httpd_req_t* req) {
   LOGD("DELETE request %s", req->uri);
 
   //
-  if (auto resp{syncResponse(req)}) {
-    httpd_resp_send(req, data(*resp), size(*resp));
-    return ESP_OK;
-  }
+  if (auto resp{syncResponse(req)}) return send_body(req, *resp);
   //
   else {
     auto const& status{resp.error()};
@@ -526,6 +735,8 @@ esp_err_t Server::deleteHandler(httpd_req_t* req) {
     }                                                                          \
   }
 
+GENERIC_WS_HANDLER(eventsWsHandler, "/events/")
+GENERIC_WS_HANDLER(frontendWsHandler, "/frontend/")
 GENERIC_WS_HANDLER(otaWsHandler, "/ota/")
 GENERIC_WS_HANDLER(rocoZ21WsHandler, "/roco/z21/")
 GENERIC_WS_HANDLER(zimoDecupZppWsHandler, "/zimo/decup/zpp/")
@@ -534,57 +745,49 @@ GENERIC_WS_HANDLER(zimoMduZppWsHandler, "/zimo/mdu/zpp/")
 GENERIC_WS_HANDLER(zimoMduZsuWsHandler, "/zimo/mdu/zsu/")
 GENERIC_WS_HANDLER(zimoZusiWsHandler, "/zimo/zusi/")
 
-/// \todo document
+/// Serve frontend
+///
+/// Files stored on LittleFS take precedence over the ones embedded in the
+/// firmware. Both carry an ETag, so clients which already got the current
+/// version receive a 304.
 esp_err_t Server::wildcardGetHandler(httpd_req_t* req) {
   LOGD("GET request %s", req->uri);
 
   // 308 / to index.html
-  if (std::string_view const uri{req->uri}; uri == "/"sv) {
+  std::string_view const uri{req->uri};
+  if (uri == "/"sv) {
     httpd_resp_set_status(req, "308 Permanent Redirect");
     httpd_resp_set_hdr(req, "Location", "/index.html");
     httpd_resp_send(req, NULL, 0);
     return ESP_OK;
   }
+
+  // Pick either index.html without beforeunload exit script or version with.
+  // Conveniently, the version with script is simply the next file.
+  auto const path{normalize_uri(uri)};
+  auto const next{path == "index.html"sv && _http_exit_msg.load()};
+
+  // Frontend (LittleFS)
+  if (auto const file{mem::littlefs::find_frontend(path, next)})
+    if (auto const err{send_file(req, *file)}; err != ESP_ERR_NOT_FOUND)
+      return err;
+
   // Frontend (embedded in firmware)
-  else if (auto it{std::ranges::find_if(
-             frontend_embeds,
-             [uri](auto&& embed) { return uri.contains(embed[0uz]); })};
-           it != cend(frontend_embeds)) {
+  if (auto asset{find_asset(frontend_assets, path)}) {
+    asset += next;
+    if (not_modified(req, asset->etag, asset->cache_control)) return ESP_OK;
+
     // Set content encoding and type
     httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
-    if (uri.ends_with(".bin"))
-      httpd_resp_set_type(req, "application/octet-stream");
-    else if (uri.ends_with(".css")) httpd_resp_set_type(req, "text/css");
-    else if (uri.ends_with(".gif")) httpd_resp_set_type(req, "image/gif");
-    else if (uri.ends_with(".ico"))
-      httpd_resp_set_type(req, "image/vnd.microsoft.icon");
-    else if (uri.ends_with(".js")) httpd_resp_set_type(req, "text/javascript");
-    else if (uri.ends_with(".json"))
-      httpd_resp_set_type(req, "application/json");
-    else if (uri.ends_with(".otf")) httpd_resp_set_type(req, "font/otf");
-    else if (uri.ends_with(".png")) httpd_resp_set_type(req, "image/png");
-    else if (uri.ends_with(".svg")) httpd_resp_set_type(req, "image/svg+xml");
-    else if (uri.ends_with(".ttf")) httpd_resp_set_type(req, "font/ttf");
-
-    // Pick either index.html without beforeunload exit script or version with.
-    // Conveniently, the version with script is simply the next element of the
-    // iterator.
-    if (it == std::ranges::find_if(frontend_embeds, [](auto&& embed) {
-          return !ztl::strcmp(embed[0uz], "index.html");
-        }))
-      it += mem::nvs::Settings{}.getHttpExitMessage();
+    httpd_resp_set_type(req, asset->type);
 
     // Send file
-    auto const [_, start, end]{*it};
-    httpd_resp_send(req, start, end - start);
-
-    return ESP_OK;
+    return httpd_resp_send(req, asset->start, asset->end - asset->start);
   }
+
   // 404
-  else {
-    httpd_resp_send_404(req);
-    return ESP_FAIL;
-  }
+  httpd_resp_send_404(req);
+  return ESP_FAIL;
 }
 
 } // namespace intf::http::sta
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include "../endpoints.hpp"
 #include "utility.hpp"
@@ -38,10 +39,33 @@ public:
   Response sysGetRequest(Request const& req);
 
 private:
+  /// Request handled by a worker
+  using Work = esp_err_t (Server::*)(httpd_req_t*);
+
+  /// Request waiting for a worker
+  struct Job {
+    httpd_req_t* req{};
+    Work work{};
+    int64_t queued_us{}; ///< Time the request got queued
+  };
+
+  // This gets called by FreeRTOS
+  [[noreturn]] void workerTaskFunction(void*);
+
+  esp_err_t queueWork(httpd_req_t* req, Work work);
+
   esp_err_t getHandler(httpd_req_t* req);
   esp_err_t putPostHandler(httpd_req_t* req);
   esp_err_t deleteHandler(httpd_req_t* req);
 
+  esp_err_t getWork(httpd_req_t* req);
+  esp_err_t putPostWork(httpd_req_t* req);
+  esp_err_t deleteWork(httpd_req_t* req);
+
+  esp_err_t eventsWsHandler(httpd_req_t* req);
+
+  esp_err_t frontendWsHandler(httpd_req_t* req);
+
   esp_err_t otaWsHandler(httpd_req_t* req);
 
   esp_err_t rocoZ21WsHandler(httpd_req_t* req);
@@ -53,6 +77,9 @@ private:
   esp_err_t zimoZusiWsHandler(httpd_req_t* req);
 
   esp_err_t wildcardGetHandler(httpd_req_t* req);
+
+  /// Cached http_exit_msg setting, saves an NVS read per index.html request
+  std::atomic<bool> _http_exit_msg{};
 };
 
 } // namespace intf::http::sta
@@ -0,0 +1,138 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Schema of /settings/ POST requests
+///
+/// \file   intf/http/sta/settings.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <dcc/dcc.hpp>
+#include "../schema.hpp"
+#include "mem/nvs/settings.hpp"
+
+namespace intf::http::sta {
+
+/// Body of /settings/ POST request
+///
+/// Every member is optional, only the settings contained in the request get
+/// written.
+struct SettingsRequest {
+  std::optional<std::string> sta_mdns;
+  std::optional<std::string> sta_ssid;
+  std::optional<std::string> sta_pass;
+  std::optional<std::string> sta_alt_ssid;
+  std::optional<std::string> sta_alt_pass;
+  std::optional<std::string> sta_ip;
+  std::optional<std::string> sta_netmask;
+  std::optional<std::string> sta_gateway;
+  std::optional<uint8_t> http_rx_timeout;
+  std::optional<uint8_t> http_tx_timeout;
+  std::optional<bool> http_exit_msg;
+  std::optional<uint8_t> cur_lim;
+  std::optional<uint8_t> cur_lim_serv;
+  std::optional<uint8_t> cur_sc_time;
+  std::optional<uint8_t> led_dc_bug;
+  std::optional<uint8_t> led_dc_wifi;
+  std::optional<uint8_t> dcc_preamble;
+  std::optional<uint8_t> dcc_bit1_dur;
+  std::optional<uint8_t> dcc_bit0_dur;
+  std::optional<uint8_t> dcc_bidibit_dur;
+  std::optional<uint8_t> dcc_prog_type;
+  std::optional<uint8_t> dcc_strtp_rs_pc;
+  std::optional<uint8_t> dcc_cntn_rs_pc;
+  std::optional<uint8_t> dcc_prog_pc;
+  std::optional<bool> dcc_verify_bit1;
+  std::optional<uint8_t> dcc_ack_cur;
+  std::optional<uint8_t> dcc_loco_flags;
+  std::optional<uint8_t> dcc_accy_flags;
+  std::optional<uint8_t> dcc_accy_swtime;
+  std::optional<uint8_t> dcc_accy_pc;
+  std::optional<uint8_t> ext_flags;
+};
+
+/// Schema of /settings/ POST request
+///
+/// Ranges mirror the checks of the \ref mem::nvs::Settings "NVS setters", so
+/// that invalid requests get rejected before anything is written. Checks which
+/// can't be expressed by a single range call the setters' own predicates.
+/// Strings are additionally limited to the lengths the captive portal accepts,
+/// which is stricter than the setters themselves.
+inline constexpr std::array settings_schema{
+  field("sta_mdns",
+        &SettingsRequest::sta_mdns,
+        0u,
+        32u,
+        [](JsonVariantConst v) {
+          auto const str{v.as<JsonString>()};
+          return mem::nvs::Settings::validStationmDNS(
+            {str.c_str(), str.size()});
+        }),
+  field("sta_ssid", &SettingsRequest::sta_ssid, 0u, 32u),
+  field("sta_pass", &SettingsRequest::sta_pass, 0u, 64u),
+  field("sta_alt_ssid", &SettingsRequest::sta_alt_ssid, 0u, 32u),
+  field("sta_alt_pass", &SettingsRequest::sta_alt_pass, 0u, 64u),
+  field("sta_ip", &SettingsRequest::sta_ip, 0u, 15u),
+  field("sta_netmask", &SettingsRequest::sta_netmask, 0u, 15u),
+  field("sta_gateway", &SettingsRequest::sta_gateway, 0u, 15u),
+  field("http_rx_timeout", &SettingsRequest::http_rx_timeout, 5u, 60u),
+  field("http_tx_timeout", &SettingsRequest::http_tx_timeout, 5u, 60u),
+  field("http_exit_msg", &SettingsRequest::http_exit_msg),
+  field("cur_lim",
+        &SettingsRequest::cur_lim,
+        0u,
+        std::to_underlying(drv::out::track::CurrentLimit::_4100mA)),
+  field("cur_lim_serv",
+        &SettingsRequest::cur_lim_serv,
+        0u,
+        std::to_underlying(drv::out::track::CurrentLimit::_4100mA)),
+  field("cur_sc_time", &SettingsRequest::cur_sc_time, 1u),
+  field("led_dc_bug", &SettingsRequest::led_dc_bug, 0u, 100u),
+  field("led_dc_wifi", &SettingsRequest::led_dc_wifi, 0u, 100u),
+  field("dcc_preamble",
+        &SettingsRequest::dcc_preamble,
+        DCC_TX_MIN_PREAMBLE_BITS,
+        DCC_TX_MAX_PREAMBLE_BITS),
+  field("dcc_bit1_dur",
+        &SettingsRequest::dcc_bit1_dur,
+        DCC_TX_MIN_BIT_1_TIMING,
+        DCC_TX_MAX_BIT_1_TIMING),
+  field("dcc_bit0_dur",
+        &SettingsRequest::dcc_bit0_dur,
+        DCC_TX_MIN_BIT_0_TIMING,
+        DCC_TX_MAX_BIT_0_TIMING),
+  field("dcc_bidibit_dur",
+        &SettingsRequest::dcc_bidibit_dur,
+        0u,
+        61u,
+        [](JsonVariantConst v) {
+          return mem::nvs::Settings::validDccBiDiBitDuration(v.as<uint8_t>());
+        }),
+  field("dcc_prog_type", &SettingsRequest::dcc_prog_type, 0u, 0x03u),
+  field("dcc_strtp_rs_pc", &SettingsRequest::dcc_strtp_rs_pc, 25u),
+  field("dcc_cntn_rs_pc", &SettingsRequest::dcc_cntn_rs_pc, 3u, 64u),
+  field("dcc_prog_pc", &SettingsRequest::dcc_prog_pc, 5u, 64u),
+  field("dcc_verify_bit1", &SettingsRequest::dcc_verify_bit1),
+  field("dcc_ack_cur", &SettingsRequest::dcc_ack_cur, 10u, 250u),
+  field("dcc_loco_flags", &SettingsRequest::dcc_loco_flags),
+  field("dcc_accy_flags", &SettingsRequest::dcc_accy_flags),
+  field("dcc_accy_swtime", &SettingsRequest::dcc_accy_swtime, 10u),
+  field("dcc_accy_pc", &SettingsRequest::dcc_accy_pc, 1u, 64u),
+  field("ext_flags", &SettingsRequest::ext_flags),
+};
+
+} // namespace intf::http::sta
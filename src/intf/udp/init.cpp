@@ -20,29 +20,77 @@
 /// \date   04/04/2024
 
 #include "init.hpp"
+#include <esp_vfs_eventfd.h>
 #include <lwip/sockets.h>
 #include "log.h"
 
 namespace intf::udp {
 
+namespace {
+
+/// Create IPv4 UDP socket bound to \ref port on all local interfaces
+///
+/// \return Socket descriptor or -1 on failure
+int make_ipv4_socket() {
+  auto const fd{socket(AF_INET, SOCK_DGRAM, IPPROTO_IP)};
+  if (fd < 0) return -1;
+  sockaddr_in dest_addr{};
+  dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  dest_addr.sin_family = AF_INET;
+  dest_addr.sin_port = htons(port);
+  if (bind(fd, std::bit_cast<sockaddr*>(&dest_addr), sizeof(dest_addr)) < 0) {
+    LOGE("bind failed %s", strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/// Create IPv6 only UDP socket bound to \ref port on all local interfaces
+///
+/// \return Socket descriptor or -1 on failure
+int make_ipv6_socket() {
+#if CONFIG_LWIP_IPV6
+  auto const fd{socket(AF_INET6, SOCK_DGRAM, IPPROTO_IPV6)};
+  if (fd < 0) return -1;
+  int const v6only{1};
+  setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only));
+  sockaddr_in6 dest_addr{};
+  dest_addr.sin6_addr = in6addr_any;
+  dest_addr.sin6_family = AF_INET6;
+  dest_addr.sin6_port = htons(port);
+  if (bind(fd, std::bit_cast<sockaddr*>(&dest_addr), sizeof(dest_addr)) < 0) {
+    LOGE("bind failed %s", strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+#else
+  return -1;
+#endif
+}
+
+} // namespace
+
 /// Initialize UDP
 ///
-/// Initialization takes place in init(). This function creates an IPv4 UDP
-/// socket, stores the descriptor in \ref sock_fd, and binds it to \ref port
-/// "port 21105" on all local interfaces (INADDR_ANY).
+/// Initialization takes place in init(). This function creates an IPv4 and,
+/// if lwIP was built with IPv6 support, an IPv6 only UDP socket. Both are bound
+/// to \ref port "port 21105" on all local interfaces and their descriptors are
+/// stored in \ref sock_fds. Binding to the wildcard address covers Ethernet as
+/// well as WiFi, no matter which of them is up or which address DHCP hands out.
+///
+/// The eventfd VFS is registered as well, so that consumers of the sockets can
+/// wake up a blocking `select()` from another task.
 ///
-/// The initialized socket is used by the \ref section_mw_roco_z21 service.
+/// The initialized sockets are used by the \ref section_mw_roco_z21 service.
 esp_err_t init() {
-  sock_fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
-  assert(sock_fd >= 0);
-  sockaddr_in6 dest_addr;
-  sockaddr_in* dest_addr_ip4{std::bit_cast<sockaddr_in*>(&dest_addr)};
-  dest_addr_ip4->sin_addr.s_addr = htonl(INADDR_ANY);
-  dest_addr_ip4->sin_family = AF_INET;
-  dest_addr_ip4->sin_port = htons(port);
-  auto const err{
-    bind(sock_fd, std::bit_cast<sockaddr*>(&dest_addr), sizeof(dest_addr))};
-  assert(err >= 0);
+  esp_vfs_eventfd_config_t const cfg = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+  if (auto const err{esp_vfs_eventfd_register(&cfg)};
+      err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    return err;
+  sock_fds = {make_ipv4_socket(), make_ipv6_socket()};
+  assert(sock_fds.front() >= 0);
   return ESP_OK;
 }
 
@@ -31,17 +31,18 @@ namespace mem {
 // clang-format off
 /// \page page_mem Memory
 /// \details
-/// | Chapter               | Namespace | Content                                   |
-/// | --------------------- | --------- | ----------------------------------------- |
-/// | \subpage page_mem_nvs | \ref nvs  | Settings, locos, turnouts and accessories |
+/// | Chapter                    | Namespace     | Content                                   |
+/// | -------------------------- | ------------- | ----------------------------------------- |
+/// | \subpage page_mem_littlefs | \ref littlefs | Web frontend                              |
+/// | \subpage page_mem_nvs      | \ref nvs      | Settings, locos, turnouts and accessories |
 // clang-format on
 /// \page page_mem Memory
 /// \details
 ///
 /// <div class="section_buttons">
-/// | Previous           | Next              |
-/// | :----------------- | ----------------: |
-/// | \ref page_drv_wifi | \ref page_mem_nvs |
+/// | Previous           | Next                   |
+/// | :----------------- | ---------------------: |
+/// | \ref page_drv_wifi | \ref page_mem_littlefs |
 /// </div>
 
 } // namespace mem
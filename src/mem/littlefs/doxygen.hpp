@@ -0,0 +1,49 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// LittleFS documentation
+///
+/// \file   mem/littlefs/doxygen.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+namespace mem::littlefs {
+
+/// \page page_mem_littlefs LittleFS
+/// \details \tableofcontents
+/// The `data` partition contains a
+/// [LittleFS](https://github.com/littlefs-project/littlefs) file system which
+/// is mounted at `/data`. Currently it only stores the web frontend.
+///
+/// \subsection subsection_mem_littlefs_init Initialization
+/// \copydetails littlefs::init
+///
+/// \subsection subsection_mem_littlefs_frontend Frontend
+/// The frontend lives in `/data/frontend`. A manifest lists path and ETag of
+/// each file, so that requests can be answered without touching the file
+/// system. Updates get extracted to a staging directory and swapped in once
+/// complete.
+///
+/// \copydetails littlefs::recover_frontend
+///
+/// <div class="section_buttons">
+/// | Previous      | Next              |
+/// | :------------ | ----------------: |
+/// | \ref page_mem | \ref page_mem_nvs |
+/// </div>
+
+} // namespace mem::littlefs
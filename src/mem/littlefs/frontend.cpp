@@ -0,0 +1,237 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Frontend stored on LittleFS
+///
+/// \file   mem/littlefs/frontend.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "frontend.hpp"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <gsl/util>
+#include <mutex>
+#include "log.h"
+
+namespace mem::littlefs {
+
+namespace {
+
+/// Name of file listing path and ETag of each frontend file
+constexpr std::string_view manifest_name{".manifest"};
+
+std::mutex mutex;
+
+/// Currently served files sorted by path
+std::vector<FrontendFile> frontend_files;
+
+/// Check whether path exists
+///
+/// \param  path  Path
+/// \retval true  Path exists
+/// \retval false Path does not exist
+bool exists(std::string const& path) {
+  struct stat st;
+  return !stat(data(path), &st);
+}
+
+/// Get path of manifest in directory
+///
+/// \param  dir Directory
+/// \return Path of manifest
+std::string manifest_path(std::string_view dir) {
+  return std::string{dir} + '/' + std::string{manifest_name};
+}
+
+/// Read manifest
+///
+/// Each line of the manifest contains the ETag and path of a single file
+/// separated by a space.
+///
+/// \param  dir Directory containing manifest
+/// \return Files sorted by path
+std::vector<FrontendFile> read_manifest(std::string_view dir) {
+  std::vector<FrontendFile> files;
+  auto const fp{fopen(data(manifest_path(dir)), "r")};
+  if (!fp) return files;
+  auto const _{gsl::finally([fp] { fclose(fp); })};
+  std::array<char, 256uz> chunk;
+  std::string line;
+  // Lines may be longer than chunk, only split them at newlines
+  while (fgets(data(chunk), size(chunk), fp)) {
+    line += data(chunk);
+    if (!line.ends_with('\n') && !feof(fp)) continue;
+    std::string_view str{line};
+    if (str.ends_with('\n')) str.remove_suffix(1uz);
+    if (auto const pos{str.find(' ')}; pos != std::string_view::npos)
+      files.push_back({.uri = std::string{str.substr(pos + 1uz)},
+                       .etag = std::string{str.substr(0uz, pos)}});
+    line.clear();
+  }
+  std::ranges::sort(files, {}, &FrontendFile::uri);
+  return files;
+}
+
+/// Write manifest
+///
+/// \param  dir       Directory to write manifest to
+/// \param  files     Files
+/// \retval ESP_OK    Success
+/// \retval ESP_FAIL  Manifest could not be written
+esp_err_t write_manifest(std::string_view dir,
+                         std::vector<FrontendFile> const& files) {
+  auto const fp{fopen(data(manifest_path(dir)), "w")};
+  if (!fp) return ESP_FAIL;
+  auto ok{true};
+  for (auto const& file : files)
+    ok = ok && fprintf(fp, "%s %s\n", data(file.etag), data(file.uri)) > 0;
+  return fclose(fp) || !ok ? ESP_FAIL : ESP_OK;
+}
+
+} // namespace
+
+/// Load manifest of frontend currently stored on LittleFS
+///
+/// \retval ESP_OK  Success
+esp_err_t load_frontend() {
+  auto files{read_manifest(frontend_path)};
+  LOGI("Frontend on LittleFS contains %zu files", size(files));
+  std::scoped_lock lock{mutex};
+  frontend_files = std::move(files);
+  return ESP_OK;
+}
+
+/// Complete or roll back interrupted frontend swap
+///
+/// A frontend update first moves \ref frontend_path to
+/// \ref frontend_backup_path and then \ref frontend_staging_path (which only
+/// contains a manifest once it's complete) to \ref frontend_path. If the board
+/// loses power in between, \ref frontend_path is missing. Leftover staging and
+/// backup directories get removed.
+///
+/// \retval ESP_OK    Success
+/// \retval ESP_FAIL  Directories could not be renamed or removed
+esp_err_t recover_frontend() {
+  auto err{ESP_OK};
+  if (!exists(frontend_path)) {
+    if (exists(manifest_path(frontend_staging_path))) {
+      LOGW("Complete interrupted frontend update");
+      if (rename(frontend_staging_path, frontend_path)) err = ESP_FAIL;
+    } else if (exists(frontend_backup_path)) {
+      LOGW("Roll back interrupted frontend update");
+      if (rename(frontend_backup_path, frontend_path)) err = ESP_FAIL;
+    }
+  }
+  if (remove_all(frontend_staging_path) || remove_all(frontend_backup_path))
+    err = ESP_FAIL;
+  return err;
+}
+
+/// Swap frontend for the one extracted to \ref frontend_staging_path
+///
+/// \param  files     Extracted files
+/// \retval ESP_OK    Success
+/// \retval ESP_FAIL  Frontend could not be swapped (old one is kept)
+esp_err_t commit_frontend(std::vector<FrontendFile> files) {
+  // Manifest marks staging directory as complete, so write it last
+  if (write_manifest(frontend_staging_path, files)) return ESP_FAIL;
+  if (remove_all(frontend_backup_path)) return ESP_FAIL;
+
+  // Nothing must be served while directories get renamed
+  {
+    std::scoped_lock lock{mutex};
+    frontend_files.clear();
+  }
+  if (exists(frontend_path) && rename(frontend_path, frontend_backup_path)) {
+    load_frontend();
+    return ESP_FAIL;
+  }
+  if (rename(frontend_staging_path, frontend_path)) {
+    rename(frontend_backup_path, frontend_path);
+    load_frontend();
+    return ESP_FAIL;
+  }
+  remove_all(frontend_backup_path);
+
+  std::ranges::sort(files, {}, &FrontendFile::uri);
+  LOGI("Frontend on LittleFS updated to %zu files", size(files));
+  std::scoped_lock lock{mutex};
+  frontend_files = std::move(files);
+  return ESP_OK;
+}
+
+/// Find frontend file
+///
+/// \param  uri   Path relative to \ref frontend_path
+/// \param  next  Return the file following the one found
+/// \return File or std::nullopt if not found
+std::optional<FrontendFile> find_frontend(std::string_view uri, bool next) {
+  std::scoped_lock lock{mutex};
+  auto it{
+    std::ranges::lower_bound(frontend_files, uri, {}, &FrontendFile::uri)};
+  if (it == cend(frontend_files) || it->uri != uri) return std::nullopt;
+  if (next && ++it == cend(frontend_files)) return std::nullopt;
+  return *it;
+}
+
+/// Create directory and all missing parents
+///
+/// The mount point itself is never created.
+///
+/// \param  path      Path below \ref base_path
+/// \retval ESP_OK    Success
+/// \retval ESP_FAIL  Directory could not be created
+esp_err_t create_directories(std::string_view path) {
+  if (!path.starts_with(base_path)) return ESP_FAIL;
+  for (auto pos{path.find('/', std::string_view{base_path}.size() + 1uz)};;
+       pos = path.find('/', pos + 1uz)) {
+    if (std::string const dir{path.substr(0uz, pos)};
+        mkdir(data(dir), 0755) && errno != EEXIST)
+      return ESP_FAIL;
+    if (pos == std::string_view::npos) return ESP_OK;
+  }
+}
+
+/// Remove file or directory including its content
+///
+/// \param  path      Path
+/// \retval ESP_OK    Success (or nothing to remove)
+/// \retval ESP_FAIL  Path could not be removed
+esp_err_t remove_all(std::string const& path) {
+  struct stat st;
+  if (stat(data(path), &st)) return ESP_OK;
+  if (!S_ISDIR(st.st_mode)) return unlink(data(path)) ? ESP_FAIL : ESP_OK;
+
+  // Don't modify directory while iterating it
+  std::vector<std::string> entries;
+  if (auto const dir{opendir(data(path))}) {
+    while (auto const entry{readdir(dir)})
+      if (std::string_view const name{entry->d_name};
+          name != "." && name != "..")
+        entries.push_back(path + '/' + entry->d_name);
+    closedir(dir);
+  }
+  for (auto const& entry : entries)
+    if (remove_all(entry)) return ESP_FAIL;
+  return rmdir(data(path)) ? ESP_FAIL : ESP_OK;
+}
+
+} // namespace mem::littlefs
@@ -0,0 +1,47 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Frontend stored on LittleFS
+///
+/// \file   mem/littlefs/frontend.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <esp_err.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mem::littlefs {
+
+/// Frontend file stored on LittleFS
+struct FrontendFile {
+  std::string uri{};  ///< Path relative to \ref frontend_path
+  std::string etag{}; ///< Strong entity tag (quoted)
+};
+
+esp_err_t load_frontend();
+esp_err_t recover_frontend();
+esp_err_t commit_frontend(std::vector<FrontendFile> files);
+std::optional<FrontendFile> find_frontend(std::string_view uri,
+                                          bool next = false);
+
+esp_err_t create_directories(std::string_view path);
+esp_err_t remove_all(std::string const& path);
+
+} // namespace mem::littlefs
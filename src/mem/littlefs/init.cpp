@@ -0,0 +1,54 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Initialize LittleFS
+///
+/// \file   mem/littlefs/init.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "init.hpp"
+#include <esp_littlefs.h>
+#include "frontend.hpp"
+#include "log.h"
+
+namespace mem::littlefs {
+
+/// Initialize LittleFS
+///
+/// init() mounts the `data` partition at \ref base_path. If the partition
+/// can't be mounted (e.g. because it has never been formatted), it gets
+/// formatted. Afterwards an interrupted frontend update is either completed
+/// or rolled back and the frontend manifest is loaded.
+esp_err_t init() {
+  esp_vfs_littlefs_conf_t const conf{
+    .base_path = base_path,
+    .partition_label = partition_label,
+    .format_if_mount_failed = true,
+  };
+  if (auto const err{esp_vfs_littlefs_register(&conf)}) {
+    LOGE("esp_vfs_littlefs_register failed %s", esp_err_to_name(err));
+    return err;
+  }
+
+  size_t total{}, used{};
+  if (esp_littlefs_info(partition_label, &total, &used) == ESP_OK)
+    LOGI("LittleFS %zu/%zu bytes used", used, total);
+
+  recover_frontend();
+  return load_frontend();
+}
+
+} // namespace mem::littlefs
@@ -167,4 +167,32 @@ esp_err_t Base::setU16(std::string const& key, uint16_t value) {
   return err;
 }
 
+/// Get uint64_t value for given key
+///
+/// \param  key Key name
+/// \return uint64_t value
+uint64_t Base::getU64(std::string const& key) const {
+  assert(size(key) < NVS_KEY_NAME_MAX_SIZE);
+  uint64_t value;
+  if (nvs_get_u64(_handle, key.c_str(), &value) != ESP_OK) return {};
+  return value;
+}
+
+/// Set uint64_t value for given key
+///
+/// \param  key                           Key name
+/// \param  value                         uint64_t value
+/// \retval ESP_OK                        Value was set successfully
+/// \retval ESP_FAIL                      Internal error
+/// \retval ESP_ERR_NVS_INVALID_NAME      Key name doesn't satisfy constraints
+/// \retval ESP_ERR_NVS_NOT_ENOUGH_SPACE  Not enough space
+/// \retval ESP_ERR_NVS_REMOVE_FAILED     Value wasn't updated because flash
+///                                       write operation has failed
+esp_err_t Base::setU64(std::string const& key, uint64_t value) {
+  assert(size(key) < NVS_KEY_NAME_MAX_SIZE);
+  auto const err{nvs_set_u64(_handle, key.c_str(), value)};
+  if (err == ESP_OK) _commit_pending = true;
+  return err;
+}
+
 } // namespace mem::nvs
@@ -117,6 +117,9 @@ protected:
   uint8_t getU16(std::string const& key) const;
   esp_err_t setU16(std::string const& key, uint16_t value);
 
+  uint64_t getU64(std::string const& key) const;
+  esp_err_t setU64(std::string const& key, uint64_t value);
+
 private:
   // The getters and setters in this class rely on SSO inside the std::string
   // class. The default capacity of std::string must be large enough to hold a
@@ -0,0 +1,44 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// NVS "dcc" namespace
+///
+/// \file   mem/nvs/dcc.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "dcc.hpp"
+
+namespace mem::nvs {
+
+/// Get end of reserved revisions
+///
+/// \return End of reserved revisions, 0 if none are stored
+uint32_t Dcc::getRevision() const {
+  return static_cast<uint32_t>(getU64("revision"));
+}
+
+/// Set end of reserved revisions
+///
+/// \param  value                         End of reserved revisions
+/// \retval ESP_OK                        Value was set successfully
+/// \retval ESP_FAIL                      Internal error
+/// \retval ESP_ERR_NVS_INVALID_NAME      Key name doesn't satisfy constraints
+/// \retval ESP_ERR_NVS_NOT_ENOUGH_SPACE  Not enough space
+/// \retval ESP_ERR_NVS_REMOVE_FAILED     Value wasn't updated because flash
+///                                       write operation has failed
+esp_err_t Dcc::setRevision(uint32_t value) { return setU64("revision", value); }
+
+} // namespace mem::nvs
@@ -0,0 +1,42 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// NVS "dcc" namespace
+///
+/// \file   mem/nvs/dcc.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <cstdint>
+#include "base.hpp"
+
+namespace mem::nvs {
+
+/// Revision reservation stored in NVS
+///
+/// Dcc stores the end of the block of revisions reserved by
+/// \ref mw::dcc::Revisions as u64 under the key "revision" in the NVS
+/// namespace "dcc".
+class Dcc : public Base {
+public:
+  Dcc() : Base{"dcc", NVS_READWRITE} {}
+
+  uint32_t getRevision() const;
+  esp_err_t setRevision(uint32_t value);
+};
+
+} // namespace mem::nvs
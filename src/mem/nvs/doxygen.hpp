@@ -44,6 +44,15 @@ namespace mem::nvs {
 /// \subsection subsection_mem_nvs_accessories Accessories
 /// \copydetails nvs::Accessories
 ///
+/// \subsection subsection_mem_nvs_dcc DCC
+/// \copydetails nvs::Dcc
+///
+/// \subsection subsection_mem_nvs_meter Meter
+/// \copydetails nvs::Meter
+///
+/// \subsection subsection_mem_nvs_ota OTA
+/// \copydetails nvs::Ota
+///
 /// \subsection subsection_mem_nvs_settings Settings
 /// \copydetails nvs::Settings
 ///
@@ -91,9 +100,9 @@ namespace mem::nvs {
 /// \details \tableofcontents
 ///
 /// <div class="section_buttons">
-/// | Previous      | Next                   |
-/// | :------------ | ---------------------: |
-/// | \ref page_mem | \ref page_hw_reference |
+/// | Previous               | Next                   |
+/// | :--------------------- | ---------------------: |
+/// | \ref page_mem_littlefs | \ref page_hw_reference |
 /// </div>
 
 } // namespace mem::nvs
@@ -0,0 +1,70 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// NVS "meter" namespace
+///
+/// \file   mem/nvs/meter.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "meter.hpp"
+
+namespace mem::nvs {
+
+/// Get energy of operating mode
+///
+/// \param  mode  Operating mode
+/// \return Energy [nJ]
+uint64_t Meter::getModeEnergy(State mode) const {
+  return getU64(std::string{magic_enum::enum_name(mode)});
+}
+
+/// Set energy of operating mode
+///
+/// \param  mode                          Operating mode
+/// \param  value                         Energy [nJ]
+/// \retval ESP_OK                        Value was set successfully
+/// \retval ESP_FAIL                      Internal error
+/// \retval ESP_ERR_NVS_INVALID_NAME      Key name doesn't satisfy constraints
+/// \retval ESP_ERR_NVS_NOT_ENOUGH_SPACE  Not enough space
+/// \retval ESP_ERR_NVS_REMOVE_FAILED     Value wasn't updated because flash
+///                                       write operation has failed
+esp_err_t Meter::setModeEnergy(State mode, uint64_t value) {
+  return setU64(std::string{magic_enum::enum_name(mode)}, value);
+}
+
+/// Get energy of loco
+///
+/// \param  addr  Address
+/// \return Energy [nJ]
+uint64_t Meter::getLocoEnergy(dcc::Address::value_type addr) const {
+  return getU64(address2key(addr));
+}
+
+/// Set energy of loco
+///
+/// \param  addr                          Address
+/// \param  value                         Energy [nJ]
+/// \retval ESP_OK                        Value was set successfully
+/// \retval ESP_FAIL                      Internal error
+/// \retval ESP_ERR_NVS_INVALID_NAME      Key name doesn't satisfy constraints
+/// \retval ESP_ERR_NVS_NOT_ENOUGH_SPACE  Not enough space
+/// \retval ESP_ERR_NVS_REMOVE_FAILED     Value wasn't updated because flash
+///                                       write operation has failed
+esp_err_t Meter::setLocoEnergy(dcc::Address::value_type addr, uint64_t value) {
+  return setU64(address2key(addr), value);
+}
+
+} // namespace mem::nvs
@@ -0,0 +1,47 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// NVS "meter" namespace
+///
+/// \file   mem/nvs/meter.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <dcc/dcc.hpp>
+#include "base.hpp"
+#include "utility.hpp"
+
+namespace mem::nvs {
+
+/// Energy counters stored in NVS
+///
+/// Meter stores the energy counters of the \ref page_mw_meter "meter" in the
+/// NVS namespace "meter". Counters of operating modes use the name of the
+/// corresponding \ref State as key, counters of locos use the decoder address
+/// converted by address2key(). All values are stored as u64 in [nJ].
+class Meter : public Base {
+public:
+  Meter() : Base{"meter", NVS_READWRITE} {}
+
+  uint64_t getModeEnergy(State mode) const;
+  esp_err_t setModeEnergy(State mode, uint64_t value);
+
+  uint64_t getLocoEnergy(dcc::Address::value_type addr) const;
+  esp_err_t setLocoEnergy(dcc::Address::value_type addr, uint64_t value);
+};
+
+} // namespace mem::nvs
@@ -0,0 +1,53 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// NVS "ota" namespace
+///
+/// \file   mem/nvs/ota.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "ota.hpp"
+
+namespace mem::nvs {
+
+/// Get progress
+///
+/// \return Progress as blob, empty if none is stored
+std::string Ota::getProgress() const { return getBlob("progress"); }
+
+/// Set progress
+///
+/// \param  blob                          Progress as blob
+/// \retval ESP_OK                        Value was set successfully
+/// \retval ESP_FAIL                      Internal error
+/// \retval ESP_ERR_NVS_INVALID_NAME      Key name doesn't satisfy constraints
+/// \retval ESP_ERR_NVS_NOT_ENOUGH_SPACE  Not enough space
+/// \retval ESP_ERR_NVS_REMOVE_FAILED     Value wasn't updated because flash
+///                                       write operation has failed
+esp_err_t Ota::setProgress(std::string_view blob) {
+  return setBlob("progress", blob);
+}
+
+/// Erase progress
+///
+/// \retval ESP_OK    Progress erased or none stored
+/// \retval ESP_FAIL  Internal error
+esp_err_t Ota::eraseProgress() {
+  auto const err{erase("progress")};
+  return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+}
+
+} // namespace mem::nvs
@@ -0,0 +1,44 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// NVS "ota" namespace
+///
+/// \file   mem/nvs/ota.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "base.hpp"
+
+namespace mem::nvs {
+
+/// Progress of OTA upload stored in NVS
+///
+/// Ota stores the last checkpoint of a resumable \ref page_mw_ota "OTA" upload
+/// as blob under the key "progress" in the NVS namespace "ota". The layout of
+/// the blob is up to \ref mw::ota.
+class Ota : public Base {
+public:
+  Ota() : Base{"ota", NVS_READWRITE} {}
+
+  std::string getProgress() const;
+  esp_err_t setProgress(std::string_view blob);
+  esp_err_t eraseProgress();
+};
+
+} // namespace mem::nvs
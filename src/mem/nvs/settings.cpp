@@ -41,8 +41,8 @@ std::string Settings::getStationmDNS() const { return getBlob("sta_mdns"); }
 /// \retval ESP_ERR_NVS_VALUE_TOO_LONG    String value is too long
 /// \retval ESP_ERR_INVALID_ARG           Invalid mDNS
 esp_err_t Settings::setStationmDNS(std::string_view str) {
-  return str.ends_with("remise") ? setBlob("sta_mdns", str)
-                                 : ESP_ERR_INVALID_ARG;
+  return validStationmDNS(str) ? setBlob("sta_mdns", str)
+                               : ESP_ERR_INVALID_ARG;
 }
 
 /// Get station SSID
@@ -441,9 +441,8 @@ uint8_t Settings::getDccBiDiBitDuration() const {
 ///                                       write operation has failed
 /// \retval ESP_ERR_INVALID_ARG           DCC BiDi bit duration out of range
 esp_err_t Settings::setDccBiDiBitDuration(uint8_t value) {
-  return !value || (value >= 57u && value <= 61u)
-           ? setU8("dcc_bidibit_dur", value)
-           : ESP_ERR_INVALID_ARG;
+  return validDccBiDiBitDuration(value) ? setU8("dcc_bidibit_dur", value)
+                                        : ESP_ERR_INVALID_ARG;
 }
 
 /// Get DCC programming type
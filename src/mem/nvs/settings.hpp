@@ -38,6 +38,24 @@ class Settings : public Base {
 public:
   Settings() : Base{"settings", NVS_READWRITE} {}
 
+  /// Check station mDNS
+  ///
+  /// \param  str   Station mDNS
+  /// \retval true  Valid mDNS
+  /// \retval false Invalid mDNS
+  static constexpr bool validStationmDNS(std::string_view str) {
+    return str.ends_with("remise");
+  }
+
+  /// Check DCC BiDi bit duration
+  ///
+  /// \param  value DCC BiDi bit duration [us]
+  /// \retval true  Either 0 (off) or within [57, 61]
+  /// \retval false Out of range
+  static constexpr bool validDccBiDiBitDuration(uint8_t value) {
+    return !value || (value >= 57u && value <= 61u);
+  }
+
   std::string getStationmDNS() const;
   esp_err_t setStationmDNS(std::string_view str);
 
@@ -25,6 +25,7 @@
 #include "drv/led/bug.hpp"
 #include "log.h"
 #include "mem/nvs/settings.hpp"
+#include "mw/dcc/service.hpp"
 
 namespace mem::nvs {
 
@@ -51,6 +52,11 @@ void reset_sta_settings() {
 
   for (;;) {
     vTaskDelay(pdMS_TO_TICKS(1000u));
+
+    // Write dirty locos and turnouts, flush everything outside of operations
+    if (auto const dcc_service{mw::dcc::service})
+      dcc_service->persist(state.load() != State::DCCOperations);
+
     seconds = gpio_get_level(boot_gpio_num) ? 0uz : seconds + 1uz;
     if (seconds < 5uz) continue;
     drv::led::bug(true);
@@ -0,0 +1,35 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Loco speed reported through RailCom
+///
+/// \file   mw/dcc/bidi_speed.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <dcc/dcc.hpp>
+
+namespace mw::dcc {
+
+/// Speed of a single loco and the tick it was last reported at
+struct BidiSpeed {
+  ::dcc::Address::value_type addr{}; ///< Loco address
+  uint16_t speed{};                  ///< Speed [km/h]
+  TickType_t tick{};                 ///< Tick of last report
+};
+
+} // namespace mw::dcc
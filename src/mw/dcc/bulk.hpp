@@ -0,0 +1,123 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Bulk import of locos and turnouts
+///
+/// \file   mw/dcc/bulk.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <ArduinoJson.h>
+#include <dcc/dcc.hpp>
+#include <esp_err.h>
+#include <expected>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace mw::dcc {
+
+/// Item which got skipped by bulk_put()
+struct BulkError {
+  size_t index{};           ///< Index of item in array
+  std::string_view error{}; ///< Reason
+};
+
+/// Get address of an item
+///
+/// \param  item  Item of array
+/// \return Non-zero address or reason why item can't be applied
+inline std::expected<::dcc::Address::value_type, std::string_view>
+bulk_address(JsonVariantConst item) {
+  if (!item.is<JsonObjectConst>())
+    return std::unexpected<std::string_view>{"Not an object"};
+  JsonVariantConst v{item["address"]};
+  if (!v.is<::dcc::Address::value_type>() ||
+      !v.as<::dcc::Address::value_type>())
+    return std::unexpected<std::string_view>{"Invalid address"};
+  return v.as<::dcc::Address::value_type>();
+}
+
+/// Apply an array of locos or turnouts in one pass
+///
+/// Every item must be an object containing a non-zero `address`. Existing
+/// entries get updated, missing ones inserted. Items which can't be applied
+/// are skipped and reported, all others are still applied.
+///
+/// \tparam T     Map type
+/// \tparam F     Callable type
+/// \param  map   Map of locos or turnouts
+/// \param  arr   Array of locos or turnouts
+/// \param  f     Called with index, address and entry of every applied item
+/// \return Skipped items
+template<typename T, typename F>
+std::vector<BulkError> bulk_put(T& map, JsonArrayConst arr, F&& f) {
+  std::vector<BulkError> retval;
+  auto i{0uz};
+  for (JsonVariantConst item : arr) {
+    if (auto const addr{bulk_address(item)}; !addr)
+      retval.push_back({.index = i, .error = addr.error()});
+    else {
+      auto& entry{map.try_emplace(*addr).first->second};
+      entry.fromJsonDocument(item);
+      std::invoke(f, i, *addr, entry);
+    }
+    ++i;
+  }
+  return retval;
+}
+
+/// Apply an array of locos or turnouts in one pass and persist it
+///
+/// Same as bulk_put(T&, JsonArrayConst, F&&), but every applied entry also
+/// gets written to `nvs`. Entries which can't be written are rolled back and
+/// reported, so that RAM and NVS stay consistent.
+///
+/// \tparam Nvs   Type of NVS namespace
+/// \tparam T     Map type
+/// \tparam F     Callable type
+/// \param  nvs   NVS namespace
+/// \param  map   Map of locos or turnouts
+/// \param  arr   Array of locos or turnouts
+/// \param  f     Called with index, address and entry of every applied item
+///               before it gets written
+/// \return Skipped items
+template<typename Nvs, typename T, typename F>
+std::vector<BulkError> bulk_put(Nvs& nvs, T& map, JsonArrayConst arr, F&& f) {
+  std::vector<BulkError> retval;
+  auto i{0uz};
+  for (JsonVariantConst item : arr) {
+    if (auto const addr{bulk_address(item)}; !addr)
+      retval.push_back({.index = i, .error = addr.error()});
+    else {
+      auto const [it, inserted]{map.try_emplace(*addr)};
+      auto previous{inserted ? std::nullopt : std::optional{it->second}};
+      it->second.fromJsonDocument(item);
+      std::invoke(f, i, *addr, it->second);
+      if (auto const err{nvs.set(*addr, it->second)}) {
+        retval.push_back({.index = i, .error = esp_err_to_name(err)});
+        if (previous) it->second = std::move(*previous);
+        else map.erase(it);
+      }
+    }
+    ++i;
+  }
+  return retval;
+}
+
+} // namespace mw::dcc
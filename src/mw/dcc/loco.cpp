@@ -19,10 +19,10 @@
 namespace mw::dcc {
 
 /// \todo document
-NvLocoBase::NvLocoBase(JsonDocument const& doc) { fromJsonDocument(doc); }
+NvLocoBase::NvLocoBase(JsonVariantConst doc) { fromJsonDocument(doc); }
 
 /// \todo document
-void NvLocoBase::fromJsonDocument(JsonDocument const& doc) {
+void NvLocoBase::fromJsonDocument(JsonVariantConst doc) {
   if (JsonVariantConst v{doc["name"]}; v.is<std::string>())
     name = v.as<std::string>();
 
@@ -43,11 +43,12 @@ JsonDocument NvLocoBase::toJsonDocument() const {
 }
 
 /// \todo document
-Loco::Loco(JsonDocument const& doc) { fromJsonDocument(doc); }
+Loco::Loco(JsonVariantConst doc) { fromJsonDocument(doc); }
 
 /// \todo document
-void Loco::fromJsonDocument(JsonDocument const& doc) {
+void Loco::fromJsonDocument(JsonVariantConst doc) {
   NvLocoBase::fromJsonDocument(doc);
+  invalidate();
 
   if (JsonVariantConst v{doc["rvvvvvvv"]}; v.is<uint8_t>()) rvvvvvvv = v;
 
@@ -87,4 +88,15 @@ JsonDocument Loco::toJsonDocument() const {
   return doc;
 }
 
+/// Get serialized JSON
+///
+/// The result of toJsonDocument() is serialized once and cached until the
+/// next call to invalidate().
+///
+/// \return Serialized JSON
+std::string const& Loco::toJson() const {
+  if (empty(json)) serializeJson(toJsonDocument(), json);
+  return json;
+}
+
 } // namespace mw::dcc
@@ -31,9 +31,9 @@ namespace z21 = ::z21;
 /// Non-volatile base
 struct NvLocoBase : z21::LocoInfo {
   constexpr NvLocoBase() = default;
-  explicit NvLocoBase(JsonDocument const& doc);
+  explicit NvLocoBase(JsonVariantConst doc);
 
-  void fromJsonDocument(JsonDocument const& doc);
+  void fromJsonDocument(JsonVariantConst doc);
   JsonDocument toJsonDocument() const;
 
   std::string name{};
@@ -42,13 +42,20 @@ struct NvLocoBase : z21::LocoInfo {
 /// Actual object with volatile and non-volatile stuff
 struct Loco : NvLocoBase {
   constexpr Loco() = default;
-  explicit Loco(JsonDocument const& doc);
+  explicit Loco(JsonVariantConst doc);
 
-  void fromJsonDocument(JsonDocument const& doc);
+  void fromJsonDocument(JsonVariantConst doc);
   JsonDocument toJsonDocument() const;
+  std::string const& toJson() const;
+  void invalidate() { json.clear(); }
 
   uint64_t priority{};
   z21::RailComData bidi{};
+  TickType_t bidi_speed_tick{}; ///< Tick of last RailCom speed
+  uint32_t revision{};          ///< Revision of last change
+
+  /// Serialized toJsonDocument(), empty if invalid
+  mutable std::string json{};
 };
 
 } // namespace mw::dcc
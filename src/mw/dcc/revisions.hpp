@@ -0,0 +1,76 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Revisions of locos and turnouts
+///
+/// \file   mw/dcc/revisions.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace mw::dcc {
+
+/// Revision counter which stays unique across reboots
+///
+/// Revisions get reserved in blocks of \ref revision_block. The end of a block
+/// is persisted before its first revision gets handed out and the next boot
+/// continues from there. A revision a client learned before a reboot is thus
+/// always older than any revision of the current boot.
+class Revisions {
+public:
+  using Reserve = std::function<void(uint32_t)>;
+
+  /// Ctor
+  ///
+  /// \param  reserved  End of block reserved by previous boot
+  /// \param  reserve   Persist end of newly reserved block
+  Revisions(uint32_t reserved, Reserve reserve)
+    : _reserve{std::move(reserve)}, _revision{reserved}, _reserved{reserved} {}
+
+  /// Get next revision
+  ///
+  /// \return Next revision
+  uint32_t next() {
+    if (_revision == _reserved) _reserve(_reserved += revision_block);
+    return ++_revision;
+  }
+
+  /// Get current revision
+  ///
+  /// \return Current revision
+  uint32_t current() const { return _revision; }
+
+private:
+  Reserve _reserve;
+  uint32_t _revision;
+  uint32_t _reserved;
+};
+
+/// Check whether a client has to reload a collection completely
+///
+/// \param  since     Revision known by client
+/// \param  floor     Oldest revision deltas can be computed from
+/// \param  revision  Current revision
+/// \retval true      Full reload
+/// \retval false     Delta
+constexpr bool full_reload(uint32_t since, uint32_t floor, uint32_t revision) {
+  return since < floor || since > revision;
+}
+
+} // namespace mw::dcc
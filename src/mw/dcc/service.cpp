@@ -19,9 +19,13 @@
 #include <static_math/static_math.h>
 #include <dcc/dcc.hpp>
 #include <ranges>
+#include "bulk.hpp"
 #include "drv/led/bug.hpp"
+#include "intf/http/chunk_writer.hpp"
+#include "intf/http/schema.hpp"
 #include "log.h"
 #include "mem/nvs/accessories.hpp"
+#include "mem/nvs/dcc.hpp"
 #include "mem/nvs/locos.hpp"
 #include "mem/nvs/settings.hpp"
 #include "mem/nvs/turnouts.hpp"
@@ -32,26 +36,59 @@ namespace mw::dcc {
 
 using namespace std::literals;
 
+namespace {
+
+/// Body of /dcc/ POST request
+struct PostRequest {
+  std::optional<uint8_t> central_state;
+};
+
+/// Schema of /dcc/ POST request
+constexpr std::array post_schema{
+  intf::http::field("central_state", &PostRequest::central_state)};
+
+} // namespace
+
 /// \todo document
-Service::Service() {
+Service::Service()
+  : _revisions{mem::nvs::Dcc{}.getRevision(), [](uint32_t reserved) {
+                 if (auto const err{mem::nvs::Dcc{}.setRevision(reserved)})
+                   LOGE("Reserving revisions failed %s", esp_err_to_name(err));
+               }} {
   for (mem::nvs::Locos nvs; auto const& entry_info : nvs) {
     auto const addr{mem::nvs::key2address(entry_info.key)};
     dynamic_cast<NvLocoBase&>(_locos[addr]) = nvs.get(entry_info.key);
+    changed(_locos[addr]);
   }
 
   for (mem::nvs::Turnouts nvs; auto const& entry_info : nvs) {
     auto const addr{mem::nvs::key2address(entry_info.key)};
     dynamic_cast<NvTurnoutBase&>(_turnouts[addr]) = nvs.get(entry_info.key);
+    changed(_turnouts[addr]);
   }
 
+  // Revisions of previous boots are older than the floor and require a full
+  // reload, even if no loco or turnout got loaded
+  _tombstones.locos.floor = _tombstones.turnouts.floor = _revisions.next();
+
   task.function = ztl::make_trampoline(this, &Service::taskFunction);
 }
 
-/// \todo document
+/// Set Z21 services
+///
+/// The Z21 server walks its client registry on every broadcast, which only the
+/// task owning the registry may do. Broadcasts of this service therefore never
+/// call into the Z21 server directly, but get posted through `z21_post`.
+///
+/// \param  z21_system_service  Z21 system service
+/// \param  z21_dcc_service     Z21 DCC service
+/// \param  z21_post            Run work on the task owning the client registry
 void Service::z21(std::shared_ptr<z21::server::intf::System> z21_system_service,
-                  std::shared_ptr<z21::server::intf::Dcc> z21_dcc_service) {
+                  std::shared_ptr<z21::server::intf::Dcc> z21_dcc_service,
+                  Z21Post z21_post) {
   _z21_system_service = z21_system_service;
   _z21_dcc_service = z21_dcc_service;
+  _z21_post = std::move(z21_post);
 }
 
 /// \todo document
@@ -67,79 +104,353 @@ intf::http::Response Service::getRequest(intf::http::Request const& req) {
 
 /// \todo document
 intf::http::Response Service::postRequest(intf::http::Request const& req) {
-  // Validate body
-  if (!validate_json(req.body))
-    return std::unexpected<std::string>{"415 Unsupported Media Type"};
-
   // Deserialize
-  JsonDocument doc;
-  if (auto const err{deserializeJson(doc, req.body)}) {
-    LOGE("Deserialization failed %s", err.c_str());
-    return std::unexpected<std::string>{"500 Internal Server Error"};
-  }
+  auto const doc{intf::http::parse_json(req.body)};
+  if (!doc) return std::unexpected<std::string>{doc.error()};
+  auto const body{intf::http::bind_json(*doc, post_schema)};
+  if (!body) return std::unexpected<std::string>{"422 Unprocessable Entity"};
 
   // LAN_X_SET_TRACK_POWER_OFF / LAN_X_SET_TRACK_POWER_ON
-  if (JsonVariantConst v{doc["central_state"]}; v.is<uint8_t>()) {
+  if (body->central_state) {
     if (auto const is_on{!std::to_underlying(
           _z21_system_service->systemState().central_state &
           z21::CentralState::TrackVoltageOff)},
-        should_be_on{!(v.as<uint8_t>() &
+        should_be_on{!(*body->central_state &
                        std::to_underlying(z21::CentralState::TrackVoltageOff))};
         !is_on && should_be_on) {
       _z21_system_service->trackPower(true);
-      _z21_system_service->broadcastTrackPowerOn();
+      _z21_post([this] { _z21_system_service->broadcastTrackPowerOn(); });
     } else if (is_on && !should_be_on) {
       _z21_system_service->trackPower(false);
-      _z21_system_service->broadcastTrackPowerOff();
+      _z21_post([this] { _z21_system_service->broadcastTrackPowerOff(); });
     }
   }
 
   return {};
 }
 
+/// Get JSON of a loco or turnout including its address
+///
+/// The cached JSON of the entry is copied and its address appended, which
+/// yields the same output as serializing toJsonDocument() with an additional
+/// "address" member.
+///
+/// \tparam T     Loco or turnout type
+/// \param  addr  Address
+/// \param  t     Loco or turnout
+/// \return Serialized JSON
+template<typename T>
+std::string Service::toJson(Address::value_type addr, T const& t) const {
+  (empty(t.json) ? json_cache_misses : json_cache_hits)
+    .fetch_add(1u, std::memory_order_relaxed);
+  auto const& json{t.toJson()};
+  std::string retval;
+  retval.reserve(size(json) + 16uz);
+  retval.append(json, 0uz, size(json) - 1uz); // Strip closing brace
+  retval.append(R"(,"address":)").append(std::to_string(addr)).push_back('}');
+  return retval;
+}
+
+/// Get JSON of the element following an address
+///
+/// \tparam T     Map type
+/// \param  map   Map of locos or turnouts
+/// \param  addr  Address of previous element, gets advanced
+/// \param  since Skip elements which haven't changed after this revision
+/// \return JSON of next element or std::nullopt at the end
+template<typename T>
+std::optional<std::string>
+Service::nextJson(T const& map,
+                  std::optional<Address::value_type>& addr,
+                  uint32_t since) {
+  std::lock_guard lock{_internal_mutex};
+  auto it{addr ? map.upper_bound(*addr) : cbegin(map)};
+  while (it != cend(map) && it->second.revision <= since) ++it;
+  if (it == cend(map)) return std::nullopt;
+  addr = it->first;
+  return toJson(it->first, it->second);
+}
+
+/// Serialize changes since a revision
+///
+/// The output is a single object containing the current revision, all entries
+/// which changed and all addresses which got deleted after `since`. If `since`
+/// is too old to know about all deletions (or from a previous boot), `full` is
+/// set and all entries are included instead. Clients must then replace their
+/// whole collection.
+///
+/// \code{.json}
+/// {"revision":42,"full":false,"changed":[{..., "address":3}],"deleted":[5]}
+/// \endcode
+///
+/// \tparam T           Map type
+/// \param  map         Map of locos or turnouts
+/// \param  tombstones  Deleted addresses of map
+/// \param  since       Revision known by client
+/// \param  send        Function sending a single chunk
+/// \retval true        All chunks sent
+/// \retval false       Sending failed
+template<typename T>
+bool Service::serializeDelta(T const& map,
+                             Tombstones const& tombstones,
+                             uint32_t since,
+                             intf::http::Send const& send) {
+  uint32_t revision;
+  bool full;
+  std::vector<Address::value_type> deleted;
+  {
+    std::lock_guard lock{_internal_mutex};
+    revision = _revisions.current();
+    full = full_reload(since, tombstones.floor, revision);
+    if (full) since = 0u;
+    else
+      for (auto const [addr, rev] : tombstones.addrs)
+        if (rev > since && !map.contains(addr)) deleted.push_back(addr);
+  }
+
+  //
+  intf::http::ChunkWriter<intf::http::response_chunk_size> writer{send};
+  auto const write{[&writer](std::string_view str) {
+    writer.write(std::bit_cast<uint8_t const*>(data(str)), size(str));
+  }};
+  write(R"({"revision":)");
+  write(std::to_string(revision));
+  write(full ? R"(,"full":true,"changed":[)" : R"(,"full":false,"changed":[)");
+  std::optional<Address::value_type> addr;
+  for (auto first{true}; writer.ok(); first = false) {
+    auto const json{nextJson(map, addr, since)};
+    if (!json) break;
+    if (!first) write(",");
+    write(*json);
+  }
+  write(R"(],"deleted":[)");
+  for (auto i{0uz}; i < size(deleted); ++i) {
+    if (i) write(",");
+    write(std::to_string(deleted[i]));
+  }
+  write("]}");
+  return writer.flush();
+}
+
+/// Remember deleted address
+///
+/// At most \ref max_tombstones addresses are kept. Dropping the oldest one
+/// raises the floor, so that older revisions get a full reload.
+///
+/// \param  tombstones  Deleted addresses
+/// \param  addr        Address
+void Service::erased(Tombstones& tombstones, Address::value_type addr) {
+  tombstones.addrs[addr] = _revisions.next();
+  if (size(tombstones.addrs) <= max_tombstones) return;
+  auto const it{std::ranges::min_element(
+    tombstones.addrs, {}, [](auto const& kv) { return kv.second; })};
+  tombstones.floor = std::max(tombstones.floor, it->second);
+  tombstones.addrs.erase(it);
+}
+
+/// Forget all deleted addresses
+///
+/// Used when a whole collection gets deleted. Any older revision gets a full
+/// reload.
+///
+/// \param  tombstones  Deleted addresses
+void Service::erasedAll(Tombstones& tombstones) {
+  tombstones.addrs.clear();
+  tombstones.floor = _revisions.next();
+}
+
+/// Get next push event of the loco collection
+///
+/// \param  cursor    Position of client, gets advanced
+/// \param  max_size  Size after which no further entries are added
+/// \return Event or std::nullopt if client is up to date
+std::optional<std::string> Service::locosEvent(Cursor& cursor,
+                                               size_t max_size) {
+  return event("locos", _locos, _tombstones.locos, cursor, max_size);
+}
+
+/// Get next push event of the turnout collection
+///
+/// \param  cursor    Position of client, gets advanced
+/// \param  max_size  Size after which no further entries are added
+/// \return Event or std::nullopt if client is up to date
+std::optional<std::string> Service::turnoutsEvent(Cursor& cursor,
+                                                  size_t max_size) {
+  return event("turnouts", _turnouts, _tombstones.turnouts, cursor, max_size);
+}
+
+/// Get next push event of a collection
+///
+/// Events carry the same information as \ref serializeDelta "delta queries",
+/// but are split into pages of roughly `max_size` bytes. All pages of a round
+/// share the revision at which the round started. Only the first page of a
+/// round carries deleted addresses and `reset`, which tells clients to clear
+/// their whole collection. `more` is set on all but the last page.
+///
+/// \code{.json}
+/// {"type":"locos","revision":42,"reset":false,"changed":[...],"deleted":[5],
+///  "more":false}
+/// \endcode
+///
+/// Clients without a known revision get a full round. Entries which change
+/// while a round is in progress are sent again in the next round.
+///
+/// \tparam T           Map type
+/// \param  type        Event type
+/// \param  map         Map of locos or turnouts
+/// \param  tombstones  Deleted addresses of map
+/// \param  cursor      Position of client, gets advanced
+/// \param  max_size    Size after which no further entries are added
+/// \return Event or std::nullopt if client is up to date
+template<typename T>
+std::optional<std::string> Service::event(std::string_view type,
+                                          T const& map,
+                                          Tombstones const& tombstones,
+                                          Cursor& cursor,
+                                          size_t max_size) {
+  std::lock_guard lock{_internal_mutex};
+
+  // Start new round
+  auto const first{!cursor.active};
+  std::vector<Address::value_type> deleted;
+  if (first) {
+    if (cursor.since == _revisions.current()) return std::nullopt;
+    cursor.revision = _revisions.current();
+    cursor.full = !cursor.since ||
+                  full_reload(*cursor.since, tombstones.floor, cursor.revision);
+    cursor.addr = std::nullopt;
+    cursor.active = true;
+    if (!cursor.full)
+      for (auto const [addr, rev] : tombstones.addrs)
+        if (rev > *cursor.since && !map.contains(addr))
+          deleted.push_back(addr);
+  }
+
+  //
+  std::string json;
+  json.reserve(max_size + 256uz);
+  json.append(R"({"type":")").append(type);
+  json.append(R"(","revision":)").append(std::to_string(cursor.revision));
+  json.append(first && cursor.full ? R"(,"reset":true,"changed":[)"
+                                   : R"(,"reset":false,"changed":[)");
+
+  //
+  auto const since{cursor.full ? 0u : *cursor.since};
+  auto const skip{[&](auto it) {
+    while (it != cend(map) && it->second.revision <= since) ++it;
+    return it;
+  }};
+  auto it{skip(cursor.addr ? map.upper_bound(*cursor.addr) : cbegin(map))};
+  for (auto i{0uz}; it != cend(map) && (!i || size(json) < max_size); ++i) {
+    if (i) json.push_back(',');
+    json += toJson(it->first, it->second);
+    cursor.addr = it->first;
+    it = skip(++it);
+  }
+
+  //
+  json.append(R"(],"deleted":[)");
+  for (auto i{0uz}; i < size(deleted); ++i) {
+    if (i) json.push_back(',');
+    json += std::to_string(deleted[i]);
+  }
+  auto const more{it != cend(map)};
+  json.append(more ? R"(],"more":true})" : R"(],"more":false})");
+
+  // Round done
+  if (!more) {
+    cursor.since = cursor.revision;
+    cursor.active = false;
+  }
+
+  return json;
+}
+
+/// Bulk PUT request
+///
+/// Applies all items of an array and writes them to NVS with a single commit.
+/// Both happen under the same lock, so concurrent requests get persisted in
+/// the same order they got applied. Items which can't be applied or persisted
+/// are rolled back and reported by their index, all others are kept.
+///
+/// \code{.json}
+/// {"imported":998,"errors":[{"index":3,"error":"Invalid address"}]}
+/// \endcode
+///
+/// \tparam Nvs Type of NVS namespace
+/// \tparam T   Map type
+/// \param  map Map of locos or turnouts
+/// \param  arr Array of locos or turnouts
+/// \return JSON
+template<typename Nvs, typename T>
+intf::http::Response Service::bulkPut(T& map, JsonArrayConst arr) {
+  std::vector<BulkError> errors;
+  {
+    std::lock_guard lock{_internal_mutex};
+    Nvs nvs; // Single commit when nvs goes out of scope
+    errors = bulk_put(
+      nvs, map, arr, [this](size_t, auto, auto& entry) { changed(entry); });
+  }
+  auto const imported{size(arr) - size(errors)};
+
+  //
+  JsonDocument doc;
+  doc["imported"] = imported;
+  JsonArray arr_errors{doc["errors"].to<JsonArray>()};
+  for (auto const& e : errors) {
+    JsonObject obj{arr_errors.add<JsonObject>()};
+    obj["index"] = e.index;
+    obj["error"] = e.error;
+  }
+
+  std::string json;
+  json.reserve(32uz + size(errors) * 48uz);
+  serializeJson(doc, json);
+  return json;
+}
+
 /// \todo document
-/// \todo filters?
 intf::http::Response Service::locosGetRequest(intf::http::Request const& req) {
-  auto const addr{uri2address(req.uri).value_or(0u)};
+  auto const addr{req.address.value_or(0u)};
 
   // Singleton
   if (std::lock_guard lock{_internal_mutex}; addr) {
     auto const it{_locos.find(addr)};
     if (it == cend(_locos))
       return std::unexpected<std::string>{"404 Not Found"};
-    auto doc{it->second.toJsonDocument()};
-    doc["address"] = addr;
-    std::string json;
-    json.reserve(1024uz);
-    serializeJson(doc, json);
-    return json;
+    return toJson(addr, it->second);
   }
-  // Collection
-  else {
-    JsonDocument doc;
-    auto array{doc.to<JsonArray>()}; // Explicitly convert to array
-    for (auto const& [addr, loco] : _locos) {
-      auto loco_doc{loco.toJsonDocument()};
-      loco_doc["address"] = addr;
-      array.add(loco_doc);
-    }
-    std::string json;
-    json.reserve((size(_locos) + 1uz) * 1024uz);
-    serializeJson(doc, json);
-    return json;
+  // Changes since revision
+  else if (auto const str{uri2query(req.uri, "since")}) {
+    uint32_t since{};
+    if (auto const [ptr, ec]{
+          std::from_chars(data(*str), data(*str) + size(*str), since)};
+        ec != std::errc{} || ptr != data(*str) + size(*str))
+      return std::unexpected<std::string>{"400 Bad Request"};
+    return intf::http::Chunks{[this, since](intf::http::Send const& send) {
+      return serializeDelta(_locos, _tombstones.locos, since, send);
+    }};
   }
+  // Collection
+  else
+    return intf::http::Chunks{[this](intf::http::Send const& send) {
+      return intf::http::serialize_json_array<intf::http::response_chunk_size>(
+        send, [this, addr = std::optional<Address::value_type>{}] mutable {
+          return nextJson(_locos, addr);
+        });
+    }};
 }
 
 /// \todo document
 /// \todo filters?
 intf::http::Response
 Service::locosDeleteRequest(intf::http::Request const& req) {
-  auto const addr{uri2address(req.uri).value_or(0u)};
+  auto const addr{req.address.value_or(0u)};
 
   // Singleton
   if (std::lock_guard lock{_internal_mutex}; addr) {
     // Erase (doesn't matter if it exists or not)
-    _locos.erase(addr);
+    if (_locos.erase(addr)) erased(_tombstones.locos, addr);
     mem::nvs::Locos nvs;
     nvs.erase(addr);
   }
@@ -147,6 +458,7 @@ Service::locosDeleteRequest(intf::http::Request const& req) {
   else if (req.uri == "/dcc/locos/"sv) {
     // Erase all
     _locos.clear();
+    erasedAll(_tombstones.locos);
     mem::nvs::Locos nvs;
     nvs.eraseAll();
   }
@@ -156,22 +468,22 @@ Service::locosDeleteRequest(intf::http::Request const& req) {
 
 /// \todo document
 intf::http::Response Service::locosPutRequest(intf::http::Request const& req) {
-  // Validate body
-  if (!validate_json(req.body))
-    return std::unexpected<std::string>{"415 Unsupported Media Type"};
+  // Deserialize
+  auto const parsed{intf::http::parse_json(req.body)};
+  if (!parsed) return std::unexpected<std::string>{parsed.error()};
+  auto const& doc{*parsed};
+
+  // Collection
+  if (req.uri == "/dcc/locos/"sv) {
+    if (JsonArrayConst arr{doc.as<JsonArrayConst>()})
+      return bulkPut<mem::nvs::Locos>(_locos, arr);
+    return std::unexpected<std::string>{"417 Expectation Failed"};
+  }
 
   // Address not found or other characters appended to it
-  // We currently only support singleton
-  auto addr{uri2address(req.uri).value_or(0u)};
+  auto addr{req.address.value_or(0u)};
   if (!addr) return std::unexpected<std::string>{"417 Expectation Failed"};
 
-  // Deserialize
-  JsonDocument doc;
-  if (auto const err{deserializeJson(doc, req.body)}) {
-    LOGE("Deserialization failed %s", err.c_str());
-    return std::unexpected<std::string>{"500 Internal Server Error"};
-  }
-
   std::lock_guard lock{_internal_mutex};
   auto it{_locos.find(addr)};
   mem::nvs::Locos nvs;
@@ -196,6 +508,7 @@ intf::http::Response Service::locosPutRequest(intf::http::Request const& req) {
     if (auto const ret{_locos.insert(move(node))}; ret.inserted) {
       it = ret.position;                  // Update iterator
       nvs.erase(addr);                    // Erase old address
+      erased(_tombstones.locos, addr);   // Remember old address
       addr = v.as<Address::value_type>(); // Update address
     }
     // Insertion failed
@@ -206,6 +519,7 @@ intf::http::Response Service::locosPutRequest(intf::http::Request const& req) {
   else
     it->second.fromJsonDocument(doc); // Update iterator
 
+  changed(it->second);
   nvs.set(addr, it->second);
 
   return {};
@@ -214,45 +528,45 @@ intf::http::Response Service::locosPutRequest(intf::http::Request const& req) {
 /// \todo document
 intf::http::Response
 Service::turnoutsGetRequest(intf::http::Request const& req) {
-  auto const addr{uri2address(req.uri).value_or(0u)};
+  auto const addr{req.address.value_or(0u)};
 
   // Singleton
   if (std::lock_guard lock{_internal_mutex}; addr) {
     auto const it{_turnouts.find(addr)};
     if (it == cend(_turnouts))
       return std::unexpected<std::string>{"404 Not Found"};
-    auto doc{it->second.toJsonDocument()};
-    doc["address"] = addr;
-    std::string json;
-    json.reserve(1024uz);
-    serializeJson(doc, json);
-    return json;
+    return toJson(addr, it->second);
   }
-  // Collection
-  else {
-    JsonDocument doc;
-    auto array{doc.to<JsonArray>()}; // Explicitly convert to array
-    for (auto const& [addr, turnout] : _turnouts) {
-      auto turnout_doc{turnout.toJsonDocument()};
-      turnout_doc["address"] = addr;
-      array.add(turnout_doc);
-    }
-    std::string json;
-    json.reserve((size(_turnouts) + 1uz) * 1024uz);
-    serializeJson(doc, json);
-    return json;
+  // Changes since revision
+  else if (auto const str{uri2query(req.uri, "since")}) {
+    uint32_t since{};
+    if (auto const [ptr, ec]{
+          std::from_chars(data(*str), data(*str) + size(*str), since)};
+        ec != std::errc{} || ptr != data(*str) + size(*str))
+      return std::unexpected<std::string>{"400 Bad Request"};
+    return intf::http::Chunks{[this, since](intf::http::Send const& send) {
+      return serializeDelta(_turnouts, _tombstones.turnouts, since, send);
+    }};
   }
+  // Collection
+  else
+    return intf::http::Chunks{[this](intf::http::Send const& send) {
+      return intf::http::serialize_json_array<intf::http::response_chunk_size>(
+        send, [this, addr = std::optional<Address::value_type>{}] mutable {
+          return nextJson(_turnouts, addr);
+        });
+    }};
 }
 
 /// \todo document
 intf::http::Response
 Service::turnoutsDeleteRequest(intf::http::Request const& req) {
-  auto const addr{uri2address(req.uri).value_or(0u)};
+  auto const addr{req.address.value_or(0u)};
 
   // Singleton
   if (std::lock_guard lock{_internal_mutex}; addr) {
     // Erase (doesn't matter if it exists or not)
-    _turnouts.erase(addr);
+    if (_turnouts.erase(addr)) erased(_tombstones.turnouts, addr);
     mem::nvs::Turnouts nvs;
     nvs.erase(addr);
   }
@@ -260,6 +574,7 @@ Service::turnoutsDeleteRequest(intf::http::Request const& req) {
   else if (req.uri == "/dcc/turnouts/"sv) {
     // Erase all
     _turnouts.clear();
+    erasedAll(_tombstones.turnouts);
     mem::nvs::Turnouts nvs;
     nvs.eraseAll();
   }
@@ -270,22 +585,22 @@ Service::turnoutsDeleteRequest(intf::http::Request const& req) {
 /// \todo document
 intf::http::Response
 Service::turnoutsPutRequest(intf::http::Request const& req) {
-  // Validate body
-  if (!validate_json(req.body))
-    return std::unexpected<std::string>{"415 Unsupported Media Type"};
+  // Deserialize
+  auto const parsed{intf::http::parse_json(req.body)};
+  if (!parsed) return std::unexpected<std::string>{parsed.error()};
+  auto const& doc{*parsed};
+
+  // Collection
+  if (req.uri == "/dcc/turnouts/"sv) {
+    if (JsonArrayConst arr{doc.as<JsonArrayConst>()})
+      return bulkPut<mem::nvs::Turnouts>(_turnouts, arr);
+    return std::unexpected<std::string>{"417 Expectation Failed"};
+  }
 
   // Address not found or other characters appended to it
-  // We currently only support singleton
-  auto addr{uri2address(req.uri).value_or(0u)};
+  auto addr{req.address.value_or(0u)};
   if (!addr) return std::unexpected<std::string>{"417 Expectation Failed"};
 
-  // Deserialize
-  JsonDocument doc;
-  if (auto const err{deserializeJson(doc, req.body)}) {
-    LOGE("Deserialization failed %s", err.c_str());
-    return std::unexpected<std::string>{"500 Internal Server Error"};
-  }
-
   std::lock_guard lock{_internal_mutex};
   auto it{_turnouts.find(addr)};
   mem::nvs::Turnouts nvs;
@@ -310,6 +625,7 @@ Service::turnoutsPutRequest(intf::http::Request const& req) {
     if (auto const ret{_turnouts.insert(move(node))}; ret.inserted) {
       it = ret.position;                  // Update iterator
       nvs.erase(addr);                    // Erase old address
+      erased(_tombstones.turnouts, addr);   // Remember old address
       addr = v.as<Address::value_type>(); // Update address
     }
     // Insertion failed
@@ -320,11 +636,33 @@ Service::turnoutsPutRequest(intf::http::Request const& req) {
   else
     it->second.fromJsonDocument(doc); // Update iterator
 
+  changed(it->second);
   nvs.set(addr, it->second);
 
   return {};
 }
 
+/// Get RailCom speeds of all locos
+///
+/// Only locos which have reported their speed through RailCom at least once
+/// are included. Each speed carries the tick of its last report, so callers
+/// can tell stale ones apart.
+///
+/// \return RailCom speeds
+std::vector<BidiSpeed> Service::bidiSpeeds() {
+  std::vector<BidiSpeed> speeds;
+  std::lock_guard lock{_internal_mutex};
+  for (auto const& [addr, loco] : _locos)
+    if (auto const options{std::to_underlying(loco.bidi.options)};
+        options & std::to_underlying(z21::RailComData::Options::Speed1))
+      speeds.push_back({addr, loco.bidi.speed, loco.bidi_speed_tick});
+    else if (options & std::to_underlying(z21::RailComData::Options::Speed2))
+      speeds.push_back({addr,
+                        static_cast<uint16_t>(256u + loco.bidi.speed),
+                        loco.bidi_speed_tick});
+  return speeds;
+}
+
 /// \todo document
 [[noreturn]] void Service::taskFunction(void*) {
   switch (state.load()) {
@@ -349,11 +687,14 @@ void Service::operationsLoop() {
     operationsLocos();
     operationsTurnouts();
     operationsBiDi();
+    operationsBroadcast();
     vTaskDelay(pdMS_TO_TICKS(task.timeout));
 
     // Temporarily switch over to service mode
     if (!empty(_cv_request_deque)) serviceLoop();
   }
+  operationsBroadcast(true);
+  persist(true);
 }
 
 /// Currently fills message buffer between 25 and 50%
@@ -468,7 +809,6 @@ void Service::operationsBiDi() {
       }
       //
       else if (auto dyn{get_if<bidi::app::Dyn>(&dg)}) {
-        bool broadcast{};
         {
           std::lock_guard lock{_internal_mutex};
           if (auto const it{_locos.find(addr)}; it != cend(_locos)) {
@@ -484,6 +824,7 @@ void Service::operationsBiDi() {
                        z21::RailComData::Options::Speed1)) |
                     z21::RailComData::Options::Speed1);
                 it->second.bidi.speed = dyn->d;
+                it->second.bidi_speed_tick = xTaskGetTickCount();
                 break;
               // Speed (>255)
               case 1u:
@@ -494,6 +835,7 @@ void Service::operationsBiDi() {
                        z21::RailComData::Options::Speed1)) |
                     z21::RailComData::Options::Speed2);
                 it->second.bidi.speed = dyn->d;
+                it->second.bidi_speed_tick = xTaskGetTickCount();
                 break;
               // QoS
               case 7u:
@@ -503,10 +845,12 @@ void Service::operationsBiDi() {
                 it->second.bidi.qos = dyn->d;
                 break;
             }
-            broadcast = it->second.bidi != bidi_before;
+            if (it->second.bidi != bidi_before) {
+              changed(it->second);
+              _dirty.railcom.addrs.insert(addr);
+            }
           }
         }
-        if (broadcast) broadcastRailComData(addr);
       }
     }
   }
@@ -519,6 +863,93 @@ void Service::operationsBiDi() {
   }
 }
 
+/// Broadcast state which changed since the last broadcast
+///
+/// State changes only mark loco, turnout or RailCom entries dirty. This
+/// function then broadcasts the latest state of all dirty entries, but at most
+/// once every \ref loco_info_interval, \ref turnout_info_interval and \ref
+/// railcom_data_interval respectively. No matter how often a state changes or
+/// how many locos report through RailCom, the traffic sent to clients stays
+/// bounded.
+///
+/// \param  force  Broadcast all dirty entries regardless of interval
+void Service::operationsBroadcast(bool force) {
+  std::set<uint16_t> locos, turnouts, railcom;
+
+  //
+  {
+    std::lock_guard lock{_internal_mutex};
+    auto const tick{xTaskGetTickCount()};
+    auto const take{[force, tick](Dirty& dirty,
+                                  uint32_t interval,
+                                  std::set<uint16_t>& addrs) {
+      if (empty(dirty.addrs) ||
+          (!force && tick - dirty.last_tick < pdMS_TO_TICKS(interval)))
+        return;
+      addrs.swap(dirty.addrs);
+      dirty.last_tick = tick;
+    }};
+    take(_dirty.locos, loco_info_interval, locos);
+    take(_dirty.turnouts, turnout_info_interval, turnouts);
+    take(_dirty.railcom, railcom_data_interval, railcom);
+  }
+
+  // Broadcasts get posted to the Z21 exec task, which calls back into this
+  // service, so don't hold the lock
+  for (auto const addr : locos) broadcastLocoInfo(addr);
+  for (auto const addr : turnouts) broadcastTurnoutInfo(addr);
+  for (auto const addr : railcom) broadcastRailComData(addr);
+}
+
+/// Write locos and turnouts which changed since the last write to NVS
+///
+/// Writing to flash is slow, so driving or switching only marks entries dirty.
+/// The low priority \ref mem::nvs::task pulls the dirty set and writes the
+/// latest state of all dirty entries at most once every \ref nvs_interval.
+/// This keeps flash writes out of the operations loop and therefore out of the
+/// track packet stream.
+///
+/// \param  force  Write all dirty entries regardless of interval
+void Service::persist(bool force) {
+  std::vector<std::pair<uint16_t, Loco>> locos;
+  std::vector<std::pair<uint16_t, Turnout>> turnouts;
+
+  //
+  {
+    std::lock_guard lock{_internal_mutex};
+    auto const tick{xTaskGetTickCount()};
+    auto const due{[force, tick](Dirty& dirty) {
+      if (empty(dirty.addrs) ||
+          (!force && tick - dirty.last_tick < pdMS_TO_TICKS(nvs_interval)))
+        return false;
+      dirty.last_tick = tick;
+      return true;
+    }};
+    if (due(_dirty.nvs_locos)) {
+      for (auto const addr : _dirty.nvs_locos.addrs)
+        if (auto const it{_locos.find(addr)}; it != cend(_locos))
+          locos.push_back(*it);
+      _dirty.nvs_locos.addrs.clear();
+    }
+    if (due(_dirty.nvs_turnouts)) {
+      for (auto const addr : _dirty.nvs_turnouts.addrs)
+        if (auto const it{_turnouts.find(addr)}; it != cend(_turnouts))
+          turnouts.push_back(*it);
+      _dirty.nvs_turnouts.addrs.clear();
+    }
+  }
+
+  //
+  if (!empty(locos)) {
+    mem::nvs::Locos nvs;
+    for (auto const& [addr, loco] : locos) nvs.set(addr, loco);
+  }
+  if (!empty(turnouts)) {
+    mem::nvs::Turnouts nvs;
+    for (auto const& [addr, turnout] : turnouts) nvs.set(addr, turnout);
+  }
+}
+
 /// \todo document
 void Service::serviceLoop() {
   drv::led::Bug const led_bug{};
@@ -558,7 +989,7 @@ void Service::serviceLoop() {
     if (!state.compare_exchange_strong(expected, State::DCCOperations))
       assert(false);
     resume();
-    _z21_system_service->broadcastTrackPowerOn();
+    _z21_post([this] { _z21_system_service->broadcastTrackPowerOn(); });
   }
 }
 
@@ -663,8 +1094,10 @@ void Service::locoEStop(uint16_t loco_addr) {
   if (!loco_addr) {
     {
       std::lock_guard lock{_internal_mutex};
-      for (auto& [addr, loco] : _locos)
+      for (auto& [addr, loco] : _locos) {
         loco.rvvvvvvv = (loco.rvvvvvvv & ztl::mask<7u>) | 0b1u;
+        changed(loco);
+      }
     }
     sendToFront(
       make_speed_and_direction_packet(0u, dcc::encode_rggggg(true, dcc::EStop)),
@@ -676,13 +1109,13 @@ void Service::locoEStop(uint16_t loco_addr) {
     std::lock_guard lock{_internal_mutex};
     auto& loco{getOrInsertLoco(loco_addr)};
     loco.rvvvvvvv = (loco.rvvvvvvv & ztl::mask<7u>) | 0b1u;
+    changed(loco);
     sendToFront(
       make_speed_and_direction_packet(basicOrExtendedLocoAddress(loco_addr),
                                       (loco.rvvvvvvv & 0x80u) >> 2u | // R
                                         (loco.rvvvvvvv & 0x0Fu)),
       _nvs.program_packet_count);
-    mem::nvs::Locos nvs;
-    nvs.set(loco_addr, loco);
+    persistLoco(loco_addr, loco);
   }
 
   //
@@ -694,7 +1127,7 @@ void Service::locoPurge(uint16_t loco_addr) {
   if (!loco_addr) return;
   else {
     std::lock_guard lock{_internal_mutex};
-    _locos.erase(loco_addr);
+    if (_locos.erase(loco_addr)) erased(_tombstones.locos, loco_addr);
     mem::nvs::Locos nvs;
     nvs.erase(loco_addr);
   }
@@ -706,8 +1139,7 @@ z21::LocoInfo Service::locoInfo(uint16_t loco_addr) {
   else {
     std::lock_guard lock{_internal_mutex};
     auto& loco{getOrInsertLoco(loco_addr)};
-    mem::nvs::Locos nvs;
-    nvs.set(loco_addr, loco);
+    persistLoco(loco_addr, loco);
     return loco;
   }
 }
@@ -725,12 +1157,12 @@ void Service::locoDrive(uint16_t loco_addr,
     if (loco.speed_steps == speed_steps && loco.rvvvvvvv == rvvvvvvv) return;
     loco.speed_steps = speed_steps;
     loco.rvvvvvvv = rvvvvvvv;
-    mem::nvs::Locos nvs;
-    nvs.set(loco_addr, loco);
+    changed(loco);
+    persistLoco(loco_addr, loco);
   }
 
   //
-  broadcastLocoInfo(loco_addr);
+  publishLocoInfo(loco_addr);
 }
 
 /// \todo document
@@ -746,6 +1178,7 @@ void Service::locoFunction(uint16_t loco_addr, uint32_t mask, uint32_t state) {
     state = (~mask & loco.f31_0) | (mask & state);
     if (loco.f31_0 == state) return;
     loco.f31_0 = state;
+    changed(loco);
 
     // Higher functions don't get repeated, send them now
     if (mask >= (1u << 13u) &&
@@ -759,12 +1192,11 @@ void Service::locoFunction(uint16_t loco_addr, uint32_t mask, uint32_t state) {
     }
 
     //
-    mem::nvs::Locos nvs;
-    nvs.set(loco_addr, loco);
+    persistLoco(loco_addr, loco);
   }
 
   //
-  broadcastLocoInfo(loco_addr);
+  publishLocoInfo(loco_addr);
 }
 
 /// \todo document
@@ -777,17 +1209,21 @@ void Service::locoMode(uint16_t, z21::LocoInfo::Mode mode) {
   if (mode == z21::LocoInfo::MM) LOGW("MM not supported");
 }
 
-/// \todo document
+/// Broadcast loco info
+///
+/// The broadcast gets posted to the task owning the Z21 client registry.
+///
+/// \param  loco_addr Loco address
 void Service::broadcastLocoInfo(uint16_t loco_addr) {
-  _z21_dcc_service->broadcastLocoInfo(loco_addr);
+  _z21_post(
+    [this, loco_addr] { _z21_dcc_service->broadcastLocoInfo(loco_addr); });
 }
 
 /// \todo document
 z21::TurnoutInfo Service::turnoutInfo(uint16_t accy_addr) {
   std::lock_guard lock{_internal_mutex};
   auto& turnout{getOrInsertTurnout(accy_addr)};
-  mem::nvs::Turnouts nvs;
-  nvs.set(accy_addr, turnout);
+  persistTurnout(accy_addr, turnout);
   return turnout;
 }
 
@@ -819,6 +1255,7 @@ void Service::turnout(uint16_t accy_addr, bool p, bool a, bool q) {
     if (turnout.position == static_cast<z21::TurnoutInfo::Position>(1u << p))
       return;
     turnout.position = static_cast<z21::TurnoutInfo::Position>(1u << p);
+    changed(turnout);
 
     //
     if (!(_nvs.accy_flags &
@@ -827,12 +1264,11 @@ void Service::turnout(uint16_t accy_addr, bool p, bool a, bool q) {
       turnout.timeout_tick = xTaskGetTickCount() + pdMS_TO_TICKS(timeout);
     }
 
-    mem::nvs::Turnouts nvs;
-    nvs.set(accy_addr, turnout);
+    persistTurnout(accy_addr, turnout);
   }
 
   //
-  broadcastTurnoutInfo(accy_addr);
+  publishTurnoutInfo(accy_addr);
 }
 
 /// \todo document
@@ -852,12 +1288,15 @@ void Service::turnoutMode(uint16_t, z21::TurnoutInfo::Mode mode) {
 
 /// \todo document
 void Service::broadcastTurnoutInfo(uint16_t accy_addr) {
-  _z21_dcc_service->broadcastTurnoutInfo(accy_addr);
+  _z21_post(
+    [this, accy_addr] { _z21_dcc_service->broadcastTurnoutInfo(accy_addr); });
 }
 
 /// \todo document
 void Service::broadcastExtAccessoryInfo(uint16_t accy_addr) {
-  _z21_dcc_service->broadcastExtAccessoryInfo(accy_addr);
+  _z21_post([this, accy_addr] {
+    _z21_dcc_service->broadcastExtAccessoryInfo(accy_addr);
+  });
 }
 
 /// \todo document
@@ -944,15 +1383,28 @@ void Service::cvPomAccessoryWrite(uint16_t accy_addr,
     pdMS_TO_TICKS((_nvs.program_packet_count + 1u) * 10u)); // ~10ms per packet
 }
 
-/// \todo document
-void Service::cvNackShortCircuit() { _z21_dcc_service->cvNackShortCircuit(); }
+/// Broadcast CV short circuit nack
+///
+/// Called by the DCC and Z21 prog tasks, so the broadcast gets posted.
+void Service::cvNackShortCircuit() {
+  _z21_post([this] { _z21_dcc_service->cvNackShortCircuit(); });
+}
 
-/// \todo document
-void Service::cvNack() { _z21_dcc_service->cvNack(); }
+/// Broadcast CV nack
+///
+/// Called by the DCC and Z21 prog tasks, so the broadcast gets posted.
+void Service::cvNack() {
+  _z21_post([this] { _z21_dcc_service->cvNack(); });
+}
 
-/// \todo document
+/// Broadcast CV ack
+///
+/// Called by the DCC and Z21 prog tasks, so the broadcast gets posted.
+///
+/// \param  cv_addr CV address
+/// \param  byte    CV value
 void Service::cvAck(uint16_t cv_addr, uint8_t byte) {
-  _z21_dcc_service->cvAck(cv_addr, byte);
+  _z21_post([this, cv_addr, byte] { _z21_dcc_service->cvAck(cv_addr, byte); });
 }
 
 /// \todo document
@@ -965,7 +1417,65 @@ z21::RailComData Service::railComData(uint16_t loco_addr) {
 
 /// \todo document
 void Service::broadcastRailComData(uint16_t loco_addr) {
-  _z21_dcc_service->broadcastRailComData(loco_addr);
+  _z21_post(
+    [this, loco_addr] { _z21_dcc_service->broadcastRailComData(loco_addr); });
+}
+
+/// Mark loco dirty so that its info gets broadcast
+///
+/// Broadcasts are rate limited by operationsBroadcast() while in \ref
+/// State::DCCOperations "DCC operations mode". In any other state the task
+/// isn't running, so the info gets broadcast immediately.
+///
+/// \param  loco_addr Loco address
+void Service::publishLocoInfo(uint16_t loco_addr) {
+  if (state.load() != State::DCCOperations) return broadcastLocoInfo(loco_addr);
+  std::lock_guard lock{_internal_mutex};
+  _dirty.locos.addrs.insert(loco_addr);
+}
+
+/// Mark turnout dirty so that its info gets broadcast
+///
+/// Same as publishLocoInfo(), but for turnouts.
+///
+/// \param  accy_addr Accessory address
+void Service::publishTurnoutInfo(uint16_t accy_addr) {
+  if (state.load() != State::DCCOperations)
+    return broadcastTurnoutInfo(accy_addr);
+  std::lock_guard lock{_internal_mutex};
+  _dirty.turnouts.addrs.insert(accy_addr);
+}
+
+/// Write loco to NVS
+///
+/// Must be called with \ref _internal_mutex held. While in \ref
+/// State::DCCOperations "DCC operations mode" the loco only gets marked dirty
+/// and is written later by persist().
+///
+/// \param  loco_addr Loco address
+/// \param  loco      Loco
+void Service::persistLoco(uint16_t loco_addr, Loco const& loco) {
+  if (state.load() == State::DCCOperations)
+    _dirty.nvs_locos.addrs.insert(loco_addr);
+  else {
+    mem::nvs::Locos nvs;
+    nvs.set(loco_addr, loco);
+  }
+}
+
+/// Write turnout to NVS
+///
+/// Same as persistLoco(), but for turnouts.
+///
+/// \param  accy_addr Accessory address
+/// \param  turnout   Turnout
+void Service::persistTurnout(uint16_t accy_addr, Turnout const& turnout) {
+  if (state.load() == State::DCCOperations)
+    _dirty.nvs_turnouts.addrs.insert(accy_addr);
+  else {
+    mem::nvs::Turnouts nvs;
+    nvs.set(accy_addr, turnout);
+  }
 }
 
 /// \todo document
@@ -995,10 +1505,15 @@ void Service::suspend() {
 /// \todo document
 Loco& Service::getOrInsertLoco(uint16_t loco_addr) {
   assert(!_internal_mutex.try_lock());
-  auto& loco{_locos[loco_addr]};
+  auto const [it, inserted]{_locos.try_emplace(loco_addr)};
+  auto& loco{it->second};
+  if (inserted) changed(loco);
 
   //
-  if (empty(loco.name)) loco.name = std::to_string(loco_addr);
+  if (empty(loco.name)) {
+    loco.name = std::to_string(loco_addr);
+    changed(loco);
+  }
 
   return loco;
 }
@@ -1006,18 +1521,28 @@ Loco& Service::getOrInsertLoco(uint16_t loco_addr) {
 /// \todo document
 Turnout& Service::getOrInsertTurnout(uint16_t accy_addr) {
   assert(!_internal_mutex.try_lock());
-  auto& turnout{_turnouts[accy_addr]};
+  auto const [it, inserted]{_turnouts.try_emplace(accy_addr)};
+  auto& turnout{it->second};
+  if (inserted) changed(turnout);
 
   //
-  if (empty(turnout.name)) turnout.name = std::to_string(accy_addr);
+  if (empty(turnout.name)) {
+    turnout.name = std::to_string(accy_addr);
+    changed(turnout);
+  }
 
   //
-  if (empty(turnout.group.addresses)) turnout.group.addresses = {accy_addr};
+  if (empty(turnout.group.addresses)) {
+    turnout.group.addresses = {accy_addr};
+    changed(turnout);
+  }
 
   //
-  if (empty(turnout.group.positions))
+  if (empty(turnout.group.positions)) {
     turnout.group.positions = {{Turnout::Position::P0},
                                {Turnout::Position::P1}};
+    changed(turnout);
+  }
 
   return turnout;
 }
@@ -15,12 +15,17 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
 #include <mutex>
 #include <optional>
+#include <set>
 #include <z21/z21.hpp>
 #include "accessories.hpp"
+#include "bidi_speed.hpp"
 #include "intf/http/endpoints.hpp"
 #include "locos.hpp"
+#include "revisions.hpp"
 #include "turnouts.hpp"
 
 namespace mw::dcc {
@@ -30,9 +35,13 @@ class Service : public z21::server::intf::Dcc {
 public:
   Service();
 
+  /// Run work on the task owning the Z21 client registry
+  using Z21Post = std::function<void(std::function<void()>)>;
+
   //
   void z21(std::shared_ptr<z21::server::intf::System> z21_system_service,
-           std::shared_ptr<z21::server::intf::Dcc> z21_dcc_service);
+           std::shared_ptr<z21::server::intf::Dcc> z21_dcc_service,
+           Z21Post z21_post);
 
   //
   intf::http::Response getRequest(intf::http::Request const& req);
@@ -48,6 +57,23 @@ public:
   intf::http::Response turnoutsDeleteRequest(intf::http::Request const& req);
   intf::http::Response turnoutsPutRequest(intf::http::Request const& req);
 
+  //
+  std::vector<BidiSpeed> bidiSpeeds();
+
+  /// Position of a push client in the loco or turnout collection
+  struct Cursor {
+    std::optional<uint32_t> since{}; ///< Revision known by client
+    uint32_t revision{};             ///< Revision of current round
+    std::optional<Address::value_type> addr{}; ///< Last address sent
+    bool full{};   ///< Current round replaces the whole collection
+    bool active{}; ///< Round in progress
+  };
+  std::optional<std::string> locosEvent(Cursor& cursor, size_t max_size);
+  std::optional<std::string> turnoutsEvent(Cursor& cursor, size_t max_size);
+
+  //
+  void persist(bool force = false);
+
 private:
   // This gets called by FreeRTOS
   [[noreturn]] void taskFunction(void*);
@@ -56,6 +82,7 @@ private:
   void operationsLocos();
   void operationsTurnouts();
   void operationsBiDi();
+  void operationsBroadcast(bool force = false);
 
   void serviceLoop();
   std::optional<uint8_t> serviceRead(uint16_t cv_addr);
@@ -106,10 +133,51 @@ private:
   [[nodiscard]] z21::RailComData railComData(uint16_t loco_addr) final;
   void broadcastRailComData(uint16_t loco_addr) final;
 
+  //
+  void publishLocoInfo(uint16_t loco_addr);
+  void publishTurnoutInfo(uint16_t accy_addr);
+  void persistLoco(uint16_t loco_addr, Loco const& loco);
+  void persistTurnout(uint16_t accy_addr, Turnout const& turnout);
+
   //
   void resume();
   void suspend();
 
+  //
+  template<typename T>
+  std::string toJson(Address::value_type addr, T const& t) const;
+  template<typename T>
+  std::optional<std::string> nextJson(T const& map,
+                                      std::optional<Address::value_type>& addr,
+                                      uint32_t since = 0u);
+
+  /// Deleted addresses and the revision they got deleted at
+  struct Tombstones {
+    std::map<Address::value_type, uint32_t> addrs{};
+    uint32_t floor{}; ///< Oldest revision deltas can be computed from
+  };
+  template<typename T>
+  bool serializeDelta(T const& map,
+                      Tombstones const& tombstones,
+                      uint32_t since,
+                      intf::http::Send const& send);
+  template<typename T>
+  std::optional<std::string> event(std::string_view type,
+                                   T const& map,
+                                   Tombstones const& tombstones,
+                                   Cursor& cursor,
+                                   size_t max_size);
+  template<typename Nvs, typename T>
+  intf::http::Response bulkPut(T& map, JsonArrayConst arr);
+  void erased(Tombstones& tombstones, Address::value_type addr);
+  void erasedAll(Tombstones& tombstones);
+
+  /// Mark loco or turnout as changed
+  void changed(auto& entry) {
+    entry.invalidate();
+    entry.revision = _revisions.next();
+  }
+
   //
   Loco& getOrInsertLoco(uint16_t loco_addr);
   Turnout& getOrInsertTurnout(uint16_t accy_addr);
@@ -123,9 +191,30 @@ private:
   Locos _locos;
   Turnouts _turnouts;
 
+  /// Advanced on every change of a loco or turnout
+  Revisions _revisions;
+  struct {
+    Tombstones locos{};
+    Tombstones turnouts{};
+  } _tombstones{};
+
+  /// Addresses whose state changed since the last broadcast or NVS write
+  struct Dirty {
+    std::set<uint16_t> addrs{};
+    TickType_t last_tick{};
+  };
+  struct {
+    Dirty locos{};
+    Dirty turnouts{};
+    Dirty railcom{};
+    Dirty nvs_locos{};
+    Dirty nvs_turnouts{};
+  } _dirty{};
+
   std::mutex _internal_mutex;
   std::shared_ptr<z21::server::intf::System> _z21_system_service;
   std::shared_ptr<z21::server::intf::Dcc> _z21_dcc_service;
+  Z21Post _z21_post;
 
   // NVS cache
   struct {
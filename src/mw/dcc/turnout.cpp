@@ -19,10 +19,10 @@
 namespace mw::dcc {
 
 /// \todo document
-NvTurnoutBase::NvTurnoutBase(JsonDocument const& doc) { fromJsonDocument(doc); }
+NvTurnoutBase::NvTurnoutBase(JsonVariantConst doc) { fromJsonDocument(doc); }
 
 /// \todo document
-void NvTurnoutBase::fromJsonDocument(JsonDocument const& doc) {
+void NvTurnoutBase::fromJsonDocument(JsonVariantConst doc) {
   if (JsonVariantConst v{doc["name"]}; v.is<std::string>())
     name = v.as<std::string>();
 
@@ -78,11 +78,12 @@ JsonDocument NvTurnoutBase::toJsonDocument() const {
 }
 
 /// \todo document
-Turnout::Turnout(JsonDocument const& doc) { fromJsonDocument(doc); }
+Turnout::Turnout(JsonVariantConst doc) { fromJsonDocument(doc); }
 
 /// \todo document
-void Turnout::fromJsonDocument(JsonDocument const& doc) {
+void Turnout::fromJsonDocument(JsonVariantConst doc) {
   NvTurnoutBase::fromJsonDocument(doc);
+  invalidate();
 }
 
 /// \todo document
@@ -90,4 +91,15 @@ JsonDocument Turnout::toJsonDocument() const {
   return NvTurnoutBase::toJsonDocument();
 }
 
+/// Get serialized JSON
+///
+/// The result of toJsonDocument() is serialized once and cached until the
+/// next call to invalidate().
+///
+/// \return Serialized JSON
+std::string const& Turnout::toJson() const {
+  if (empty(json)) serializeJson(toJsonDocument(), json);
+  return json;
+}
+
 } // namespace mw::dcc
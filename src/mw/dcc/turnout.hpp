@@ -31,9 +31,9 @@ namespace z21 = ::z21;
 /// Non-volatile base
 struct NvTurnoutBase : z21::TurnoutInfo {
   constexpr NvTurnoutBase() = default;
-  explicit NvTurnoutBase(JsonDocument const& doc);
+  explicit NvTurnoutBase(JsonVariantConst doc);
 
-  void fromJsonDocument(JsonDocument const& doc);
+  void fromJsonDocument(JsonVariantConst doc);
   JsonDocument toJsonDocument() const;
 
   std::string name{};
@@ -74,12 +74,18 @@ struct NvTurnoutBase : z21::TurnoutInfo {
 /// Actual object with volatile and non-volatile stuff
 struct Turnout : NvTurnoutBase {
   constexpr Turnout() = default;
-  explicit Turnout(JsonDocument const& doc);
+  explicit Turnout(JsonVariantConst doc);
 
-  void fromJsonDocument(JsonDocument const& doc);
+  void fromJsonDocument(JsonVariantConst doc);
   JsonDocument toJsonDocument() const;
+  std::string const& toJson() const;
+  void invalidate() { json.clear(); }
 
   TickType_t timeout_tick{}; ///<
+  uint32_t revision{};       ///< Revision of last change
+
+  /// Serialized toJsonDocument(), empty if invalid
+  mutable std::string json{};
 };
 
 } // namespace mw::dcc
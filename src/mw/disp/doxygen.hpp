@@ -33,9 +33,9 @@ namespace mw::disp {
 /// \copydetails task_function
 ///
 /// <div class="section_buttons">
-/// | Previous         | Next             |
-/// | :--------------- | ---------------: |
-/// | \ref page_mw_dcc | \ref page_mw_ota |
+/// | Previous         | Next                |
+/// | :--------------- | ------------------: |
+/// | \ref page_mw_dcc | \ref page_mw_events |
 /// </div>
 
 } // namespace mw::disp
@@ -24,7 +24,6 @@
 #include <driver/uart.h>
 #include <esp_app_desc.h>
 #include <esp_task.h>
-#include "drv/anlg/convert.hpp"
 #include "mem/nvs/settings.hpp"
 
 namespace mw::disp {
@@ -44,8 +43,6 @@ namespace mw::disp {
 /// - Voltage
 /// - Current
 [[noreturn]] void task_function(void*) {
-  using namespace drv::anlg;
-
   JsonDocument doc;
   auto const app_desc{esp_app_get_description()};
   doc["version"] = app_desc->version;
@@ -56,22 +53,15 @@ namespace mw::disp {
 
   for (;;) {
     if (mem::nvs::Settings nvs; nvs.getExtensionFlags() & 0b1u) {
+      auto const snap{telem::snapshot.load()};
       doc["ip"] = drv::wifi::ip_str;
-      doc["state"] = magic_enum::enum_name(state.load());
+      doc["state"] = magic_enum::enum_name(snap.state);
       doc["ssid"] = nvs.getStationSSID();
       doc["mdns"] = intf::mdns::str;
-      if (wifi_ap_record_t ap_record;
-          esp_wifi_sta_get_ap_info(&ap_record) == ESP_OK)
-        doc["rssi"] = ap_record.rssi;
-      if (VccVoltageMeasurement meas;
-          xQueuePeek(vcc_voltages_queue.handle, &meas, 0u))
-        doc["vcc_voltage"] = measurement2mV(meas).value();
-      if (SupplyVoltageMeasurement meas;
-          xQueuePeek(supply_voltages_queue.handle, &meas, 0u))
-        doc["supply_voltage"] = measurement2mV(meas).value();
-      if (CurrentMeasurement meas;
-          xQueuePeek(filtered_current_queue.handle, &meas, 0u))
-        doc["current"] = measurement2mA(meas).value();
+      if (snap.rssi_valid) doc["rssi"] = snap.rssi;
+      doc["vcc_voltage"] = snap.vcc_voltage;
+      doc["supply_voltage"] = snap.supply_voltage;
+      doc["current"] = snap.filtered_current;
 
       //
       serializeJson(doc, json);
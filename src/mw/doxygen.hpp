@@ -30,13 +30,17 @@ namespace mw {
 // clang-format off
 /// \page page_mw Middleware
 /// \details
-/// | Chapter               | Namespace            | Content                                                                                                     |
-/// | --------------------- | -------------------- | ----------------------------------------------------------------------------------------------------------- |
-/// | \subpage page_mw_dcc  | \ref mw::dcc "dcc"   | [DCC](https://github.com/ZIMO-Elektronik/DCC) operation and service mode, command generation, BiDi decoding |
-/// | \subpage page_mw_disp | \ref mw::disp "disp" | Serial display output                                                                                       |
-/// | \subpage page_mw_ota  | \ref mw::ota "ota"   | OTA firmware update (WebSocket service)                                                                     |
-/// | \subpage page_mw_roco | \ref mw::roco "roco" | ROCO [Z21](https://github.com/ZIMO-Elektronik/Z21) server (UDP and WebSocket services)                      |
-/// | \subpage page_mw_zimo | \ref mw::zimo "zimo" | ZIMO specific (USB and WebSocket services)                                                                  |
+/// | Chapter                   | Namespace                    | Content                                                                                                     |
+/// | ------------------------- | ---------------------------- | ----------------------------------------------------------------------------------------------------------- |
+/// | \subpage page_mw_dcc      | \ref mw::dcc "dcc"           | [DCC](https://github.com/ZIMO-Elektronik/DCC) operation and service mode, command generation, BiDi decoding |
+/// | \subpage page_mw_disp     | \ref mw::disp "disp"         | Serial display output                                                                                       |
+/// | \subpage page_mw_events   | \ref mw::events "events"     | Push of state changes to the web frontend (WebSocket service)                                               |
+/// | \subpage page_mw_frontend | \ref mw::frontend "frontend" | Frontend upload to LittleFS (WebSocket service)                                                             |
+/// | \subpage page_mw_meter    | \ref mw::meter "meter"       | Energy metering per operating mode and loco                                                                 |
+/// | \subpage page_mw_ota      | \ref mw::ota "ota"           | OTA firmware update (WebSocket service)                                                                     |
+/// | \subpage page_mw_roco     | \ref mw::roco "roco"         | ROCO [Z21](https://github.com/ZIMO-Elektronik/Z21) server (UDP and WebSocket services)                      |
+/// | \subpage page_mw_telem    | \ref mw::telem "telem"       | Shared telemetry snapshot                                                                                   |
+/// | \subpage page_mw_zimo     | \ref mw::zimo "zimo"         | ZIMO specific (USB and WebSocket services)                                                                  |
 // clang-format on
 /// \page page_mw Middleware
 /// \details
@@ -0,0 +1,61 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Event push documentation
+///
+/// \file   mw/events/doxygen.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+namespace mw::events {
+
+/// \page page_mw_events Events
+/// \details \tableofcontents
+/// Instead of polling `/sys/`, `/dcc/locos/` and `/dcc/turnouts/`, the web
+/// frontend can subscribe to a WebSocket which pushes changes as they happen.
+/// Every event is a JSON text frame with a `type` member.
+///
+/// \code{.json}
+/// {"type":"sys","state":"DCCOperations","supply_voltage":18000,...}
+/// {"type":"locos","revision":42,"reset":true,"changed":[...],"deleted":[],
+///  "more":false}
+/// {"type":"turnouts","revision":42,"reset":false,"changed":[...],
+///  "deleted":[5],"more":false}
+/// \endcode
+///
+/// Loco and turnout events use the same revisions as the `?since=<revision>`
+/// delta queries. A client which receives `reset` must clear its collection
+/// before applying `changed`.
+///
+/// \section section_mw_events_init Initialization
+/// \copydetails init
+///
+/// \section section_mw_events_service Service
+/// \copydetails Service
+///
+/// \section section_mw_events_http HTTP
+/// | Method    | URI        | Description                                 |
+/// | --------- | ---------- | ------------------------------------------- |
+/// | WebSocket | `/events/` | Any frame subscribes to state change events |
+///
+/// <div class="section_buttons">
+/// | Previous          | Next                  |
+/// | :---------------- | --------------------: |
+/// | \ref page_mw_disp | \ref page_mw_frontend |
+/// </div>
+
+} // namespace mw::events
@@ -0,0 +1,234 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Cover /events/ endpoint
+///
+/// \file   mw/events/service.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "service.hpp"
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <ztl/utility.hpp>
+#include "intf/http/outbox.hpp"
+#include "log.h"
+
+namespace mw::events {
+
+namespace {
+
+/// Coalescing key of system state events
+constexpr uint32_t sys_key{1u};
+
+/// Serialize system state event
+///
+/// \return JSON
+std::string sys_event() {
+  auto const snap{telem::snapshot.load()};
+
+  JsonDocument doc;
+  doc["type"] = "sys";
+  doc["state"] = magic_enum::enum_name(snap.state);
+  doc["supply_voltage"] = snap.supply_voltage;
+  doc["vcc_voltage"] = snap.vcc_voltage;
+  doc["current"] = snap.filtered_current;
+  doc["temperature"] = snap.temperature;
+  if (snap.rssi_valid) doc["rssi"] = snap.rssi;
+
+  std::string json;
+  serializeJson(doc, json);
+  return json;
+}
+
+/// View string as payload
+///
+/// \param  str String
+/// \return Payload
+std::span<uint8_t const> payload(std::string_view str) {
+  return {std::bit_cast<uint8_t const*>(data(str)), size(str)};
+}
+
+} // namespace
+
+/// Ctor
+///
+/// Starts the event task.
+Service::Service() {
+  task.create(ztl::make_trampoline(this, &Service::taskFunction));
+}
+
+/// Handle WebSocket messages
+///
+/// Any text or binary frame subscribes the client, a close frame unsubscribes
+/// it. The content of frames is ignored.
+///
+/// \param  msg     Message
+/// \retval ESP_OK  Message handled
+esp_err_t Service::socket(intf::http::Message& msg) {
+  switch (msg.type) {
+    case HTTPD_WS_TYPE_TEXT: [[fallthrough]];
+    case HTTPD_WS_TYPE_BINARY: subscribe(msg.sock_fd); break;
+    case HTTPD_WS_TYPE_CLOSE: unsubscribe(msg.sock_fd); break;
+    default: break;
+  }
+  return ESP_OK;
+}
+
+/// Event task function
+///
+/// Pushes events every \ref task "timeout" milliseconds or right away after a
+/// new client subscribed.
+[[noreturn]] void Service::taskFunction(void*) {
+  for (;;) {
+    ulTaskNotifyTakeIndexed(
+      default_notify_index, pdTRUE, pdMS_TO_TICKS(task.timeout));
+    push();
+  }
+}
+
+/// Subscribe client
+///
+/// Clients are identified by their socket descriptor and peer address. If the
+/// descriptor got reused by another peer, the stale client gets replaced.
+///
+/// \param  sock_fd Socket descriptor
+void Service::subscribe(int sock_fd) {
+  Client client{.sock_fd = sock_fd, .len = sizeof(sockaddr_storage)};
+  if (getpeername(
+        sock_fd, std::bit_cast<sockaddr*>(&client.addr), &client.len) < 0) {
+    LOGD("getpeername failed %s", strerror(errno));
+    return;
+  }
+
+  //
+  {
+    std::lock_guard lock{_internal_mutex};
+    auto const it{std::ranges::find(_clients, sock_fd, &Client::sock_fd)};
+    if (it == end(_clients)) _clients.push_back(std::move(client));
+    else if (it->len != client.len || memcmp(&it->addr, &client.addr, it->len))
+      *it = std::move(client);
+    else return;
+    clients.store(static_cast<uint32_t>(size(_clients)),
+                  std::memory_order_relaxed);
+  }
+
+  // Send snapshot right away
+  xTaskNotifyGiveIndexed(task.handle, default_notify_index);
+}
+
+/// Unsubscribe client
+///
+/// \param  sock_fd Socket descriptor
+void Service::unsubscribe(int sock_fd) {
+  std::lock_guard lock{_internal_mutex};
+  if (!std::erase_if(_clients, [sock_fd](Client const& c) {
+        return c.sock_fd == sock_fd;
+      }))
+    return;
+  intf::http::outbox.erase(sock_fd);
+  clients.store(static_cast<uint32_t>(size(_clients)),
+                std::memory_order_relaxed);
+}
+
+/// Check whether client is still connected
+///
+/// Clients might disappear without a close frame. Their descriptor then either
+/// isn't a WebSocket anymore or belongs to another peer.
+///
+/// \param  client  Client
+/// \retval true    Client is connected
+/// \retval false   Client is gone
+bool Service::alive(Client const& client) const {
+  if (httpd_ws_get_fd_info(intf::http::handle, client.sock_fd) !=
+      HTTPD_WS_CLIENT_WEBSOCKET)
+    return false;
+  sockaddr_storage addr{};
+  socklen_t len{sizeof(addr)};
+  return !getpeername(client.sock_fd, std::bit_cast<sockaddr*>(&addr), &len) &&
+         len == client.len && !memcmp(&addr, &client.addr, len);
+}
+
+/// Restart synchronization of a client
+///
+/// Drops everything still queued for the client. The next push sends a
+/// snapshot again.
+///
+/// \param  client  Client
+void Service::resync(Client& client) {
+  intf::http::outbox.erase(client.sock_fd);
+  client.locos = client.turnouts = {};
+  client.sys.clear();
+}
+
+/// Push events to all clients
+void Service::push() {
+  std::lock_guard lock{_internal_mutex};
+  if (std::erase_if(_clients, [this](Client const& c) {
+        if (alive(c)) return false;
+        intf::http::outbox.erase(c.sock_fd);
+        return true;
+      }))
+    clients.store(static_cast<uint32_t>(size(_clients)),
+                  std::memory_order_relaxed);
+  if (empty(_clients)) return;
+
+  //
+  auto const sys{sys_event()};
+  auto const now{xTaskGetTickCount()};
+  for (auto& c : _clients) push(c, sys, now);
+}
+
+/// Push events to a single client
+///
+/// \param  client  Client
+/// \param  sys     Current system state event
+/// \param  now     Current tick
+void Service::push(Client& client, std::string const& sys, TickType_t now) {
+  using intf::http::outbox;
+
+  // System state
+  if (sys != client.sys &&
+      (empty(client.sys) ||
+       now - client.sys_tick >= pdMS_TO_TICKS(sys_interval)) &&
+      outbox.state(
+        client.sock_fd, payload(sys), sys_key, HTTPD_WS_TYPE_TEXT) == ESP_OK) {
+    client.sys = sys;
+    client.sys_tick = now;
+  }
+
+  // Backpressure, loco and turnout events can't be dropped
+  if (outbox.depth(client.sock_fd) >= intf::http::outbox_depth) return;
+
+  // Cursors only advance once their event got queued
+  auto const next{[&](dcc::Service::Cursor& cursor, auto event) {
+    auto copy{cursor};
+    auto const json{std::invoke(event, *dcc::service, copy, max_event_size)};
+    if (json && outbox.ack(client.sock_fd, payload(*json), HTTPD_WS_TYPE_TEXT))
+      return false;
+    cursor = copy;
+    return true;
+  }};
+
+  // A failed event might still be queued, start over to avoid duplicates
+  if (!next(client.locos, &dcc::Service::locosEvent) ||
+      !next(client.turnouts, &dcc::Service::turnoutsEvent))
+    resync(client);
+}
+
+} // namespace mw::events
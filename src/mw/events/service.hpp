@@ -0,0 +1,79 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Cover /events/ endpoint
+///
+/// \file   mw/events/service.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <lwip/sockets.h>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "intf/http/message.hpp"
+#include "mw/dcc/service.hpp"
+
+namespace mw::events {
+
+/// Push state changes to WebSocket clients
+///
+/// Clients subscribe by sending any text or binary frame to `/events/` and
+/// unsubscribe by closing the connection. A new subscriber first receives a
+/// snapshot of the system state and of all locos and turnouts, followed by
+/// events whenever something changes. Events are JSON text frames with a
+/// `type` member.
+///
+/// System state events are sent at most every \ref sys_interval and only if
+/// their content changed. Older system state events which are still queued
+/// get replaced, so slow clients only ever see the latest one. Loco and
+/// turnout events are never dropped, since clients apply them as deltas. They
+/// are paged by \ref max_event_size and only produced while the client's queue
+/// is below \ref intf::http::outbox_depth "outbox depth".
+class Service {
+public:
+  Service();
+
+  esp_err_t socket(intf::http::Message& msg);
+
+private:
+  // This gets called by FreeRTOS
+  [[noreturn]] void taskFunction(void*);
+
+  /// Subscribed client
+  struct Client {
+    int sock_fd{};
+    sockaddr_storage addr{};
+    socklen_t len{};
+    dcc::Service::Cursor locos{};
+    dcc::Service::Cursor turnouts{};
+    std::string sys{};     ///< Last system state event
+    TickType_t sys_tick{}; ///< Time last system state event got sent
+  };
+
+  void subscribe(int sock_fd);
+  void unsubscribe(int sock_fd);
+  bool alive(Client const& client) const;
+  void resync(Client& client);
+  void push();
+  void push(Client& client, std::string const& sys, TickType_t now);
+
+  std::vector<Client> _clients;
+  std::mutex _internal_mutex;
+};
+
+} // namespace mw::events
@@ -0,0 +1,54 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Frontend upload documentation
+///
+/// \file   mw/frontend/doxygen.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+namespace mw::frontend {
+
+/// \page page_mw_frontend Frontend
+/// \details \tableofcontents
+/// The web frontend can be stored on the LittleFS `data` partition instead of
+/// (or in addition to) being embedded into the firmware. This keeps firmware
+/// images small and allows frontend updates without reflashing. Files on
+/// LittleFS take precedence, the embedded copy serves as fallback.
+///
+/// Every build creates a `frontend.tar` archive of gzip compressed files next
+/// to the firmware image. Uploading it replaces the frontend as a whole. An
+/// interrupted upload never leaves a half written frontend behind.
+///
+/// \section section_mw_frontend_init Initialization
+/// \copydetails init
+///
+/// \section section_mw_frontend_service Service
+/// \copydetails Service
+///
+/// \section section_mw_frontend_http HTTP
+/// | Method    | URI          | Description                          |
+/// | --------- | ------------ | ------------------------------------ |
+/// | WebSocket | `/frontend/` | Binary frames containing tar archive |
+///
+/// <div class="section_buttons">
+/// | Previous            | Next               |
+/// | :------------------ | -----------------: |
+/// | \ref page_mw_events | \ref page_mw_meter |
+/// </div>
+
+} // namespace mw::frontend
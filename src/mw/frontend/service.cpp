@@ -0,0 +1,211 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Cover /frontend/ endpoint
+///
+/// \file   mw/frontend/service.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "service.hpp"
+#include <array>
+#include <utility>
+#include <ztl/utility.hpp>
+#include "intf/http/outbox.hpp"
+#include "log.h"
+#include "utility.hpp"
+
+namespace mw::frontend {
+
+using namespace mem::littlefs;
+
+/// Ctor
+Service::Service() {
+  task.function = ztl::make_trampoline(this, &Service::taskFunction);
+}
+
+/// Queue WebSocket message
+///
+/// The first message of an upload switches to \ref State::Frontend and
+/// creates the task. Only one upload is accepted at a time and only while no
+/// other operating mode is active, messages of other sockets get rejected.
+///
+/// \param  msg       Message
+/// \retval ESP_OK    Message queued
+/// \retval ESP_FAIL  Another upload or operating mode is active
+esp_err_t Service::socket(intf::http::Message& msg) {
+  std::scoped_lock lock{_mutex};
+  if (auto expected{State::Suspended};
+      _sock_fd < 0 && msg.type != HTTPD_WS_TYPE_CLOSE &&
+      state.compare_exchange_strong(expected, State::Frontend)) {
+    _sock_fd = msg.sock_fd;
+    _queue.push(std::move(msg));
+    LOGI_TASK_CREATE(task);
+    return ESP_OK;
+  } else if (_sock_fd != msg.sock_fd) return ESP_FAIL;
+  _queue.push(std::move(msg));
+  return ESP_OK;
+}
+
+/// Frontend task function
+[[noreturn]] void Service::taskFunction(void*) {
+  loop();
+  LOGI_TASK_DESTROY();
+}
+
+/// Extract received frames until the socket closes or times out
+void Service::loop() {
+  auto const timeout{http_receive_timeout2ms()};
+
+  for (;;) {
+    auto const msg{_queue.pop(std::chrono::milliseconds{timeout})};
+    if (!msg) {
+      LOGI("WebSocket timeout");
+      if (auto const err{httpd_sess_trigger_close(_sock_fd)})
+        LOGE("httpd_sess_trigger_close failed %s", esp_err_to_name(err));
+      return close();
+    }
+
+    switch (msg->type) {
+      case HTTPD_WS_TYPE_BINARY: _ack = write(msg->payload); break;
+      case HTTPD_WS_TYPE_CLOSE: LOGI("WebSocket closed"); return close();
+      default:
+        LOGE("WebSocket packet type neither binary nor close");
+        _ack = nak;
+        break;
+    }
+
+    if (auto const err{
+          intf::http::outbox.ack(msg->sock_fd, {&_ack, sizeof(_ack)})}) {
+      LOGE("outbox ack failed %s", esp_err_to_name(err));
+      return close();
+    }
+
+    // We can't continue in case of error... so abort
+    if (_ack == nak) return close();
+  }
+}
+
+/// Extract part of archive
+///
+/// The staging directory gets cleared before the first part. Once the archive
+/// is complete, the staging directory replaces the current frontend.
+///
+/// \param  payload Part of archive
+/// \retval ack     Success
+/// \retval nak     Extracting or replacing frontend failed
+uint8_t Service::write(std::vector<uint8_t> const& payload) {
+  //
+  if (!_extractor) {
+    if (remove_all(frontend_staging_path) ||
+        create_directories(frontend_staging_path)) {
+      LOGE("Can't create %s", frontend_staging_path);
+      return nak;
+    }
+    _extractor.emplace();
+  }
+
+  //
+  if (_reader.done()) return ack;
+  else if (!_reader.feed(payload, *_extractor)) {
+    LOGE("Frontend upload failed");
+    return nak;
+  } else if (!_reader.done()) return ack;
+
+  //
+  if (auto const err{commit_frontend(std::move(_extractor->files))}) {
+    LOGE("Frontend update failed %s", esp_err_to_name(err));
+    return nak;
+  }
+  LOGI("Frontend update successful");
+  return ack;
+}
+
+/// Reset upload, remove leftover staging directory and suspend
+void Service::close() {
+  _extractor.reset();
+  remove_all(frontend_staging_path);
+  _reader = {};
+  _ack = {};
+  std::scoped_lock lock{_mutex};
+  _queue.clear();
+  _sock_fd = -1;
+  if (auto expected{State::Frontend};
+      !state.compare_exchange_strong(expected, State::Suspended))
+    assert(false);
+}
+
+/// Dtor
+///
+/// Closes file which might still be open if the upload got aborted.
+Service::Extractor::~Extractor() {
+  if (fp) fclose(fp);
+  mbedtls_sha256_free(&sha256);
+}
+
+/// Start file
+///
+/// \param  path  Path relative to staging directory
+/// \retval true  Success
+/// \retval false File could not be created
+bool Service::Extractor::begin(std::string_view path) {
+  std::string const file_path{std::string{frontend_staging_path} + '/' +
+                              std::string{path}};
+  if (create_directories(
+        std::string_view{file_path}.substr(0uz, file_path.rfind('/'))))
+    return false;
+  if (!(fp = fopen(data(file_path), "wb"))) {
+    LOGE("Can't create %s", data(file_path));
+    return false;
+  }
+  uri = path;
+  mbedtls_sha256_init(&sha256);
+  return !mbedtls_sha256_starts(&sha256, 0);
+}
+
+/// Append to file
+///
+/// \param  bytes Bytes
+/// \retval true  Success
+/// \retval false Bytes could not be written
+bool Service::Extractor::write(std::span<uint8_t const> bytes) {
+  return fwrite(data(bytes), 1uz, size(bytes), fp) == size(bytes) &&
+         !mbedtls_sha256_update(&sha256, data(bytes), size(bytes));
+}
+
+/// Finish file
+///
+/// ETags get calculated the same way as the ones of the embedded frontend, so
+/// identical files share the same ETag.
+///
+/// \retval true  Success
+/// \retval false File could not be written
+bool Service::Extractor::end() {
+  auto const err{fclose(std::exchange(fp, nullptr))};
+  std::array<uint8_t, 32uz> hash;
+  if (err || mbedtls_sha256_finish(&sha256, data(hash))) return false;
+  mbedtls_sha256_free(&sha256);
+  constexpr std::string_view hex{"0123456789abcdef"};
+  std::string etag{'"'};
+  for (auto const b : std::span{hash}.first(8uz)) {
+    etag += hex[b >> 4u];
+    etag += hex[b & 0x0Fu];
+  }
+  etag += '"';
+  files.push_back({.uri = std::move(uri), .etag = std::move(etag)});
+  return true;
+}
+
+} // namespace mw::frontend
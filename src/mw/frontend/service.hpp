@@ -0,0 +1,83 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Cover /frontend/ endpoint
+///
+/// \file   mw/frontend/service.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <esp_err.h>
+#include <mbedtls/sha256.h>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include "channel.hpp"
+#include "intf/http/message.hpp"
+#include "mem/littlefs/frontend.hpp"
+#include "tar.hpp"
+
+namespace mw::frontend {
+
+/// Frontend upload
+///
+/// The frontend gets uploaded as tar archive of gzip compressed files. The
+/// archive is sent in binary WebSocket frames, each of which gets answered with
+/// either \ref ack or \ref nak. Files are extracted to
+/// \ref mem::littlefs::frontend_staging_path while receiving. Once the
+/// end-of-archive marker arrives, the staging directory replaces the current
+/// frontend and the last frame gets acknowledged.
+class Service {
+public:
+  Service();
+
+  esp_err_t socket(intf::http::Message& msg);
+
+private:
+  // This gets called by FreeRTOS
+  [[noreturn]] void taskFunction(void*);
+
+  void loop();
+  uint8_t write(std::vector<uint8_t> const& payload);
+  void close();
+
+  /// Writes files handed out by \ref TarReader and computes their ETags
+  struct Extractor {
+    ~Extractor();
+
+    bool begin(std::string_view path);
+    bool write(std::span<uint8_t const> bytes);
+    bool end();
+
+    FILE* fp{};
+    std::string uri{};
+    mbedtls_sha256_context sha256{};
+    std::vector<mem::littlefs::FrontendFile> files{};
+  };
+
+  std::mutex _mutex;
+  Channel<intf::http::Message> _queue{};
+  int _sock_fd{-1};
+  TarReader _reader{};
+  std::optional<Extractor> _extractor{};
+  uint8_t _ack{};
+};
+
+} // namespace mw::frontend
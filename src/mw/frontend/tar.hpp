@@ -0,0 +1,243 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Streaming tar reader
+///
+/// \file   mw/frontend/tar.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace mw::frontend {
+
+/// Check whether archive path is safe to extract
+///
+/// Absolute paths and paths containing `..` components are rejected, so that
+/// nothing can get written outside of the target directory.
+///
+/// \param  path  Archive path
+/// \retval true  Path is safe
+/// \retval false Path is unsafe
+constexpr bool safe_path(std::string_view path) {
+  if (empty(path) || path.starts_with('/')) return false;
+  while (!empty(path)) {
+    auto const n{std::min(path.find('/'), size(path))};
+    if (path.substr(0uz, n) == "..") return false;
+    path.remove_prefix(std::min(n + 1uz, size(path)));
+  }
+  return true;
+}
+
+/// Streaming reader for ustar archives
+///
+/// The reader gets fed with arbitrarily sized pieces of an archive and hands
+/// regular files to a handler, which needs to provide the following members.
+/// - `bool begin(std::string_view path)` starts a file
+/// - `bool write(std::span<uint8_t const> bytes)` appends to the file
+/// - `bool end()` finishes the file
+///
+/// Directories and pax global headers are skipped. The `path` record of a pax
+/// extended header replaces the name of the following entry, so paths aren't
+/// limited to the 255 characters of ustar. Reading stops once the
+/// end-of-archive marker (a zero block) is reached.
+class TarReader {
+public:
+  /// Feed archive bytes
+  ///
+  /// \tparam H       Handler type
+  /// \param  bytes   Archive bytes
+  /// \param  handler Handler
+  /// \retval true    Success
+  /// \retval false   Malformed archive or handler failed
+  template<typename H>
+  bool feed(std::span<uint8_t const> bytes, H& handler) {
+    while (!empty(bytes) && !_done && !_error) {
+      // File data
+      if (_remaining) {
+        auto const n{std::min(_remaining, size(bytes))};
+        if (_file && !handler.write(bytes.first(n))) return fail();
+        if (_extended)
+          _pax.append(std::bit_cast<char const*>(data(bytes)), n);
+        bytes = bytes.subspan(n);
+        _remaining -= n;
+        if (!_remaining && _file && !handler.end()) return fail();
+        if (!_remaining && _extended && !pax()) return fail();
+      }
+      // Padding to next block
+      else if (_padding) {
+        auto const n{std::min(_padding, size(bytes))};
+        bytes = bytes.subspan(n);
+        _padding -= n;
+      }
+      // Header
+      else {
+        auto const n{std::min(block_size - _header_size, size(bytes))};
+        std::ranges::copy(bytes.first(n), begin(_header) + _header_size);
+        bytes = bytes.subspan(n);
+        if ((_header_size += n) < block_size) break;
+        _header_size = 0uz;
+        if (!header(handler)) return fail();
+      }
+    }
+    return !_error;
+  }
+
+  /// End-of-archive marker reached
+  ///
+  /// \retval true  Archive complete
+  /// \retval false Archive incomplete
+  bool done() const { return _done; }
+
+private:
+  static constexpr auto block_size{512uz};
+
+  /// Maximum size of pax extended header records
+  static constexpr auto max_pax_size{2uz * block_size};
+
+  /// Parse header block
+  ///
+  /// \tparam H       Handler type
+  /// \param  handler Handler
+  /// \retval true    Success
+  /// \retval false   Malformed header or handler failed
+  template<typename H>
+  bool header(H& handler) {
+    // End-of-archive
+    if (std::ranges::all_of(_header, [](uint8_t b) { return !b; }))
+      return _done = true;
+
+    // Checksum is calculated with checksum field itself filled with spaces
+    uint32_t sum{};
+    for (auto i{0uz}; i < block_size; ++i)
+      sum += i >= 148uz && i < 156uz ? ' ' : _header[i];
+    if (auto const chksum{octal(148uz, 8uz)}; !chksum || *chksum != sum)
+      return false;
+
+    auto const file_size{octal(124uz, 12uz)};
+    if (!file_size) return false;
+    _remaining = *file_size;
+    _padding = (block_size - _remaining % block_size) % block_size;
+
+    // pax extended header records get collected for the following entry
+    auto const type{_header[156uz]};
+    _extended = type == 'x';
+    _file = type == '0' || type == '\0';
+    if (_extended) {
+      _pax.clear();
+      return _remaining <= max_pax_size && (_remaining || pax());
+    }
+    auto const pax_path{std::exchange(_path, std::nullopt)};
+
+    // Only regular files get extracted
+    if (!_file) return true;
+
+    // ustar splits long paths into prefix and name
+    std::string path;
+    if (pax_path) path = *pax_path;
+    else {
+      if (auto const prefix{field(345uz, 155uz)};
+          field(257uz, 5uz) == "ustar" && !empty(prefix))
+        (path = prefix) += '/';
+      path += field(0uz, 100uz);
+    }
+    std::string_view p{path};
+    while (p.starts_with("./")) p.remove_prefix(2uz);
+    if (!safe_path(p) || !handler.begin(p)) return false;
+    return _remaining || handler.end();
+  }
+
+  /// Parse pax extended header records
+  ///
+  /// Records have the form `<length> <key>=<value>\n`, where length includes
+  /// the whole record. Only `path` is of interest, all other keys are ignored.
+  ///
+  /// \retval true  Success
+  /// \retval false Malformed records
+  bool pax() {
+    std::string_view records{_pax};
+    while (!empty(records)) {
+      size_t len{};
+      auto const last{data(records) + size(records)};
+      auto const [ptr, ec]{std::from_chars(data(records), last, len)};
+      if (ec != std::errc{} || ptr == last || *ptr != ' ' ||
+          len <= static_cast<size_t>(ptr - data(records)) + 1uz ||
+          len > size(records) || records[len - 1uz] != '\n')
+        return false;
+      std::string_view const record{ptr + 1, data(records) + len - 1uz};
+      auto const eq{record.find('=')};
+      if (eq == std::string_view::npos) return false;
+      if (record.substr(0uz, eq) == "path")
+        _path.emplace(record.substr(eq + 1uz));
+      records.remove_prefix(len);
+    }
+    return true;
+  }
+
+  /// Get NUL terminated string field
+  ///
+  /// \param  pos   Position
+  /// \param  count Length
+  /// \return String
+  std::string_view field(size_t pos, size_t count) const {
+    std::string_view const str{
+      std::bit_cast<char const*>(data(_header) + pos), count};
+    return str.substr(0uz, str.find('\0'));
+  }
+
+  /// Get octal number field
+  ///
+  /// \param  pos   Position
+  /// \param  count Length
+  /// \return Number or std::nullopt if field contains invalid characters
+  std::optional<size_t> octal(size_t pos, size_t count) const {
+    size_t value{};
+    auto any{false};
+    for (auto const c : field(pos, count)) {
+      if (c == ' ' && !any) continue;
+      else if (c == ' ') break;
+      else if (c < '0' || c > '7') return std::nullopt;
+      value = value * 8uz + static_cast<size_t>(c - '0');
+      any = true;
+    }
+    return any ? std::optional{value} : std::nullopt;
+  }
+
+  bool fail() { return !(_error = true); }
+
+  std::array<uint8_t, block_size> _header{};
+  size_t _header_size{};
+  size_t _remaining{};
+  size_t _padding{};
+  std::string _pax{};
+  std::optional<std::string> _path{};
+  bool _file{};
+  bool _extended{};
+  bool _done{};
+  bool _error{};
+};
+
+} // namespace mw::frontend
@@ -0,0 +1,63 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Attribute energy to moving locos
+///
+/// \file   mw/meter/attribute.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include "mw/dcc/bidi_speed.hpp"
+
+namespace mw::meter {
+
+/// Attribute energy to moving locos proportionally to their speed
+///
+/// RailCom only reports the speed of locos which still get addressed, so the
+/// last report of a loco that left the track or got dropped from the refresh
+/// cycle would otherwise be used forever. Speeds older than
+/// \ref bidi_speed_max_age are therefore ignored.
+///
+/// \param  energy  Energy [nJ]
+/// \param  speeds  RailCom speeds
+/// \param  tick    Current tick
+/// \return Pairs of loco address and attributed energy [nJ]
+inline std::vector<std::pair<::dcc::Address::value_type, uint64_t>>
+attribute(uint64_t energy,
+          std::span<dcc::BidiSpeed const> speeds,
+          TickType_t tick) {
+  auto const moving{std::views::filter([tick](dcc::BidiSpeed const& s) {
+    return s.speed &&
+           static_cast<TickType_t>(tick - s.tick) <=
+             pdMS_TO_TICKS(bidi_speed_max_age);
+  })};
+
+  uint64_t sum{};
+  for (auto const& s : speeds | moving) sum += s.speed;
+
+  std::vector<std::pair<::dcc::Address::value_type, uint64_t>> energies;
+  if (!sum) return energies;
+  for (auto const& s : speeds | moving)
+    energies.push_back({s.addr, energy * s.speed / sum});
+  return energies;
+}
+
+} // namespace mw::meter
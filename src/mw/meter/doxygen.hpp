@@ -0,0 +1,58 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Energy meter documentation
+///
+/// \file   mw/meter/doxygen.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+namespace mw::meter {
+
+/// \page page_mw_meter Meter
+/// \details \tableofcontents
+/// The meter integrates track power over time. The \ref page_drv_anlg "ADC
+/// task" multiplies the mean supply voltage and current of every conversion
+/// frame and adds the result to the counter of the active operating mode. The
+/// meter service collects those counters once per second, attributes energy
+/// consumed in DCC operations mode to the locos currently reporting a RailCom
+/// speed and persists the totals in NVS. Locos which draw a lot more power
+/// than others of the same kind at similar speeds are easy to spot this way.
+///
+/// \note
+/// Per loco values are estimates. Energy is split proportionally to the
+/// reported speeds, decoder and lighting consumption is not modeled.
+///
+/// \section section_mw_meter_init Initialization
+/// \copydetails init
+///
+/// \section section_mw_meter_service Service
+/// \copydetails Service
+///
+/// \section section_mw_meter_http HTTP
+/// | Method | URI       | Description                             |
+/// | ------ | --------- | --------------------------------------- |
+/// | GET    | `/meter/` | Energy per operating mode and loco [mJ] |
+/// | DELETE | `/meter/` | Reset all counters                      |
+///
+/// <div class="section_buttons">
+/// | Previous              | Next             |
+/// | :-------------------- | ---------------: |
+/// | \ref page_mw_frontend | \ref page_mw_ota |
+/// </div>
+
+} // namespace mw::meter
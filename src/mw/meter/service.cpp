@@ -0,0 +1,165 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Cover /meter/ endpoint
+///
+/// \file   mw/meter/service.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "service.hpp"
+#include <ArduinoJson.h>
+#include <ztl/utility.hpp>
+#include "attribute.hpp"
+#include "log.h"
+#include "mem/nvs/meter.hpp"
+#include "mw/dcc/service.hpp"
+
+namespace mw::meter {
+
+/// Ctor
+///
+/// Restores total counters from NVS and starts the meter task.
+Service::Service() {
+  _last = drv::anlg::energies.load();
+
+  mem::nvs::Meter nvs;
+  for (auto const& entry : nvs) {
+    if (auto const mode{magic_enum::enum_cast<State>(entry.key)})
+      _modes[drv::anlg::state2energies_index(*mode)].total =
+        nvs.getModeEnergy(*mode);
+    else if (auto const addr{mem::nvs::key2address(entry.key)})
+      _locos[addr].total = nvs.getLocoEnergy(addr);
+  }
+
+  task.create(ztl::make_trampoline(this, &Service::taskFunction));
+}
+
+/// GET request
+///
+/// Returns session and total energy of all operating modes and locos in [mJ].
+/// Locos additionally contain the average power [mW] while moving.
+///
+/// \param  req Request
+/// \return JSON
+intf::http::Response Service::getRequest(intf::http::Request const& req) {
+  JsonDocument doc;
+
+  std::lock_guard lock{_internal_mutex};
+
+  auto modes{doc["modes"].to<JsonObject>()};
+  for (auto i{0uz}; i < size(_modes); ++i) {
+    auto mode{modes[magic_enum::enum_name(static_cast<State>(i << CHAR_BIT))]
+                .to<JsonObject>()};
+    mode["session"] = _modes[i].session / 1'000'000u;
+    mode["total"] = _modes[i].total / 1'000'000u;
+  }
+
+  auto locos{doc["locos"].to<JsonArray>()};
+  for (auto const& [addr, counter] : _locos) {
+    auto loco{locos.add<JsonObject>()};
+    loco["address"] = addr;
+    loco["session"] = counter.session / 1'000'000u;
+    loco["total"] = counter.total / 1'000'000u;
+    // [nJ] / [ms] = [uW]
+    loco["power"] =
+      counter.moving_time ? counter.session / counter.moving_time / 1000u : 0u;
+  }
+
+  std::string json;
+  json.reserve((size(_modes) + size(_locos) + 1uz) * 64uz);
+  serializeJson(doc, json);
+  return json;
+}
+
+/// DELETE request
+///
+/// Resets all counters and erases them from NVS.
+///
+/// \param  req Request
+/// \return Empty response
+intf::http::Response Service::deleteRequest(intf::http::Request const& req) {
+  std::lock_guard lock{_internal_mutex};
+  _modes = {};
+  _locos.clear();
+  _persist_pending = false;
+  if (mem::nvs::Meter nvs; nvs.eraseAll() != ESP_OK)
+    return std::unexpected<std::string>{"500 Internal Server Error"};
+  return {};
+}
+
+/// Meter task function
+///
+/// Every \ref task "timeout" milliseconds the latest energy counters get
+/// accumulated. Every \ref persist_interval seconds the totals get persisted if
+/// they have changed.
+[[noreturn]] void Service::taskFunction(void*) {
+  for (;;) {
+    update();
+    if (!--_persist_countdown) {
+      _persist_countdown = persist_interval;
+      persist();
+    }
+    vTaskDelay(pdMS_TO_TICKS(task.timeout));
+  }
+}
+
+/// Accumulate difference between latest and last energy counters
+void Service::update() {
+  auto const energies{drv::anlg::energies.load()};
+  auto const ops{drv::anlg::state2energies_index(State::DCCOperations)};
+  auto const ops_energy{energies[ops] - _last[ops]};
+
+  // Ask DCC service before taking the lock
+  std::vector<dcc::BidiSpeed> speeds;
+  if (ops_energy && dcc::service) speeds = dcc::service->bidiSpeeds();
+
+  std::lock_guard lock{_internal_mutex};
+
+  for (auto i{0uz}; i < size(energies); ++i)
+    if (auto const energy{energies[i] - _last[i]}) {
+      _modes[i].session += energy;
+      _modes[i].total += energy;
+      _persist_pending = true;
+    }
+  _last = energies;
+
+  // Attribute energy to moving locos proportionally to their speed
+  for (auto const& [addr, energy] :
+       attribute(ops_energy, speeds, xTaskGetTickCount())) {
+    auto& loco{_locos[addr]};
+    loco.session += energy;
+    loco.total += energy;
+    loco.moving_time += task.timeout;
+  }
+}
+
+/// Persist total counters to NVS
+void Service::persist() {
+  std::lock_guard lock{_internal_mutex};
+  if (!_persist_pending) return;
+  _persist_pending = false;
+
+  mem::nvs::Meter nvs;
+  for (auto i{0uz}; i < size(_modes); ++i)
+    if (_modes[i].total &&
+        nvs.setModeEnergy(static_cast<State>(i << CHAR_BIT), _modes[i].total))
+      LOGW("Can't persist energy counter");
+  for (auto const& [addr, counter] : _locos)
+    if (nvs.setLocoEnergy(addr, counter.total))
+      LOGW("Can't persist energy counter");
+}
+
+} // namespace mw::meter
@@ -0,0 +1,72 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Cover /meter/ endpoint
+///
+/// \file   mw/meter/service.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <dcc/dcc.hpp>
+#include <map>
+#include <mutex>
+#include "intf/http/endpoints.hpp"
+
+namespace mw::meter {
+
+/// Energy meter
+///
+/// The meter accumulates the \ref drv::anlg::energies "energy counters"
+/// published by the ADC task into per session and total counters for each
+/// operating mode. Energy consumed in \ref State::DCCOperations gets further
+/// attributed to individual locos proportionally to their RailCom speed,
+/// ignoring speeds older than \ref bidi_speed_max_age. Total counters are
+/// restored from and periodically persisted to NVS.
+class Service {
+public:
+  Service();
+
+  intf::http::Response getRequest(intf::http::Request const& req);
+  intf::http::Response deleteRequest(intf::http::Request const& req);
+
+private:
+  // This gets called by FreeRTOS
+  [[noreturn]] void taskFunction(void*);
+
+  void update();
+  void persist();
+
+  /// Energy counter [nJ]
+  struct Counter {
+    uint64_t session{}; ///< Since boot
+    uint64_t total{};   ///< Since last reset
+  };
+
+  /// Energy counter of loco
+  struct LocoCounter : Counter {
+    uint32_t moving_time{}; ///< Time spent moving this session [ms]
+  };
+
+  drv::anlg::Energies _last{};
+  std::array<Counter, std::tuple_size_v<drv::anlg::Energies>> _modes{};
+  std::map<::dcc::Address::value_type, LocoCounter> _locos;
+  std::mutex _internal_mutex;
+  uint32_t _persist_countdown{persist_interval};
+  bool _persist_pending{};
+};
+
+} // namespace mw::meter
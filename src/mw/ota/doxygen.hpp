@@ -25,12 +25,57 @@ namespace mw::ota {
 
 /// \page page_mw_ota OTA
 /// \details \tableofcontents
-/// \todo document OTA page
+/// Firmware images get uploaded over the `/ota/` WebSocket and written to the
+/// next OTA partition. Once the client closes the WebSocket, the image is
+/// verified and the device restarts into it.
+///
+/// \section section_mw_ota_stop_and_wait Stop-and-wait
+/// Each binary frame contains a part of the image and is answered with a
+/// single \ref ack or \ref nak byte once it has been written. The client sends
+/// the next frame only after receiving the previous answer.
+///
+/// \section section_mw_ota_windowed Windowed
+/// If the first frame is a chunk, the upload is windowed. The client may keep
+/// up to \ref window_size chunks in flight. Each chunk carries a sequence
+/// number and a CRC-32 of its payload.
+/// \copydetails parse_chunk
+///
+/// A separate \ref writer_task "writer task" flashes one chunk while the next
+/// one is received (\ref FlashWriter). Chunks get acknowledged once they are
+/// in flash.
+/// \copydetails chunk_ack
+///
+/// A missing or corrupt chunk is answered with a single nak carrying the next
+/// expected sequence number, and the client continues from there (go-back-N).
+/// Throughput statistics get logged when the upload ends.
+///
+/// \section section_mw_ota_resume Resume
+/// A windowed upload may start with a begin frame which identifies the image.
+/// \copydetails parse_begin
+///
+/// The device answers with the offset the client has to continue from. Chunk
+/// sequence numbers start at 0 again.
+/// \copydetails begin_ack
+///
+/// \copydetails Resumable
+///
+/// \section section_mw_ota_delta Delta
+/// Instead of an image an upload may contain a delta patch against the running
+/// image, which `/sys/` reports as `elf_sha256`. Either upload mode works. The
+/// new image gets reconstructed into the next OTA partition and verified like
+/// any other image. Patches can't be resumed. `tools/scripts/ota_patch.py`
+/// creates patches.
+/// \copydetails Patcher
+///
+/// \section section_mw_ota_http HTTP
+/// | Method    | URI     | Description                        |
+/// | --------- | ------- | ---------------------------------- |
+/// | WebSocket | `/ota/` | Binary frames containing the image |
 ///
 /// <div class="section_buttons">
-/// | Previous          | Next              |
-/// | :---------------- | ----------------: |
-/// | \ref page_mw_disp | \ref page_mw_roco |
+/// | Previous           | Next              |
+/// | :----------------- | ----------------: |
+/// | \ref page_mw_meter | \ref page_mw_roco |
 /// </div>
 
 } // namespace mw::ota
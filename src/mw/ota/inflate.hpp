@@ -0,0 +1,394 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Streaming raw deflate decompression
+///
+/// \file   mw/ota/inflate.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+
+namespace mw::ota {
+
+/// Streaming raw deflate (RFC 1951) decompressor
+///
+/// Compressed bytes get fed in arbitrarily sized pieces. They are collected in
+/// a 64 bit buffer and each step (block header, code length, literal or
+/// length/distance pair) only consumes bits once all of them are available.
+/// Otherwise the step is repeated with the next piece. Decompressed bytes are
+/// kept in a window of WindowSize bytes, which doubles as dictionary for back
+/// references. Streams must therefore not refer further back than WindowSize
+/// bytes (e.g. zlib with wbits = -log2(WindowSize)).
+///
+/// Decoding is done bit by bit with canonical Huffman codes, which needs no
+/// lookup tables besides the symbols sorted by code length.
+///
+/// \tparam WindowSize  Window size (power of 2, 256 to 32768)
+template<size_t WindowSize>
+class Inflater {
+  static_assert(std::has_single_bit(WindowSize) && WindowSize >= 256uz &&
+                WindowSize <= 32768uz);
+
+  static constexpr auto max_bits{15uz};
+  static constexpr auto max_litlen_codes{286uz};
+  static constexpr auto max_distance_codes{30uz};
+
+  static constexpr std::array<uint16_t, 29uz> length_bases{
+    3u,  4u,  5u,  6u,  7u,   8u,   9u,   10u,  11u,  13u,
+    15u, 17u, 19u, 23u, 27u,  31u,  35u,  43u,  51u,  59u,
+    67u, 83u, 99u, 115u, 131u, 163u, 195u, 227u, 258u};
+  static constexpr std::array<uint8_t, 29uz> length_extra{
+    0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 1u, 1u, 1u, 1u, 2u, 2u, 2u,
+    2u, 3u, 3u, 3u, 3u, 4u, 4u, 4u, 4u, 5u, 5u, 5u, 5u, 0u};
+  static constexpr std::array<uint16_t, 30uz> distance_bases{
+    1u,    2u,    3u,    4u,    5u,    7u,     9u,     13u,    17u,    25u,
+    33u,   49u,   65u,   97u,   129u,  193u,   257u,   385u,   513u,   769u,
+    1025u, 1537u, 2049u, 3073u, 4097u, 6145u,  8193u,  12289u, 16385u, 24577u};
+  static constexpr std::array<uint8_t, 30uz> distance_extra{
+    0u, 0u, 0u, 0u, 1u, 1u, 2u,  2u,  3u,  3u,  4u,  4u,  5u,  5u,  6u,
+    6u, 7u, 7u, 8u, 8u, 9u, 9u, 10u, 10u, 11u, 11u, 12u, 12u, 13u, 13u};
+
+  /// Order of code length code lengths (RFC 1951 3.2.7)
+  static constexpr std::array<uint8_t, 19uz> code_length_order{
+    16u, 17u, 18u, 0u, 8u, 7u, 9u, 6u, 10u, 5u,
+    11u, 4u,  12u, 3u, 13u, 2u, 14u, 1u, 15u};
+
+public:
+  /// Feed compressed bytes
+  ///
+  /// \tparam F     Callable taking decompressed bytes, returns false on error
+  /// \param  bytes Compressed bytes
+  /// \param  f     Consume decompressed bytes
+  /// \retval true  Success
+  /// \retval false Malformed stream or consuming failed
+  template<typename F>
+  bool feed(std::span<uint8_t const> bytes, F&& f) {
+    while (!_error) {
+      for (; _bit_count <= 56u && !empty(bytes); bytes = bytes.subspan(1uz)) {
+        _bits |= static_cast<uint64_t>(bytes.front()) << _bit_count;
+        _bit_count += 8u;
+      }
+
+      // Only padding may follow the final block
+      if (_state == State::Done) {
+        if (!empty(bytes) || _bit_count >= 8u) fail();
+        break;
+      }
+
+      Reader reader{_bits, _bit_count};
+      if (auto const result{step(reader, f)}; result == Result::Error) fail();
+      // No step needs more bits than the buffer holds
+      else if (result == Result::More) {
+        if (!empty(bytes)) fail();
+        break;
+      } else {
+        _bits = reader.bits;
+        _bit_count = reader.count;
+      }
+    }
+    return flush(f);
+  }
+
+  /// Check whether the final block has been decompressed
+  ///
+  /// \retval true  Stream complete
+  /// \retval false Stream incomplete
+  constexpr bool done() const { return !_error && _state == State::Done; }
+
+private:
+  enum class State {
+    BlockHeader,
+    StoredHeader,
+    Stored,
+    TableHeader,
+    CodeLengthCodes,
+    CodeLengths,
+    Codes,
+    Done
+  };
+  enum class Result { Ok, More, Error };
+
+  /// Canonical Huffman code (RFC 1951 3.2.2)
+  ///
+  /// \tparam Symbols Maximum number of symbols
+  template<size_t Symbols>
+  struct Huffman {
+    /// Build code from code lengths
+    ///
+    /// \param  lengths Code length of each symbol
+    /// \retval true    Success
+    /// \retval false   Code is oversubscribed
+    constexpr bool build(std::span<uint8_t const> lengths) {
+      counts = {};
+      for (auto const len : lengths) ++counts[len];
+      int left{1};
+      for (auto len{1uz}; len <= max_bits; ++len)
+        if ((left = (left << 1) - counts[len]) < 0) return false;
+      std::array<uint16_t, max_bits + 1uz> offsets{};
+      for (auto len{1uz}; len < max_bits; ++len)
+        offsets[len + 1uz] = static_cast<uint16_t>(offsets[len] + counts[len]);
+      for (auto sym{0uz}; sym < size(lengths); ++sym)
+        if (lengths[sym])
+          symbols[offsets[lengths[sym]]++] = static_cast<uint16_t>(sym);
+      return true;
+    }
+
+    std::array<uint16_t, max_bits + 1uz> counts{};
+    std::array<uint16_t, Symbols> symbols{};
+  };
+
+  /// Copy of bit buffer, which only gets committed by successful steps
+  struct Reader {
+    constexpr bool has(uint32_t n) const { return count >= n; }
+
+    constexpr uint32_t take(uint32_t n) {
+      auto const value{static_cast<uint32_t>(bits & ((1ull << n) - 1u))};
+      bits >>= n;
+      count -= n;
+      return value;
+    }
+
+    uint64_t bits;
+    uint32_t count;
+  };
+
+  static constexpr int more{-1};
+  static constexpr int invalid{-2};
+
+  /// Decode single symbol
+  ///
+  /// \param  reader  Bit reader
+  /// \param  huffman Huffman code
+  /// \return Symbol, \ref more if bits are missing or \ref invalid
+  template<size_t Symbols>
+  static constexpr int decode(Reader& reader, Huffman<Symbols> const& huffman) {
+    int code{}, first{}, index{};
+    for (auto len{1uz}; len <= max_bits; ++len) {
+      if (!reader.has(1u)) return more;
+      code |= static_cast<int>(reader.take(1u));
+      int const count{huffman.counts[len]};
+      if (code - count < first)
+        return huffman.symbols[static_cast<size_t>(index + code - first)];
+      index += count;
+      first = (first + count) << 1;
+      code <<= 1;
+    }
+    return invalid;
+  }
+
+  /// Decode single step
+  ///
+  /// \param  reader  Bit reader
+  /// \param  f       Consume decompressed bytes
+  /// \return Result
+  template<typename F>
+  Result step(Reader& reader, F& f) {
+    switch (_state) {
+      case State::BlockHeader: {
+        if (!reader.has(3u)) return Result::More;
+        _final = reader.take(1u);
+        switch (reader.take(2u)) {
+          case 0u: _state = State::StoredHeader; break;
+          case 1u: fixed(); break;
+          case 2u: _state = State::TableHeader; break;
+          default: return Result::Error;
+        }
+        return Result::Ok;
+      }
+
+      case State::StoredHeader: {
+        auto const align{reader.count % 8u};
+        if (!reader.has(align + 32u)) return Result::More;
+        reader.take(align);
+        auto const len{reader.take(16u)};
+        if (len != (~reader.take(16u) & 0xFFFFu)) return Result::Error;
+        _remaining = len;
+        _state = _remaining ? State::Stored : endOfBlock();
+        return Result::Ok;
+      }
+
+      case State::Stored:
+        if (!reader.has(8u)) return Result::More;
+        if (!put(static_cast<uint8_t>(reader.take(8u)), f))
+          return Result::Error;
+        if (!--_remaining) _state = endOfBlock();
+        return Result::Ok;
+
+      case State::TableHeader:
+        if (!reader.has(14u)) return Result::More;
+        _litlen_count = 257u + reader.take(5u);
+        _distance_count = 1u + reader.take(5u);
+        _code_length_count = 4u + reader.take(4u);
+        if (_litlen_count > max_litlen_codes ||
+            _distance_count > max_distance_codes)
+          return Result::Error;
+        _lengths = {};
+        _index = 0u;
+        _state = State::CodeLengthCodes;
+        return Result::Ok;
+
+      case State::CodeLengthCodes:
+        if (!reader.has(3u)) return Result::More;
+        _lengths[code_length_order[_index]] =
+          static_cast<uint8_t>(reader.take(3u));
+        if (++_index < _code_length_count) return Result::Ok;
+        if (!_code_lengths.build(std::span{_lengths}.first(19uz)))
+          return Result::Error;
+        _lengths = {};
+        _index = 0u;
+        _state = State::CodeLengths;
+        return Result::Ok;
+
+      case State::CodeLengths: {
+        auto const sym{decode(reader, _code_lengths)};
+        if (sym == more) return Result::More;
+        if (sym == invalid) return Result::Error;
+        auto const total{_litlen_count + _distance_count};
+        uint8_t len{};
+        uint32_t repeat{1u};
+        if (sym < 16) len = static_cast<uint8_t>(sym);
+        else if (sym == 16) {
+          if (!_index) return Result::Error;
+          if (!reader.has(2u)) return Result::More;
+          len = _lengths[_index - 1u];
+          repeat = 3u + reader.take(2u);
+        } else if (sym == 17) {
+          if (!reader.has(3u)) return Result::More;
+          repeat = 3u + reader.take(3u);
+        } else {
+          if (!reader.has(7u)) return Result::More;
+          repeat = 11u + reader.take(7u);
+        }
+        if (_index + repeat > total) return Result::Error;
+        while (repeat--) _lengths[_index++] = len;
+        if (_index < total) return Result::Ok;
+        // End of block code is mandatory
+        if (!_lengths[256uz] ||
+            !_litlen.build(std::span{_lengths}.first(_litlen_count)) ||
+            !_distances.build(
+              std::span{_lengths}.subspan(_litlen_count, _distance_count)))
+          return Result::Error;
+        _state = State::Codes;
+        return Result::Ok;
+      }
+
+      case State::Codes: {
+        auto const sym{decode(reader, _litlen)};
+        if (sym == more) return Result::More;
+        if (sym == invalid) return Result::Error;
+        if (sym < 256)
+          return put(static_cast<uint8_t>(sym), f) ? Result::Ok : Result::Error;
+        if (sym == 256) {
+          _state = endOfBlock();
+          return Result::Ok;
+        }
+
+        // Length/distance pair
+        auto const l{static_cast<size_t>(sym - 257)};
+        if (l >= size(length_bases)) return Result::Error;
+        if (!reader.has(length_extra[l])) return Result::More;
+        auto len{length_bases[l] + reader.take(length_extra[l])};
+        auto const d{decode(reader, _distances)};
+        if (d == more) return Result::More;
+        if (d == invalid || d >= static_cast<int>(size(distance_bases)))
+          return Result::Error;
+        auto const i{static_cast<size_t>(d)};
+        if (!reader.has(distance_extra[i])) return Result::More;
+        auto const dist{distance_bases[i] + reader.take(distance_extra[i])};
+        if (dist > WindowSize || dist > _pos) return Result::Error;
+        for (; len; --len)
+          if (!put(_window[(_pos - dist) & (WindowSize - 1uz)], f))
+            return Result::Error;
+        return Result::Ok;
+      }
+
+      case State::Done: break;
+    }
+    return Result::Error;
+  }
+
+  /// Use fixed Huffman codes (RFC 1951 3.2.6)
+  constexpr void fixed() {
+    std::array<uint8_t, 288uz> lengths{};
+    for (auto i{0uz}; i < size(lengths); ++i)
+      lengths[i] = i < 144uz ? 8u : i < 256uz ? 9u : i < 280uz ? 7u : 8u;
+    _litlen.build(lengths);
+    lengths.fill(5u);
+    _distances.build(std::span{lengths}.first(max_distance_codes));
+    _state = State::Codes;
+  }
+
+  /// State following the current block
+  ///
+  /// \return Next state
+  constexpr State endOfBlock() const {
+    return _final ? State::Done : State::BlockHeader;
+  }
+
+  /// Append byte to window
+  ///
+  /// \param  c Byte
+  /// \param  f Consume decompressed bytes
+  /// \retval true  Success
+  /// \retval false Consuming failed
+  template<typename F>
+  bool put(uint8_t c, F& f) {
+    _window[_pos++ & (WindowSize - 1uz)] = c;
+    return _pos & (WindowSize - 1uz) || flush(f);
+  }
+
+  /// Hand bytes not consumed yet to f
+  ///
+  /// \param  f Consume decompressed bytes
+  /// \retval true  Success
+  /// \retval false Consuming failed before or now
+  template<typename F>
+  bool flush(F& f) {
+    if (_error) return false;
+    auto const first{_flushed & (WindowSize - 1uz)};
+    auto const n{_pos - _flushed};
+    _flushed = _pos;
+    if (n && !f(std::span<uint8_t const>{data(_window) + first, n})) fail();
+    return !_error;
+  }
+
+  constexpr void fail() { _error = true; }
+
+  std::array<uint8_t, WindowSize> _window{};
+  Huffman<19uz> _code_lengths{};
+  Huffman<288uz> _litlen{};
+  Huffman<max_distance_codes> _distances{};
+  std::array<uint8_t, max_litlen_codes + max_distance_codes> _lengths{};
+  uint64_t _bits{};
+  uint32_t _bit_count{};
+  State _state{};
+  bool _final{};
+  uint32_t _remaining{};
+  uint32_t _litlen_count{};
+  uint32_t _distance_count{};
+  uint32_t _code_length_count{};
+  uint32_t _index{};
+  size_t _pos{};     ///< Bytes decompressed
+  size_t _flushed{}; ///< Bytes handed to consumer
+  bool _error{};
+};
+
+} // namespace mw::ota
@@ -0,0 +1,242 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Streaming delta patches
+///
+/// \file   mw/ota/patch.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <esp_err.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include "inflate.hpp"
+
+namespace mw::ota {
+
+/// Magic of delta patches
+inline constexpr std::array<uint8_t, 4uz> patch_magic{'O', 'R', 'D', 'P'};
+
+/// Size of delta patch header
+inline constexpr auto patch_header_size{size(patch_magic) + sizeof(uint32_t) +
+                                        32uz};
+
+/// Deflate window of delta patch operations
+inline constexpr auto patch_window_size{4096uz};
+
+/// Check whether bytes start a delta patch
+///
+/// \param  bytes First bytes of upload
+/// \retval true  Delta patch
+/// \retval false Image
+constexpr bool is_patch(std::span<uint8_t const> bytes) {
+  return size(bytes) >= size(patch_magic) &&
+         std::ranges::equal(bytes.first(size(patch_magic)), patch_magic);
+}
+
+/// Streaming delta patch applier
+///
+/// A delta patch describes the new image as a sequence of copies from the base
+/// image and inserted bytes. It starts with a header which names the base image
+/// by its ELF SHA-256 (`esp_app_desc_t::app_elf_sha256`).
+///
+/// | Offset | Size | Content                           |
+/// | ------ | ---- | --------------------------------- |
+/// | 0      | 4    | \ref patch_magic                  |
+/// | 4      | 4    | Size of new image (little endian) |
+/// | 8      | 32   | ELF SHA-256 of base image         |
+///
+/// The header is followed by operations, compressed as a single raw deflate
+/// stream (RFC 1951) with a window of \ref patch_window_size bytes. All numbers
+/// are unsigned LEB128, the offset delta is zigzag encoded. A copy continues at
+/// the base offset where the previous copy ended plus the delta, so mostly
+/// unchanged images result in small deltas.
+///
+/// | Operation  | Arguments                 |
+/// | ---------- | ------------------------- |
+/// | 0 (copy)   | Length, offset delta      |
+/// | 1 (insert) | Length, followed by bytes |
+///
+/// The patch gets fed in arbitrarily sized pieces. Besides the patcher itself,
+/// which uses a buffer of N bytes for copying and the deflate window, no memory
+/// is needed.
+/// - `esp_err_t read(size_t offset, std::span<uint8_t> bytes)` reads the base
+/// - `esp_err_t write(std::span<uint8_t const> bytes)` appends to the new image
+///
+/// \tparam N Size of copy buffer
+template<size_t N>
+requires(N >= patch_header_size)
+class Patcher {
+public:
+  /// Ctor
+  ///
+  /// \param  base  ELF SHA-256 of base image
+  explicit constexpr Patcher(std::span<uint8_t const, 32uz> base) {
+    std::ranges::copy(base, begin(_base));
+  }
+
+  /// Feed patch bytes
+  ///
+  /// \tparam R     Callable reading base
+  /// \tparam W     Callable writing new image
+  /// \param  bytes Patch bytes
+  /// \param  read  Read base
+  /// \param  write Write new image
+  /// \retval true  Success
+  /// \retval false Malformed patch, wrong base or read or write failed
+  template<typename R, typename W>
+  bool feed(std::span<uint8_t const> bytes, R&& read, W&& write) {
+    if (_error) return false;
+
+    //
+    if (_state == State::Header) {
+      auto const n{std::min(patch_header_size - _count, size(bytes))};
+      std::ranges::copy(bytes.first(n), begin(_buf) + _count);
+      bytes = bytes.subspan(n);
+      if ((_count += n) < patch_header_size) return true;
+      if (!is_patch(_buf) ||
+          !std::ranges::equal(std::span{_buf}.subspan(8uz, size(_base)),
+                              _base))
+        return fail();
+      _size = static_cast<uint32_t>(_buf[4uz] | _buf[5uz] << 8u |
+                                    _buf[6uz] << 16u) |
+              static_cast<uint32_t>(_buf[7uz]) << 24u;
+      _state = State::Op;
+    }
+
+    //
+    return _inflater.feed(bytes,
+                          [&](std::span<uint8_t const> ops) {
+                            return apply(ops, read, write);
+                          }) ||
+           fail();
+  }
+
+  /// Check whether patch has been applied completely
+  ///
+  /// \retval true  New image complete
+  /// \retval false New image incomplete
+  constexpr bool done() const {
+    return !_error && _inflater.done() && _state == State::Op &&
+           _written == _size;
+  }
+
+  /// Number of bytes written to new image
+  ///
+  /// \return Number of bytes written
+  constexpr size_t written() const { return _written; }
+
+private:
+  enum class State { Header, Op, Length, Offset, Data };
+  static constexpr uint8_t Copy{0u};
+  static constexpr uint8_t Insert{1u};
+
+  constexpr bool fail() {
+    _error = true;
+    return false;
+  }
+
+  // Apply decompressed operations
+  template<typename R, typename W>
+  bool apply(std::span<uint8_t const> bytes, R& read, W& write) {
+    while (!empty(bytes) && !_error) switch (_state) {
+        case State::Header: return fail();
+
+        case State::Op:
+          if (bytes.front() > Insert) return fail();
+          _op = bytes.front();
+          bytes = bytes.subspan(1uz);
+          _value = _shift = 0u;
+          _state = State::Length;
+          break;
+
+        case State::Length:
+          if (!varint(bytes)) break;
+          if (_value > _size - _written) return fail();
+          _count = _value;
+          _value = _shift = 0u;
+          _state = _op == Copy ? State::Offset : State::Data;
+          if (_state == State::Data && !_count) _state = State::Op;
+          break;
+
+        case State::Offset: {
+          if (!varint(bytes)) break;
+          auto const delta{static_cast<int64_t>(_value >> 1u) ^
+                           -static_cast<int64_t>(_value & 1u)};
+          if (delta < -_src) return fail();
+          _src += delta;
+          if (!copy(read, write)) return fail();
+          _state = State::Op;
+          break;
+        }
+
+        case State::Data: {
+          auto const n{std::min(_count, size(bytes))};
+          if (write(bytes.first(n))) return fail();
+          bytes = bytes.subspan(n);
+          _written += n;
+          if (!(_count -= n)) _state = State::Op;
+          break;
+        }
+      }
+    return !_error;
+  }
+
+  // Accumulate LEB128 number, returns true once complete
+  constexpr bool varint(std::span<uint8_t const>& bytes) {
+    while (!empty(bytes)) {
+      auto const byte{bytes.front()};
+      bytes = bytes.subspan(1uz);
+      if (_shift > 56u) return fail();
+      _value |= static_cast<uint64_t>(byte & 0x7Fu) << _shift;
+      _shift += 7u;
+      if (!(byte & 0x80u)) return true;
+    }
+    return false;
+  }
+
+  // Copy _count bytes of base starting at _src
+  template<typename R, typename W>
+  bool copy(R& read, W& write) {
+    while (_count) {
+      auto const n{std::min(_count, size(_buf))};
+      auto const bytes{std::span{_buf}.first(n)};
+      if (read(static_cast<size_t>(_src), bytes) || write(bytes)) return false;
+      _src += static_cast<int64_t>(n);
+      _written += n;
+      _count -= n;
+    }
+    return true;
+  }
+
+  std::array<uint8_t, N> _buf{};
+  std::array<uint8_t, 32uz> _base{};
+  Inflater<patch_window_size> _inflater{};
+  State _state{};
+  uint8_t _op{};
+  uint64_t _value{};
+  uint32_t _shift{};
+  size_t _count{};
+  int64_t _src{};
+  size_t _written{};
+  size_t _size{};
+  bool _error{};
+};
+
+} // namespace mw::ota
@@ -0,0 +1,160 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Resumable OTA upload
+///
+/// \file   mw/ota/resume.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <esp_err.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace mw::ota {
+
+/// First byte of begin frames
+inline constexpr uint8_t begin_type{'B'};
+
+/// Size of begin frame
+inline constexpr auto begin_size{2uz + sizeof(uint32_t) + 32uz};
+
+/// Begin of resumable upload
+struct Begin {
+  uint32_t size{};                    ///< Size of image
+  std::array<uint8_t, 32uz> sha256{}; ///< SHA-256 of image
+};
+
+/// Parse begin frame
+///
+/// | Offset | Size | Content                       |
+/// | ------ | ---- | ----------------------------- |
+/// | 0      | 1    | \ref begin_type               |
+/// | 1      | 1    | Reserved                      |
+/// | 2      | 4    | Size of image (little endian) |
+/// | 6      | 32   | SHA-256 of image              |
+///
+/// \param  frame Frame
+/// \return Begin
+/// \return std::nullopt if frame is no begin frame
+constexpr std::optional<Begin> parse_begin(std::span<uint8_t const> frame) {
+  if (size(frame) != begin_size || frame[0uz] != begin_type)
+    return std::nullopt;
+  Begin retval{.size = static_cast<uint32_t>(frame[2uz] | frame[3uz] << 8u |
+                                             frame[4uz] << 16u) |
+                       static_cast<uint32_t>(frame[5uz]) << 24u};
+  std::ranges::copy(frame.subspan(6uz), data(retval.sha256));
+  return retval;
+}
+
+/// Create answer to begin frame
+///
+/// | Offset | Size | Content                                 |
+/// | ------ | ---- | --------------------------------------- |
+/// | 0      | 1    | \ref ack or \ref nak                    |
+/// | 1      | 4    | Offset to continue from (little endian) |
+///
+/// \param  ack_or_nak  \ref ack or \ref nak
+/// \param  offset      Offset to continue from
+/// \return Answer to begin frame
+constexpr std::array<uint8_t, 5uz> begin_ack(uint8_t ack_or_nak,
+                                             uint32_t offset) {
+  return {ack_or_nak,
+          static_cast<uint8_t>(offset),
+          static_cast<uint8_t>(offset >> 8u),
+          static_cast<uint8_t>(offset >> 16u),
+          static_cast<uint8_t>(offset >> 24u)};
+}
+
+/// Persisted progress of resumable upload
+struct Progress {
+  friend constexpr bool operator==(Progress const&, Progress const&) = default;
+
+  std::array<uint8_t, 32uz> sha256{}; ///< SHA-256 of image
+  uint32_t size{};                    ///< Size of image
+  uint32_t address{};                 ///< Address of OTA partition
+  uint32_t offset{};                  ///< Bytes committed to OTA partition
+};
+
+/// Resumable upload
+///
+/// Uploads are identified by the SHA-256 and size of the image as well as the
+/// OTA partition they get written to. Every \ref checkpoint_interval bytes a
+/// checkpoint gets persisted. A client reconnecting with the same image
+/// continues from the last checkpoint instead of starting over. Checkpoints
+/// are multiples of the flash sector size, so resuming never depends on a
+/// partially written sector.
+///
+/// The store needs to provide the following members.
+/// - `std::optional<Progress> load()` loads progress
+/// - `esp_err_t save(Progress const&)` saves progress
+/// - `esp_err_t erase()` erases progress
+class Resumable {
+public:
+  /// Begin upload
+  ///
+  /// \tparam Store   Store type
+  /// \param  store   Store
+  /// \param  begin   Begin
+  /// \param  address Address of OTA partition
+  /// \return Offset to continue from
+  template<typename Store>
+  uint32_t begin(Store& store, Begin const& begin, uint32_t address) {
+    _progress = {.sha256 = begin.sha256,
+                 .size = begin.size,
+                 .address = address,
+                 .offset = 0u};
+    if (auto const saved{store.load()};
+        saved && saved->sha256 == _progress.sha256 &&
+        saved->size == _progress.size && saved->address == address &&
+        saved->offset <= saved->size && !(saved->offset % checkpoint_interval))
+      _progress.offset = saved->offset;
+    else store.save(_progress);
+    return _written = _progress.offset;
+  }
+
+  /// Account for bytes committed to OTA partition
+  ///
+  /// \tparam Store Store type
+  /// \param  store Store
+  /// \param  n     Number of bytes
+  /// \return Result of saving checkpoint, ESP_OK if none was due
+  template<typename Store>
+  esp_err_t written(Store& store, size_t n) {
+    _written += static_cast<uint32_t>(n);
+    auto const checkpoint{_written / checkpoint_interval * checkpoint_interval};
+    if (checkpoint <= _progress.offset || _written >= _progress.size)
+      return ESP_OK;
+    _progress.offset = static_cast<uint32_t>(checkpoint);
+    return store.save(_progress);
+  }
+
+  /// Check whether whole image has been committed
+  ///
+  /// \retval true  Image complete
+  /// \retval false Image incomplete
+  bool complete() const { return _written >= _progress.size; }
+
+private:
+  Progress _progress{};
+  uint32_t _written{};
+};
+
+} // namespace mw::ota
@@ -24,17 +24,47 @@
 #include "service.hpp"
 #include <esp_app_desc.h>
 #include <esp_app_format.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
 #include <ztl/utility.hpp>
 #include "drv/led/bug.hpp"
+#include "intf/http/outbox.hpp"
 #include "log.h"
+#include "mem/nvs/ota.hpp"
 #include "utility.hpp"
 
 namespace mw::ota {
 
+namespace {
+
+/// Persists progress of resumable uploads in NVS
+struct Store {
+  std::optional<Progress> load() const {
+    auto const blob{mem::nvs::Ota{}.getProgress()};
+    if (size(blob) != sizeof(Progress)) return std::nullopt;
+    Progress progress;
+    std::memcpy(&progress, data(blob), sizeof(progress));
+    return progress;
+  }
+
+  esp_err_t save(Progress const& progress) const {
+    return mem::nvs::Ota{}.setProgress(
+      {std::bit_cast<char const*>(&progress), sizeof(progress)});
+  }
+
+  esp_err_t erase() const { return mem::nvs::Ota{}.eraseProgress(); }
+};
+
+} // namespace
+
 /// \todo document
 /// \bug should this broadcast Z21 programming mode?
 Service::Service() {
   task.function = ztl::make_trampoline(this, &Service::taskFunction);
+  writer_task.function =
+    ztl::make_trampoline(this, &Service::writerTaskFunction);
 }
 
 /// \todo document
@@ -71,16 +101,39 @@ void Service::loop() {
   drv::led::Bug const led_bug{};
   auto const timeout{http_receive_timeout2ms()};
 
-  for (;;) {
-    assert(_queue.size());
-    auto const msg{std::move(_queue.front())};
-    _queue.pop();
+  for (auto sock_fd{-1};;) {
+    auto msg{_queue.pop(std::chrono::milliseconds{timeout})};
+    if (!msg) {
+      LOGI("WebSocket timeout");
+      if (auto const err{httpd_sess_trigger_close(sock_fd)})
+        LOGE("httpd_sess_trigger_close failed %s", esp_err_to_name(err));
+      return close();
+    }
+    sock_fd = msg->sock_fd;
 
-    switch (msg.type) {
-      case HTTPD_WS_TYPE_BINARY: _ack = write(msg.payload); break;
+    switch (msg->type) {
+      case HTTPD_WS_TYPE_BINARY:
+        // The first frame decides whether the upload is windowed
+        if (!_windowed && !_handle) {
+          if (auto const b{parse_begin(msg->payload)}) {
+            startWriter(sock_fd);
+            if (!resume(sock_fd, *b)) return close();
+            continue;
+          } else if (parse_chunk(msg->payload)) startWriter(sock_fd);
+        }
+        if (_windowed) {
+          if (!receive(sock_fd, msg->payload)) return close();
+          continue;
+        }
+        _ack = write(msg->payload) ? nak : ack;
+        break;
       case HTTPD_WS_TYPE_CLOSE:
         LOGI("WebSocket closed");
-        if (_handle) end();
+        if (_windowed) stopWriter();
+        // Keep progress of incomplete resumable upload
+        if (_handle && !_writer.error() &&
+            (!_resumable || _resumable->complete()))
+          end();
         return close();
       default:
         LOGE("WebSocket packet type neither binary nor close");
@@ -88,54 +141,213 @@ void Service::loop() {
         break;
     }
 
-    if (auto const err{httpd_queue_work(new intf::http::Message{
-          .sock_fd = msg.sock_fd,
-          .type = HTTPD_WS_TYPE_BINARY,
-          .payload = {_ack},
-        })}) {
-      LOGE("httpd_queue_work failed %s", esp_err_to_name(err));
+    if (auto const err{
+          intf::http::outbox.ack(sock_fd, {&_ack, sizeof(_ack)})}) {
+      LOGE("outbox ack failed %s", esp_err_to_name(err));
       return close();
     }
 
     // We can't continue in case of error... so abort
     if (_ack == nak) return close();
+  }
+}
 
-    TickType_t const then{xTaskGetTickCount() + pdMS_TO_TICKS(timeout)};
-    while (empty(_queue))
-      if (xTaskGetTickCount() >= then) {
-        LOGI("WebSocket timeout");
-        if (auto const err{httpd_sess_trigger_close(msg.sock_fd)})
-          LOGE("httpd_sess_trigger_close failed %s", esp_err_to_name(err));
-        return close();
+/// Hand chunk of windowed upload over to writer task
+///
+/// \param  sock_fd Socket descriptor
+/// \param  frame   Frame
+/// \retval true    Continue upload
+/// \retval false   Abort upload
+bool Service::receive(int sock_fd, std::span<uint8_t const> frame) {
+  switch (_window.receive(frame)) {
+    case Window::Verdict::Accept:
+      if (!_writer.submit(static_cast<uint16_t>(_window.next() - 1u),
+                          frame,
+                          std::chrono::milliseconds{writer_task.timeout})) {
+        LOGE("Writer failed or stalled");
+        return false;
+      }
+      return true;
+    case Window::Verdict::Nak:
+      LOGW("Chunk %u missing or corrupt", _window.next());
+      if (auto const err{intf::http::outbox.ack(
+            sock_fd, chunk_ack(nak, _window.next()))}) {
+        LOGE("outbox ack failed %s", esp_err_to_name(err));
+        return false;
       }
+      return true;
+    case Window::Verdict::Ignore: return true;
   }
+  std::unreachable();
 }
 
-/// \todo document
-uint8_t Service::write(std::vector<uint8_t> const& payload) {
+/// Begin or resume upload
+///
+/// If progress of the same image has been persisted, the OTA partition gets
+/// reopened at the last checkpoint. Otherwise the upload starts over. The
+/// client gets told the offset to continue from.
+///
+/// \param  sock_fd Socket descriptor
+/// \param  begin   Begin
+/// \retval true    Continue upload
+/// \retval false   Abort upload
+bool Service::resume(int sock_fd, Begin const& begin) {
+  _partition = esp_ota_get_next_update_partition(NULL);
+
   //
-  if (!_partition) _partition = esp_ota_get_next_update_partition(NULL);
+  uint32_t offset{};
+  auto err{!_partition ? ESP_ERR_NOT_FOUND
+           : begin.size > _partition->size ? ESP_ERR_INVALID_SIZE
+                                            : ESP_OK};
+  if (!err) {
+    Store store;
+    _offset = offset =
+      _resumable.emplace().begin(store, begin, _partition->address);
+    if (offset) {
+      LOGI("Resume update at %zu", static_cast<size_t>(offset));
+      err = esp_ota_resume(
+        _partition, OTA_WITH_SEQUENTIAL_WRITES, offset, &_handle);
+    } else
+      err = esp_ota_begin(_partition, OTA_WITH_SEQUENTIAL_WRITES, &_handle);
+  }
+  if (err) LOGE("Update failed %s", esp_err_to_name(err));
 
   //
-  if (!_handle)
+  if (auto const e{intf::http::outbox.ack(
+        sock_fd, begin_ack(err ? nak : ack, err ? 0u : offset))}) {
+    LOGE("outbox ack failed %s", esp_err_to_name(e));
+    return false;
+  }
+
+  return !err;
+}
+
+/// Start writer task for windowed upload
+///
+/// \param  sock_fd Socket descriptor acks get sent to
+void Service::startWriter(int sock_fd) {
+  _window = {};
+  _writer.reset();
+  _windowed = true;
+  _sock_fd = sock_fd;
+  _start_us = esp_timer_get_time();
+  LOGI_TASK_CREATE(writer_task);
+}
+
+/// Wait for writer task to write all queued chunks and log statistics
+void Service::stopWriter() {
+  _writer.stop();
+  _windowed = false;
+  auto const stats{_writer.stats()};
+  auto const us{std::max<int64_t>(esp_timer_get_time() - _start_us, 1)};
+  LOGI("Received %zu bytes in %zu chunks with %zu naks, %zu kB/s, flash %zu "
+       "ms, stalled %zu ms",
+       stats.bytes,
+       stats.chunks,
+       _window.naks(),
+       static_cast<size_t>(static_cast<int64_t>(stats.bytes) * 1000 / us),
+       static_cast<size_t>(stats.write_time.count() / 1000),
+       static_cast<size_t>(stats.stall_time.count() / 1000));
+}
+
+/// Writer task function
+///
+/// Writes chunks of a windowed upload and acknowledges each of them once it
+/// is in flash.
+[[noreturn]] void Service::writerTaskFunction(void*) {
+  _writer.run(
+    [this](std::span<uint8_t const> payload) { return write(payload); },
+    [this](uint16_t seq, esp_err_t err) {
+      if (auto const e{intf::http::outbox.ack(
+            _sock_fd, chunk_ack(err ? nak : ack, seq))}) {
+        // Client would wait for the ack forever
+        LOGE("outbox ack failed %s", esp_err_to_name(e));
+        httpd_sess_trigger_close(_sock_fd);
+      }
+    });
+  LOGI_TASK_DESTROY();
+}
+
+/// Write part of image
+///
+/// The OTA partition gets opened by the first write. If the upload starts with
+/// \ref patch_magic it's a delta patch which gets applied to the running image.
+///
+/// \param  payload Part of image or delta patch
+/// \return ESP_OK on success, error code from esp_ota_begin or esp_ota_write
+///         otherwise
+esp_err_t Service::write(std::span<uint8_t const> payload) {
+  //
+  if (!_partition) _partition = esp_ota_get_next_update_partition(NULL);
+
+  // Starting over invalidates any persisted progress
+  if (!_handle) {
+    Store{}.erase();
     if (auto const err{
           esp_ota_begin(_partition, OTA_WITH_SEQUENTIAL_WRITES, &_handle)}) {
       LOGE("Update failed %s", esp_err_to_name(err));
-      return nak;
+      return err;
     }
+  }
+
+  // Patches can't be resumed, the patcher state isn't persisted
+  if (!_offset && is_patch(payload)) {
+    LOGI("Apply delta patch");
+    _patcher.emplace(std::span{esp_app_get_description()->app_elf_sha256});
+    if (_resumable) {
+      _resumable.reset();
+      Store{}.erase();
+    }
+  }
+  _offset += size(payload);
+  if (_patcher) return patch(payload);
 
   //
   if (auto const err{esp_ota_write(_handle, data(payload), size(payload))}) {
     LOGE("Update failed %s", esp_err_to_name(err));
-    return nak;
+    return err;
   }
 
-  return ack;
+  //
+  if (_resumable)
+    if (Store store; auto const err{_resumable->written(store, size(payload))})
+      LOGW("Saving progress failed %s", esp_err_to_name(err));
+
+  return ESP_OK;
+}
+
+/// Apply part of delta patch
+///
+/// Copies get read from the running partition, the new image gets written just
+/// like a full one.
+///
+/// \param  payload Part of delta patch
+/// \return ESP_OK on success, ESP_FAIL if the patch is malformed, was made for
+///         another base or reading or writing failed
+esp_err_t Service::patch(std::span<uint8_t const> payload) {
+  auto const running{esp_ota_get_running_partition()};
+  if (_patcher->feed(
+        payload,
+        [running](size_t offset, std::span<uint8_t> bytes) {
+          return esp_partition_read(running, offset, data(bytes), size(bytes));
+        },
+        [this](std::span<uint8_t const> bytes) {
+          return esp_ota_write(_handle, data(bytes), size(bytes));
+        }))
+    return ESP_OK;
+  LOGE("Delta patch failed after %zu bytes", _patcher->written());
+  return ESP_FAIL;
 }
 
 /// \todo document
 void Service::end() {
+  // Whatever got written must be the complete image
+  if (_patcher && !_patcher->done()) {
+    LOGE("Delta patch incomplete");
+    return;
+  }
   auto err{esp_ota_end(_handle)};
+  if (_resumable) Store{}.erase();
   if (err == ESP_OK) err = esp_ota_set_boot_partition(_partition);
   if (err == ESP_OK) {
     LOGI("Update successful, restarting...");
@@ -146,10 +358,15 @@ void Service::end() {
 
 /// \todo document
 void Service::close() {
-  _queue = {};
+  if (_windowed) stopWriter();
+  _writer.reset(); // Errors must not leak into the next upload
+  _queue.clear();
   _partition = NULL;
   if (_handle) esp_ota_abort(_handle);
   _handle = {};
+  _resumable.reset();
+  _patcher.reset();
+  _offset = {};
   _ack = {};
   if (auto expected{State::OTA};
       !state.compare_exchange_strong(expected, State::Suspended))
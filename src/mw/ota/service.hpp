@@ -24,8 +24,14 @@
 #include <esp_err.h>
 #include <esp_ota_ops.h>
 #include <esp_partition.h>
-#include <queue>
+#include <optional>
+#include <span>
+#include <vector>
+#include "channel.hpp"
 #include "intf/http/message.hpp"
+#include "patch.hpp"
+#include "resume.hpp"
+#include "window.hpp"
 
 namespace mw::ota {
 
@@ -39,15 +45,30 @@ private:
   // This gets called by FreeRTOS
   [[noreturn]] void taskFunction(void*);
 
+  [[noreturn]] void writerTaskFunction(void*);
+
   void loop();
-  uint8_t write(std::vector<uint8_t> const& payload);
+  bool receive(int sock_fd, std::span<uint8_t const> frame);
+  bool resume(int sock_fd, Begin const& begin);
+  void startWriter(int sock_fd);
+  void stopWriter();
+  esp_err_t write(std::span<uint8_t const> payload);
+  esp_err_t patch(std::span<uint8_t const> payload);
   void end();
   void close();
 
-  std::queue<intf::http::Message> _queue{};
+  Channel<intf::http::Message> _queue{};
   esp_partition_t const* _partition{};
   esp_ota_handle_t _handle{};
   uint8_t _ack{};
+  Window _window{};
+  FlashWriter _writer{};
+  std::optional<Resumable> _resumable{};
+  std::optional<Patcher<patch_buffer_size>> _patcher{};
+  size_t _offset{};
+  bool _windowed{};
+  int _sock_fd{-1};
+  int64_t _start_us{};
 };
 
 } // namespace mw::ota
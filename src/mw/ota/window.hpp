@@ -0,0 +1,295 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Windowed OTA upload
+///
+/// \file   mw/ota/window.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <esp_err.h>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+#include "crc32.hpp"
+
+namespace mw::ota {
+
+/// First byte of chunk frames
+inline constexpr uint8_t chunk_type{'C'};
+
+/// Size of chunk header
+inline constexpr auto chunk_header_size{8uz};
+
+/// Chunk of windowed upload
+struct Chunk {
+  /// Check payload against CRC
+  ///
+  /// \retval true  CRC matches
+  /// \retval false CRC mismatch
+  constexpr bool valid() const {
+    return crc32(0u, data(payload), size(payload)) == crc;
+  }
+
+  uint16_t seq{};                     ///< Sequence number
+  uint32_t crc{};                     ///< CRC-32 of payload
+  std::span<uint8_t const> payload{}; ///< Image bytes
+};
+
+/// Parse chunk frame
+///
+/// | Offset | Size | Content                           |
+/// | ------ | ---- | --------------------------------- |
+/// | 0      | 1    | \ref chunk_type                   |
+/// | 1      | 1    | Reserved                          |
+/// | 2      | 2    | Sequence number (little endian)   |
+/// | 4      | 4    | CRC-32 of payload (little endian) |
+/// | 8      | n    | Payload                           |
+///
+/// \param  frame Frame
+/// \return Chunk
+/// \return std::nullopt if frame is no chunk
+constexpr std::optional<Chunk> parse_chunk(std::span<uint8_t const> frame) {
+  if (size(frame) < chunk_header_size || frame[0uz] != chunk_type)
+    return std::nullopt;
+  return Chunk{
+    .seq = static_cast<uint16_t>(frame[2uz] | frame[3uz] << 8u),
+    .crc = static_cast<uint32_t>(frame[4uz] | frame[5uz] << 8u |
+                                 frame[6uz] << 16u) |
+           static_cast<uint32_t>(frame[7uz]) << 24u,
+    .payload = frame.subspan(chunk_header_size)};
+}
+
+/// Create acknowledge frame of windowed upload
+///
+/// | Offset | Size | Content                         |
+/// | ------ | ---- | ------------------------------- |
+/// | 0      | 1    | \ref ack or \ref nak            |
+/// | 1      | 2    | Sequence number (little endian) |
+///
+/// An ack carries the sequence number of the chunk which has been written to
+/// flash, a nak the sequence number of the next expected chunk.
+///
+/// \param  ack_or_nak  \ref ack or \ref nak
+/// \param  seq         Sequence number
+/// \return Acknowledge frame
+constexpr std::array<uint8_t, 3uz> chunk_ack(uint8_t ack_or_nak, uint16_t seq) {
+  return {ack_or_nak,
+          static_cast<uint8_t>(seq),
+          static_cast<uint8_t>(seq >> 8u)};
+}
+
+/// Receiving side of sliding window
+///
+/// Chunks must be accepted in order (go-back-N). If the expected chunk is
+/// corrupt or a chunk got skipped, a nak carrying the next expected sequence
+/// number is sent and the client continues from there. Chunks of the abandoned
+/// window which are still in flight get ignored.
+class Window {
+public:
+  enum class Verdict { Accept, Nak, Ignore };
+
+  /// Receive frame
+  ///
+  /// \param  frame   Frame
+  /// \return Verdict
+  constexpr Verdict receive(std::span<uint8_t const> frame) {
+    auto const chunk{parse_chunk(frame)};
+
+    // Expected chunk, nak every corrupt attempt so retransmissions can't stall
+    if (chunk && chunk->seq == _next) {
+      if (!chunk->valid()) return nak();
+      ++_next;
+      _nak_pending = false;
+      return Verdict::Accept;
+    }
+    // Chunk of abandoned window, or gap which has already been nak'ed
+    else if ((chunk && static_cast<int16_t>(chunk->seq - _next) < 0) ||
+             _nak_pending)
+      return Verdict::Ignore;
+    // Gap or garbage
+    else return nak();
+  }
+
+  /// Next expected sequence number
+  ///
+  /// \return Sequence number
+  constexpr uint16_t next() const { return _next; }
+
+  /// Number of naks
+  ///
+  /// \return Number of naks
+  constexpr size_t naks() const { return _naks; }
+
+private:
+  constexpr Verdict nak() {
+    _nak_pending = true;
+    ++_naks;
+    return Verdict::Nak;
+  }
+
+  uint16_t _next{};
+  bool _nak_pending{};
+  size_t _naks{};
+};
+
+/// Double buffered flash writer
+///
+/// The receiving task hands accepted chunks over to a separate writer task, so
+/// that one chunk gets written to flash while the next one is being received.
+/// The writer owns at most two chunks at a time. If both buffers are in use,
+/// the receiving task blocks, which in turn throttles the client through its
+/// window. Once a write failed, all further chunks get discarded. Chunks get
+/// copied into buffers which keep their capacity, so writing doesn't allocate.
+class FlashWriter {
+  using clock = std::chrono::steady_clock;
+
+public:
+  /// Throughput statistics
+  struct Stats {
+    size_t bytes{};                         ///< Bytes written
+    size_t chunks{};                        ///< Chunks written
+    std::chrono::microseconds write_time{}; ///< Time spent writing flash
+    std::chrono::microseconds stall_time{}; ///< Time waited for free buffer
+  };
+
+  /// Hand chunk over to writer
+  ///
+  /// \param  seq     Sequence number
+  /// \param  frame   Frame containing chunk
+  /// \param  timeout Maximum time to wait for free buffer
+  /// \retval true    Chunk queued
+  /// \retval false   Timeout or previous write failed
+  bool submit(uint16_t seq,
+              std::span<uint8_t const> frame,
+              std::chrono::milliseconds timeout) {
+    auto const then{clock::now()};
+    std::unique_lock lock{_mutex};
+    auto const ready{_cv.wait_for(lock, timeout, [this] {
+      return _count < size(_buffers) || _error;
+    })};
+    _stats.stall_time += std::chrono::duration_cast<std::chrono::microseconds>(
+      clock::now() - then);
+    if (!ready || _error) return false;
+    auto& buffer{_buffers[(_head + _count++) % size(_buffers)]};
+    buffer.seq = seq;
+    buffer.frame.assign(cbegin(frame), cend(frame));
+    _cv.notify_all();
+    return true;
+  }
+
+  /// Write chunks until stopped
+  ///
+  /// \tparam W     `esp_err_t(std::span<uint8_t const>)`
+  /// \tparam D     `void(uint16_t, esp_err_t)`
+  /// \param  write Write payload to flash
+  /// \param  done  Report result of written chunk
+  template<typename W, typename D>
+  void run(W&& write, D&& done) {
+    std::unique_lock lock{_mutex};
+    for (;;) {
+      _cv.wait(lock, [this] { return _count || _stop; });
+      if (!_count) break;
+      // Head buffer stays ours until _count gets decremented
+      auto const& buffer{_buffers[_head]};
+      auto const discard{_error};
+      lock.unlock();
+
+      esp_err_t err{ESP_FAIL};
+      auto const then{clock::now()};
+      if (!discard) {
+        err = write(
+          std::span<uint8_t const>{buffer.frame}.subspan(chunk_header_size));
+        done(buffer.seq, err);
+      }
+      auto const elapsed{std::chrono::duration_cast<std::chrono::microseconds>(
+        clock::now() - then)};
+
+      lock.lock();
+      if (err) _error = true;
+      else {
+        _stats.bytes += size(buffer.frame) - chunk_header_size;
+        ++_stats.chunks;
+        _stats.write_time += elapsed;
+      }
+      _head = (_head + 1uz) % size(_buffers);
+      --_count;
+      _cv.notify_all();
+    }
+    _done = true;
+    _cv.notify_all();
+  }
+
+  /// Stop writer once all queued chunks are written
+  ///
+  /// Blocks until \ref run returned.
+  void stop() {
+    std::unique_lock lock{_mutex};
+    _stop = true;
+    _cv.notify_all();
+    _cv.wait(lock, [this] { return _done; });
+  }
+
+  /// Reset writer for next upload
+  void reset() {
+    std::scoped_lock lock{_mutex};
+    for (auto& buffer : _buffers) buffer.frame.clear();
+    _head = _count = 0uz;
+    _stop = _done = _error = false;
+    _stats = {};
+  }
+
+  /// Check whether a write failed
+  ///
+  /// \retval true  Write failed
+  /// \retval false No write failed
+  bool error() const {
+    std::scoped_lock lock{_mutex};
+    return _error;
+  }
+
+  /// Get throughput statistics
+  ///
+  /// \return Statistics
+  Stats stats() const {
+    std::scoped_lock lock{_mutex};
+    return _stats;
+  }
+
+private:
+  struct Buffer {
+    uint16_t seq{};
+    std::vector<uint8_t> frame{};
+  };
+
+  mutable std::mutex _mutex;
+  std::condition_variable _cv;
+  std::array<Buffer, 2uz> _buffers{};
+  size_t _head{};
+  size_t _count{};
+  bool _stop{};
+  bool _done{};
+  bool _error{};
+  Stats _stats{};
+};
+
+} // namespace mw::ota
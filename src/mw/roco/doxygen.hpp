@@ -28,11 +28,19 @@ namespace mw::roco {
 /// \todo document ROCO page
 ///
 /// \section section_mw_roco_z21 Z21
+/// \copydetails z21::Service::taskFunction
+///
+/// \copydetails z21::Service::execTaskFunction
+///
+/// \copydetails z21::Service::progTaskFunction
+///
+/// \subsection subsection_mw_roco_z21_aggregator Aggregator
+/// \copydetails z21::Aggregator
 ///
 /// <div class="section_buttons">
-/// | Previous         | Next              |
-/// | :--------------- | ----------------: |
-/// | \ref page_mw_ota | \ref page_mw_zimo |
+/// | Previous         | Next               |
+/// | :--------------- | -----------------: |
+/// | \ref page_mw_ota | \ref page_mw_telem |
 /// </div>
 
 } // namespace mw::roco
@@ -0,0 +1,160 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Z21 outbound datagram aggregator
+///
+/// \file   mw/roco/z21/aggregator.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "aggregator.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace mw::roco::z21 {
+
+/// Ctor
+///
+/// \param  transmit  Callback which actually sends a datagram
+/// \param  mtu       Maximum payload size of a single datagram
+/// \param  window_us Time datasets are held back at most [us]
+Aggregator::Aggregator(Transmit transmit, size_t mtu, uint32_t window_us)
+  : _transmit{std::move(transmit)}, _mtu{mtu}, _window_us{window_us} {}
+
+/// Append datasets for a client
+///
+/// If there is not enough room left in the clients buffer, the buffer gets
+/// flushed first. Datasets which don't fit into an empty buffer are sent right
+/// away, but only after the clients buffer so that datasets stay in order.
+///
+/// \param  sock      Client socket
+/// \param  datasets  Datasets
+/// \param  now_us    Current time [us]
+/// \retval true      A new buffer was started, so \ref deadline changed
+/// \retval false     Datasets got appended to an existing buffer or were sent
+bool Aggregator::append(::z21::Socket const& sock,
+                        std::span<uint8_t const> datasets,
+                        uint64_t now_us) {
+  std::lock_guard lock{_mutex};
+  ++_datasets;
+
+  auto it{std::ranges::find_if(
+    _buffers, [&sock](Buffer const& b) { return equal(b.sock, sock); })};
+
+  // Flush existing buffer if datasets don't fit anymore (keeps order)
+  if (it != end(_buffers) && size(it->payload) + size(datasets) > _mtu) {
+    send(*it);
+    _buffers.erase(it);
+    it = end(_buffers);
+  }
+
+  // Too large to be aggregated at all
+  if (size(datasets) > _mtu) {
+    ++_datagrams;
+    _transmit(sock, datasets);
+    return false;
+  }
+
+  //
+  if (it == end(_buffers)) {
+    _buffers.push_back({.sock = sock,
+                        .payload = {cbegin(datasets), cend(datasets)},
+                        .datasets = 1u,
+                        .deadline_us = now_us + _window_us});
+    return true;
+  } else {
+    it->payload.insert(end(it->payload), cbegin(datasets), cend(datasets));
+    ++it->datasets;
+    return false;
+  }
+}
+
+/// Flush all buffers whose window has expired
+///
+/// \param  now_us  Current time [us]
+void Aggregator::poll(uint64_t now_us) {
+  std::lock_guard lock{_mutex};
+  std::erase_if(_buffers, [this, now_us](Buffer const& b) {
+    if (b.deadline_us > now_us) return false;
+    send(b);
+    return true;
+  });
+}
+
+/// Flush all buffers
+void Aggregator::flush() {
+  std::lock_guard lock{_mutex};
+  for (auto const& b : _buffers) send(b);
+  _buffers.clear();
+}
+
+/// Get earliest deadline of all buffers
+///
+/// \return Earliest deadline [us] or std::nullopt if all buffers are empty
+std::optional<uint64_t> Aggregator::deadline() const {
+  std::lock_guard lock{_mutex};
+  if (empty(_buffers)) return std::nullopt;
+  return std::ranges::min_element(_buffers, {}, &Buffer::deadline_us)
+    ->deadline_us;
+}
+
+/// Get number of appended datasets
+///
+/// \return Number of appended datasets
+uint32_t Aggregator::datasets() const {
+  std::lock_guard lock{_mutex};
+  return _datasets;
+}
+
+/// Get number of transmitted datagrams
+///
+/// \return Number of transmitted datagrams
+uint32_t Aggregator::datagrams() const {
+  std::lock_guard lock{_mutex};
+  return _datagrams;
+}
+
+/// Get number of datagrams saved by aggregation
+///
+/// Datasets which are still buffered don't count as saved.
+///
+/// \return Number of datagrams saved
+uint32_t Aggregator::saved() const {
+  std::lock_guard lock{_mutex};
+  uint32_t pending{};
+  for (auto const& b : _buffers) pending += b.datasets;
+  return _datasets - pending - _datagrams;
+}
+
+/// Compare two sockets by descriptor and peer address
+///
+/// \param  lhs   Socket
+/// \param  rhs   Socket
+/// \retval true  Sockets refer to the same client
+/// \retval false Sockets refer to different clients
+bool Aggregator::equal(::z21::Socket const& lhs, ::z21::Socket const& rhs) {
+  return lhs.fd == rhs.fd && lhs.len == rhs.len &&
+         !std::memcmp(&lhs.addr, &rhs.addr, lhs.len);
+}
+
+/// Send buffer as single datagram
+///
+/// \param  buffer  Buffer
+void Aggregator::send(Buffer const& buffer) {
+  ++_datagrams;
+  _transmit(buffer.sock, buffer.payload);
+}
+
+} // namespace mw::roco::z21
@@ -0,0 +1,80 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Z21 outbound datagram aggregator
+///
+/// \file   mw/roco/z21/aggregator.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+#include <z21/z21.hpp>
+
+namespace mw::roco::z21 {
+
+/// Z21 outbound datagram aggregator
+///
+/// The Z21 protocol allows multiple datasets in a single UDP payload. Instead
+/// of sending every dataset on its own, datasets are collected per client for
+/// a short window and then sent as one datagram. A buffer gets flushed early
+/// if the next dataset would exceed the MTU.
+class Aggregator {
+public:
+  using Transmit =
+    std::function<void(::z21::Socket const&, std::span<uint8_t const>)>;
+
+  Aggregator(Transmit transmit, size_t mtu, uint32_t window_us);
+
+  bool append(::z21::Socket const& sock,
+              std::span<uint8_t const> datasets,
+              uint64_t now_us);
+  void poll(uint64_t now_us);
+  void flush();
+
+  std::optional<uint64_t> deadline() const;
+
+  uint32_t datasets() const;
+  uint32_t datagrams() const;
+  uint32_t saved() const;
+
+private:
+  /// Pending datasets of a single client
+  struct Buffer {
+    ::z21::Socket sock;
+    std::vector<uint8_t> payload;
+    uint32_t datasets;
+    uint64_t deadline_us;
+  };
+
+  static bool equal(::z21::Socket const& lhs, ::z21::Socket const& rhs);
+  void send(Buffer const& buffer);
+
+  Transmit _transmit;
+  size_t _mtu;
+  uint32_t _window_us;
+
+  std::vector<Buffer> _buffers;
+  uint32_t _datasets{};
+  uint32_t _datagrams{};
+  mutable std::mutex _mutex;
+};
+
+} // namespace mw::roco::z21
@@ -31,7 +31,8 @@ esp_err_t init() {
   if (intf::http::sta::server) {
     service = std::make_shared<Service>();
     service->dcc(dcc::service);
-    dcc::service->z21(service, service);
+    dcc::service->z21(
+      service, service, std::bind_front(&Service::post, service.get()));
     intf::http::sta::server->subscribe(
       {.uri = "/roco/z21/"}, service, &Service::socket);
   }
@@ -14,10 +14,13 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "service.hpp"
+#include <esp_timer.h>
+#include <esp_vfs_eventfd.h>
 #include <lwip/sockets.h>
+#include <ranges>
 #include <ztl/string.hpp>
-#include "drv/anlg/convert.hpp"
 #include "drv/led/bug.hpp"
+#include "intf/http/outbox.hpp"
 #include "log.h"
 #include "mem/nvs/settings.hpp"
 #include "utility.hpp"
@@ -26,8 +29,55 @@ namespace mw::roco::z21 {
 
 using namespace std::literals;
 
-/// \todo document
-Service::Service() {
+namespace {
+
+/// Get key under which a WebSocket frame may replace an older one
+///
+/// Only frames consisting of a single state dataset (loco info, turnout info,
+/// RailCom data or system state) get a key. Newer state of the same loco or
+/// turnout makes older state obsolete, so there is no point in sending both.
+///
+/// \param  datasets  Datasets
+/// \return Key or 0 if frame must not be coalesced
+uint32_t coalesce_key(std::span<uint8_t const> datasets) {
+  if (size(datasets) < 4uz ||
+      static_cast<size_t>(datasets[0uz] | datasets[1uz] << 8u) !=
+        size(datasets))
+    return 0u;
+  auto const header{
+    static_cast<uint32_t>(datasets[2uz] | datasets[3uz] << 8u)};
+  // LAN_X_LOCO_INFO and LAN_X_TURNOUT_INFO
+  if (header == 0x40u && size(datasets) >= 7uz &&
+      (datasets[4uz] == 0xEFu || datasets[4uz] == 0x43u))
+    return static_cast<uint32_t>(datasets[4uz] << 16u | datasets[5uz] << 8u |
+                                 datasets[6uz]);
+  // LAN_RAILCOM_DATACHANGED
+  else if (header == 0x88u && size(datasets) >= 6uz)
+    return static_cast<uint32_t>(header << 16u | datasets[5uz] << 8u |
+                                 datasets[4uz]);
+  // LAN_SYSTEMSTATE_DATACHANGED
+  else if (header == 0x84u) return header << 16u;
+  else return 0u;
+}
+
+/// LAN_LOGOFF
+constexpr std::array<uint8_t, 4uz> logoff_dataset{0x04u, 0x00u, 0x30u, 0x00u};
+
+} // namespace
+
+/// \todo document
+Service::Service()
+  : _pom_queue{xQueueCreate(max_queued_pom_requests, sizeof(PomRequest))},
+    _aggregator{[this](z21::Socket const& sock,
+                       std::span<uint8_t const> payload) {
+                  sendTo(sock, payload);
+                },
+                aggregation_mtu,
+                aggregation_window},
+    _wakeup_fd{eventfd(0, 0)} {
+  assert(_pom_queue && _wakeup_fd >= 0);
+  prog_task.create(ztl::make_trampoline(this, &Service::progTaskFunction));
+  exec_task.create(ztl::make_trampoline(this, &Service::execTaskFunction));
   task.create(ztl::make_trampoline(this, &Service::taskFunction));
 }
 
@@ -36,99 +86,444 @@ void Service::dcc(std::shared_ptr<z21::server::intf::Dcc> dcc_service) {
   _dcc_service = dcc_service;
 }
 
-/// \todo document
-/// \bug if the socket closes for any reason we're fucked, there must be some
-/// way to detect such cases and restart the socket in the Frontend?
+/// Handle WebSocket messages
+///
+/// Binary messages are not processed in the HTTP server task. Instead they are
+/// queued together with the peer address for the exec task, just like UDP
+/// datagrams. Pong and close frames are queued as well, so that the client
+/// registry is only ever touched by the exec task.
 esp_err_t Service::socket(intf::http::Message& msg) {
-  switch (msg.type) {
-    case HTTPD_WS_TYPE_BINARY: {
-      _ws_sock_fds.insert(msg.sock_fd);
+  Datagram datagram{.sock_fd = msg.sock_fd,
+                    .addr = {},
+                    .len = sizeof(sockaddr_storage),
+                    .payload = {},
+                    .kind = Datagram::WebSocket};
 
-      //
-      sockaddr_in dest_addr_ip4;
-      socklen_t socklen{sizeof(dest_addr_ip4)};
+  switch (msg.type) {
+    case HTTPD_WS_TYPE_BINARY:
       if (getpeername(msg.sock_fd,
-                      std::bit_cast<sockaddr*>(&dest_addr_ip4),
-                      &socklen) < 0) {
+                      std::bit_cast<sockaddr*>(&datagram.addr),
+                      &datagram.len) < 0) {
         LOGD("getpeername failed %s", strerror(errno));
         return ESP_FAIL;
       }
-
-      //
-      std::lock_guard lock{_internal_mutex};
-      receive({msg.sock_fd, std::bit_cast<sockaddr*>(&dest_addr_ip4), socklen},
-              msg.payload);
-      execute();
-      break;
-    }
-    case HTTPD_WS_TYPE_CLOSE:
-      /// \todo implicit power off here if there are no more clients registered?
-      _ws_sock_fds.erase(msg.sock_fd);
+      datagram.payload = std::move(msg.payload);
       break;
-    default: break;
+    case HTTPD_WS_TYPE_PONG: datagram.kind = Datagram::Pong; break;
+    case HTTPD_WS_TYPE_CLOSE: datagram.kind = Datagram::Close; break;
+    default: return ESP_OK;
   }
 
+  //
+  if (enqueue(std::move(datagram)))
+    xTaskNotifyGiveIndexed(exec_task.handle, default_notify_index);
+
   return ESP_OK;
 }
 
-/// \todo document
+/// Wake up the task blocking in `select()`
+void Service::wakeup() const {
+  uint64_t const value{1u};
+  if (write(_wakeup_fd, &value, sizeof(value)) < 0)
+    LOGE("write failed %s", strerror(errno));
+}
+
+/// Z21 receive task function
+///
+/// The task blocks in `select()` on all UDP sockets in \ref intf::udp::sock_fds
+/// and an internal eventfd used by wakeup(). Once anything becomes readable, up
+/// to \ref max_datagrams_per_socket datagrams per UDP socket are read and
+/// queued for the exec task. The number of datagrams per wakeup is tracked in
+/// \ref wakeups, \ref datagrams and \ref max_datagrams_per_wakeup.
+///
+/// This task never executes any command itself, so reading from the sockets
+/// can't stall behind slow operations. If the exec task falls behind by more
+/// than \ref max_queued_datagrams, further datagrams are dropped and counted
+/// in \ref ingress_drops.
+///
+/// While the \ref Aggregator holds outbound datasets, the `select()` timeout is
+/// limited to its earliest deadline so that no dataset is delayed for longer
+/// than \ref aggregation_window.
 [[noreturn]] void Service::taskFunction(void*) {
-  std::array<uint8_t, Z21_MAX_PAYLOAD_SIZE> stack;
-  sockaddr_in dest_addr_ip4;
-  socklen_t socklen{sizeof(dest_addr_ip4)};
+  for (;;) {
+    timeval tv{};
+    timeval* timeout{NULL};
+    if (auto const deadline{_aggregator.deadline()}) {
+      auto const now{static_cast<uint64_t>(esp_timer_get_time())};
+      auto const us{*deadline > now ? *deadline - now : 0u};
+      tv.tv_sec = static_cast<time_t>(us / 1'000'000u);
+      tv.tv_usec = static_cast<suseconds_t>(us % 1'000'000u);
+      timeout = &tv;
+    }
 
-  /*
-  // Multiple sockets, non-blocking ->
-  fd_set fds;
-  FD_ZERO(&fds);
-  FD_SET(udp::sock_fd, &fds);
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(_wakeup_fd, &fds);
+    auto max_fd{_wakeup_fd};
+    for (auto const fd : intf::udp::sock_fds)
+      if (fd >= 0) {
+        FD_SET(fd, &fds);
+        max_fd = std::max(max_fd, fd);
+      }
 
-  select(FD_SETSIZE, &fds, NULL, NULL, NULL);
+    auto const ready{select(max_fd + 1, &fds, NULL, NULL, timeout)};
+    if (ready < 0) {
+      LOGE("select failed %s", strerror(errno));
+      vTaskDelay(pdMS_TO_TICKS(task.timeout));
+      continue;
+    }
 
-  if (FD_ISSET(udp::sock_fd, &fds)) {
-    recvfrom...
+    // Reset eventfd counter
+    if (FD_ISSET(_wakeup_fd, &fds)) {
+      uint64_t value;
+      if (read(_wakeup_fd, &value, sizeof(value)) < 0)
+        LOGE("read failed %s", strerror(errno));
+    }
+
+    //
+    auto n{0uz};
+    for (auto const fd : intf::udp::sock_fds)
+      if (fd >= 0 && FD_ISSET(fd, &fds)) n += receiveUdp(fd);
+    if (n) xTaskNotifyGiveIndexed(exec_task.handle, default_notify_index);
+
+    //
+    if (ready) {
+      wakeups.fetch_add(1u, std::memory_order_relaxed);
+      datagrams.fetch_add(static_cast<uint32_t>(n), std::memory_order_relaxed);
+      if (n > max_datagrams_per_wakeup.load(std::memory_order_relaxed))
+        max_datagrams_per_wakeup.store(static_cast<uint32_t>(n),
+                                       std::memory_order_relaxed);
+    }
+
+    // Flush expired buffers
+    _aggregator.poll(static_cast<uint64_t>(esp_timer_get_time()));
+    datagrams_saved.store(_aggregator.saved(), std::memory_order_relaxed);
   }
-  */
+}
 
+/// Run work on the exec task
+///
+/// The client registry is only ever touched by the exec task. Other tasks
+/// which broadcast, and therefore walk the registry, must post their
+/// broadcasts here instead of calling into the Z21 server directly.
+///
+/// \param  work  Work
+void Service::post(Work work) {
+  {
+    std::lock_guard lock{_datagrams_mutex};
+    _posted.push_back(std::move(work));
+  }
+  xTaskNotifyGiveIndexed(exec_task.handle, default_notify_index);
+}
+
+/// Z21 exec task function
+///
+/// Waits for queued UDP and WebSocket datagrams and executes all of them in one
+/// batch under a single lock acquisition, followed by any \ref post "posted"
+/// work. Every \ref client_check_interval the client registry is checked for
+/// clients which went silent.
+[[noreturn]] void Service::execTaskFunction(void*) {
+  std::vector<Datagram> batch;
+  std::vector<Work> posted;
   for (;;) {
-    if (auto const len{recvfrom(intf::udp::sock_fd,
-                                data(stack),
-                                size(stack) - 1,
-                                0,
-                                std::bit_cast<sockaddr*>(&dest_addr_ip4),
-                                &socklen)};
-        len < 0) {
-      LOGE("recvfrom failed %s", strerror(errno));
-      vTaskDelay(pdMS_TO_TICKS(task.timeout));
-    } else if (len > 0) {
+    ulTaskNotifyTakeIndexed(
+      default_notify_index, pdTRUE, pdMS_TO_TICKS(exec_task.timeout));
+
+    //
+    {
+      std::lock_guard lock{_datagrams_mutex};
+      batch.swap(_datagrams);
+      posted.swap(_posted);
+    }
+
+    //
+    {
       std::lock_guard lock{_internal_mutex};
-      receive(
-        {intf::udp::sock_fd, std::bit_cast<sockaddr*>(&dest_addr_ip4), socklen},
-        {data(stack), static_cast<size_t>(len)});
-      execute();
+      for (auto& datagram : batch) {
+        if (!touch(datagram)) continue;
+        receive({datagram.sock_fd,
+                 std::bit_cast<sockaddr*>(&datagram.addr),
+                 datagram.len},
+                datagram.payload);
+        execute();
+      }
+      for (auto const& work : posted) work();
+      if (xTaskGetTickCount() - _reap_tick >=
+          pdMS_TO_TICKS(client_check_interval))
+        reap();
     }
+    batch.clear();
+    posted.clear();
   }
 }
 
-/// \todo document
+/// Z21 prog task function
+///
+/// Executes POM requests. Those include mandatory delays between packets and
+/// are therefore kept off the exec task. Results are reported back through the
+/// usual cvAck() and cvNack() broadcasts.
+[[noreturn]] void Service::progTaskFunction(void*) {
+  for (;;) {
+    PomRequest req;
+    if (!xQueueReceive(_pom_queue, &req, portMAX_DELAY)) continue;
+    switch (req.type) {
+      case PomRequest::LocoRead:
+        _dcc_service->cvPomRead(req.addr, req.cv_addr);
+        break;
+      case PomRequest::LocoWrite:
+        _dcc_service->cvPomWrite(req.addr, req.cv_addr, req.byte);
+        break;
+      case PomRequest::AccessoryRead:
+        _dcc_service->cvPomAccessoryRead(req.addr, req.cv_addr, req.c);
+        break;
+      case PomRequest::AccessoryWrite:
+        _dcc_service->cvPomAccessoryWrite(
+          req.addr, req.cv_addr, req.byte, req.c);
+        break;
+    }
+  }
+}
+
+/// Queue datagram for the exec task
+///
+/// \param  datagram  Datagram
+/// \retval true      Datagram queued
+/// \retval false     Queue full, datagram dropped
+bool Service::enqueue(Datagram&& datagram) {
+  std::lock_guard lock{_datagrams_mutex};
+  if (size(_datagrams) >= max_queued_datagrams) {
+    ingress_drops.fetch_add(1u, std::memory_order_relaxed);
+    return false;
+  }
+  _datagrams.push_back(std::move(datagram));
+  return true;
+}
+
+/// Queue POM request for the prog task
+///
+/// \param  req   POM request
+void Service::enqueue(PomRequest const& req) {
+  if (!xQueueSend(_pom_queue, &req, 0u)) _dcc_service->cvNack();
+}
+
+/// Update client registry
+///
+/// Every datagram refreshes the last-seen timestamp of its client. Unknown
+/// clients get added. Pong frames only refresh WebSocket clients, close frames
+/// drop them right away.
+///
+/// WebSocket clients are identified by their socket descriptor. If a
+/// descriptor shows up with a different peer, the previous session must have
+/// been closed without us noticing and its client gets dropped.
+///
+/// \param  datagram  Datagram
+/// \retval true      Datagram must be executed
+/// \retval false     Datagram has no payload to execute
+bool Service::touch(Datagram const& datagram) {
+  auto const now{xTaskGetTickCount()};
+  auto const ws{datagram.kind != Datagram::Udp};
+  auto const same_fd{[&](Client const& c) {
+    return c.ws == ws && c.sock_fd == datagram.sock_fd;
+  }};
+
+  // Control frames
+  if (datagram.kind == Datagram::Pong) {
+    for (auto& c : _clients | std::views::filter(same_fd)) {
+      c.last_tick = now;
+      c.pinged = false;
+    }
+    return false;
+  } else if (datagram.kind == Datagram::Close) {
+    std::vector<Client> closed;
+    std::ranges::copy_if(_clients, back_inserter(closed), same_fd);
+    for (auto const& c : closed) drop(c);
+    return false;
+  }
+
+  //
+  auto const same_peer{[&](Client const& c) {
+    return c.len == datagram.len && !memcmp(&c.addr, &datagram.addr, c.len);
+  }};
+
+  // Descriptor got reused by another session
+  if (ws) {
+    std::vector<Client> stale;
+    std::ranges::copy_if(_clients, back_inserter(stale), [&](Client const& c) {
+      return same_fd(c) && !same_peer(c);
+    });
+    for (auto const& c : stale) {
+      reaped_clients.fetch_add(1u, std::memory_order_relaxed);
+      drop(c);
+    }
+  }
+
+  //
+  if (auto const it{std::ranges::find_if(
+        _clients,
+        [&](Client const& c) { return same_fd(c) && same_peer(c); })};
+      it != end(_clients)) {
+    it->last_tick = now;
+    it->pinged = false;
+  } else {
+    _clients.push_back({.sock_fd = datagram.sock_fd,
+                        .addr = datagram.addr,
+                        .len = datagram.len,
+                        .last_tick = now,
+                        .ws = ws,
+                        .pinged = false});
+    if (ws) _ws_sock_fds.insert(datagram.sock_fd);
+    active_clients.store(static_cast<uint32_t>(size(_clients)),
+                         std::memory_order_relaxed);
+  }
+
+  return true;
+}
+
+/// Reap clients which went silent
+///
+/// UDP clients are dropped after \ref udp_client_timeout, as required by the
+/// Z21 protocol. WebSocket clients get pinged after \ref ws_ping_interval and
+/// dropped if they haven't answered within \ref ws_client_timeout. Their
+/// session gets closed as well, unless the descriptor already belongs to
+/// another peer.
+void Service::reap() {
+  auto const now{xTaskGetTickCount()};
+  _reap_tick = now;
+
+  //
+  std::vector<Client> silent;
+  for (auto& c : _clients) {
+    auto const idle{now - c.last_tick};
+    if (idle >= pdMS_TO_TICKS(c.ws ? ws_client_timeout : udp_client_timeout))
+      silent.push_back(c);
+    else if (c.ws && !c.pinged && idle >= pdMS_TO_TICKS(ws_ping_interval))
+      c.pinged = intf::http::outbox.ping(c.sock_fd) == ESP_OK;
+  }
+
+  //
+  for (auto const& c : silent) {
+    if (c.ws) {
+      sockaddr_storage addr{};
+      socklen_t len{sizeof(addr)};
+      if (!getpeername(c.sock_fd, std::bit_cast<sockaddr*>(&addr), &len) &&
+          len == c.len && !memcmp(&addr, &c.addr, len)) {
+        intf::http::outbox.erase(c.sock_fd);
+        httpd_sess_trigger_close(intf::http::handle, c.sock_fd);
+      }
+    }
+    LOGI("reap %s client %d", c.ws ? "WebSocket" : "UDP", c.sock_fd);
+    reaped_clients.fetch_add(1u, std::memory_order_relaxed);
+    drop(c);
+  }
+}
+
+/// Drop client
+///
+/// Executes a LAN_LOGOFF on behalf of the client, so that the Z21 server stops
+/// broadcasting to it, and removes it from the client registry.
+///
+/// \param  client  Client
+void Service::drop(Client const& client) {
+  receive({client.sock_fd,
+           std::bit_cast<sockaddr*>(&client.addr),
+           client.len},
+          logoff_dataset);
+  execute();
+  erase(client.sock_fd, &client.addr, client.len);
+}
+
+/// Remove client from registry
+///
+/// \param  sock_fd Socket descriptor
+/// \param  addr    Peer address
+/// \param  len     Peer address length
+void Service::erase(int sock_fd, void const* addr, socklen_t len) {
+  assert(xTaskGetCurrentTaskHandle() == exec_task.handle);
+  auto const n{std::erase_if(_clients, [&](Client const& c) {
+    return c.sock_fd == sock_fd && c.len == len && !memcmp(&c.addr, addr, len);
+  })};
+  if (!n) return;
+  if (std::ranges::none_of(_clients, [sock_fd](Client const& c) {
+        return c.ws && c.sock_fd == sock_fd;
+      }))
+    _ws_sock_fds.erase(sock_fd);
+  active_clients.store(static_cast<uint32_t>(size(_clients)),
+                       std::memory_order_relaxed);
+}
+
+/// Read readable datagrams of a single UDP socket
+///
+/// Reads without blocking until the socket is drained or \ref
+/// max_datagrams_per_socket is reached, so that a chatty client can't starve
+/// the others.
+///
+/// \param  fd  Socket descriptor
+/// \return Number of datagrams read
+size_t Service::receiveUdp(int fd) {
+  std::array<uint8_t, Z21_MAX_PAYLOAD_SIZE> stack;
+  auto n{0uz};
+  for (; n < max_datagrams_per_socket; ++n) {
+    Datagram datagram{.sock_fd = fd,
+                      .addr = {},
+                      .len = sizeof(sockaddr_storage),
+                      .payload = {},
+                      .kind = Datagram::Udp};
+    auto const len{recvfrom(fd,
+                            data(stack),
+                            size(stack) - 1,
+                            MSG_DONTWAIT,
+                            std::bit_cast<sockaddr*>(&datagram.addr),
+                            &datagram.len)};
+    if (len < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        LOGE("recvfrom failed %s", strerror(errno));
+      break;
+    } else if (len > 0) {
+      datagram.payload.assign(cbegin(stack), cbegin(stack) + len);
+      enqueue(std::move(datagram));
+    }
+  }
+  return n;
+}
+
+/// Transmit datasets
+///
+/// Datasets for WebSocket clients are queued as HTTP work right away. Datasets
+/// for UDP clients are handed to the \ref Aggregator, which combines them into
+/// as few datagrams as possible within \ref aggregation_window.
+///
+/// Transmitting means walking the client registry, so this must only ever run
+/// on the exec task. Other tasks have to \ref post "post" their broadcasts.
+///
+/// \param  sock      Client socket
+/// \param  datasets  Datasets
 void Service::transmit(z21::Socket const& sock,
                        std::span<uint8_t const> datasets) {
+  assert(xTaskGetCurrentTaskHandle() == exec_task.handle);
   //
   if (_ws_sock_fds.contains(sock.fd)) {
-    if (auto const err{httpd_queue_work(new intf::http::Message{
-          .sock_fd = sock.fd,
-          .type = HTTPD_WS_TYPE_BINARY,
-          .payload = {cbegin(datasets), cend(datasets)},
-        })})
-      LOGD("httpd_queue_work failed %s", esp_err_to_name(err));
+    if (auto const err{intf::http::outbox.state(
+          sock.fd, datasets, coalesce_key(datasets))})
+      LOGD("outbox state failed %s", esp_err_to_name(err));
   }
-  //
-  else if (sendto(sock.fd,
-                  std::bit_cast<char*>(data(datasets)),
-                  size(datasets),
-                  0,
-                  std::bit_cast<sockaddr*>(&sock.addr),
-                  sock.len) < 0)
+  // New buffer, task must recalculate its select() timeout
+  else if (_aggregator.append(
+             sock, datasets, static_cast<uint64_t>(esp_timer_get_time())))
+    wakeup();
+}
+
+/// Send datagram to UDP client
+///
+/// \param  sock      Client socket
+/// \param  payload   Payload
+void Service::sendTo(z21::Socket const& sock,
+                     std::span<uint8_t const> payload) const {
+  if (::sendto(sock.fd,
+               std::bit_cast<char*>(data(payload)),
+               size(payload),
+               0,
+               std::bit_cast<sockaddr*>(&sock.addr),
+               sock.len) < 0)
     LOGE("sendto failed %s", strerror(errno));
 }
 
@@ -150,38 +545,34 @@ int32_t Service::serialNumber() const {
   return static_cast<int32_t>(little_endian_data2uint32(data(drv::wifi::mac)));
 }
 
-/// \todo document
+/// Client logged off
+///
+/// Gets called for LAN_LOGOFF, no matter whether the client sent it itself or
+/// was reaped.
+///
+/// \param  sock  Client socket
 void Service::logoff(z21::Socket const& sock) {
-  printf("%s\n", __PRETTY_FUNCTION__);
+  erase(sock.fd, &sock.addr, sock.len);
   /// \todo should this broadcast stop? if there are no more clients?
   if (empty(clients())) trackPower(false);
 }
 
 /// \todo document
 [[nodiscard]] z21::SystemState& Service::systemState() {
-  using namespace drv::anlg;
+  auto const snap{telem::snapshot.load()};
 
   auto& sys_state{ServerBase::systemState()};
 
   // Currents
-  if (CurrentMeasurement meas; xQueuePeek(currents_queue.handle, &meas, 0u))
-    sys_state.main_current = sys_state.prog_current = measurement2mA(meas);
-  if (CurrentMeasurement meas;
-      xQueuePeek(filtered_current_queue.handle, &meas, 0u))
-    sys_state.filtered_main_current = measurement2mA(meas);
+  sys_state.main_current = sys_state.prog_current = snap.current;
+  sys_state.filtered_main_current = snap.filtered_current;
 
   // Temperature
-  if (TemperatureQueue::value_type temp;
-      xQueuePeek(temperature_queue.handle, &temp, 0u))
-    sys_state.temperature = temp;
+  sys_state.temperature = snap.temperature;
 
   // Voltages
-  if (SupplyVoltageMeasurement meas;
-      xQueuePeek(supply_voltages_queue.handle, &meas, 0u))
-    sys_state.supply_voltage = measurement2mV(meas).value();
-  if (VccVoltageMeasurement meas;
-      xQueuePeek(vcc_voltages_queue.handle, &meas, 0u))
-    sys_state.vcc_voltage = measurement2mV(meas).value();
+  sys_state.supply_voltage = snap.supply_voltage;
+  sys_state.vcc_voltage = snap.vcc_voltage;
 
   // Central state
   switch (state.load()) {
@@ -297,17 +688,24 @@ bool Service::cvWrite(uint16_t cv_addr, uint8_t byte) {
 
 /// \todo document
 void Service::cvPomRead(uint16_t loco_addr, uint16_t cv_addr) {
-  _dcc_service->cvPomRead(loco_addr, cv_addr);
+  enqueue(PomRequest{
+    .type = PomRequest::LocoRead, .addr = loco_addr, .cv_addr = cv_addr});
 }
 
 /// \todo document
 void Service::cvPomWrite(uint16_t loco_addr, uint16_t cv_addr, uint8_t byte) {
-  _dcc_service->cvPomWrite(loco_addr, cv_addr, byte);
+  enqueue(PomRequest{.type = PomRequest::LocoWrite,
+                     .addr = loco_addr,
+                     .cv_addr = cv_addr,
+                     .byte = byte});
 }
 
 /// \todo document
 void Service::cvPomAccessoryRead(uint16_t accy_addr, uint16_t cv_addr, bool c) {
-  _dcc_service->cvPomAccessoryRead(accy_addr, cv_addr, c);
+  enqueue(PomRequest{.type = PomRequest::AccessoryRead,
+                     .addr = accy_addr,
+                     .cv_addr = cv_addr,
+                     .c = c});
 }
 
 /// \todo document
@@ -315,7 +713,11 @@ void Service::cvPomAccessoryWrite(uint16_t accy_addr,
                                   uint16_t cv_addr,
                                   uint8_t byte,
                                   bool c) {
-  _dcc_service->cvPomAccessoryWrite(accy_addr, cv_addr, byte, c);
+  enqueue(PomRequest{.type = PomRequest::AccessoryWrite,
+                     .addr = accy_addr,
+                     .cv_addr = cv_addr,
+                     .byte = byte,
+                     .c = c});
 }
 
 /// \todo document
@@ -344,14 +746,10 @@ void Service::commonSettings(z21::CommonSettings const& common_settings) {
 
 /// \todo document
 z21::MmDccSettings Service::mmDccSettings() {
-  using namespace drv::anlg;
-
   mem::nvs::Settings nvs;
 
-  decltype(z21::MmDccSettings::output_voltage) voltage{};
-  if (VccVoltageMeasurement meas;
-      xQueuePeek(vcc_voltages_queue.handle, &meas, 0u))
-    voltage = measurement2mV(meas).value();
+  auto const voltage{static_cast<decltype(z21::MmDccSettings::output_voltage)>(
+    telem::snapshot.load().vcc_voltage)};
 
   return {.startup_reset_package_count = nvs.getDccStartupResetPacketCount(),
           .continue_reset_packet_count = nvs.getDccContinueResetPacketCount(),
@@ -15,9 +15,12 @@
 
 #pragma once
 
+#include <lwip/sockets.h>
+#include <functional>
 #include <mutex>
 #include <set>
 #include <z21/z21.hpp>
+#include "aggregator.hpp"
 #include "intf/http/message.hpp"
 
 namespace mw::roco::z21 {
@@ -36,13 +39,24 @@ public:
 
   esp_err_t socket(intf::http::Message& msg);
 
+  void wakeup() const;
+
+  /// Work for the exec task
+  using Work = std::function<void()>;
+  void post(Work work);
+
 private:
   // This gets called by FreeRTOS
   [[noreturn]] void taskFunction(void*);
+  [[noreturn]] void execTaskFunction(void*);
+  [[noreturn]] void progTaskFunction(void*);
+
+  size_t receiveUdp(int fd);
 
   //
   void transmit(z21::Socket const& sock,
                 std::span<uint8_t const> datasets) final;
+  void sendTo(z21::Socket const& sock, std::span<uint8_t const> payload) const;
 
   //
   [[nodiscard]] bool trackPower(bool on) final;
@@ -102,6 +116,52 @@ private:
   ///
   std::set<int> _ws_sock_fds;
 
+  /// Received datagram, waiting for the exec task to pick it up
+  struct Datagram {
+    int sock_fd;
+    sockaddr_storage addr;
+    socklen_t len;
+    intf::http::Payload payload;
+    enum : uint8_t { Udp, WebSocket, Pong, Close } kind;
+  };
+  bool enqueue(Datagram&& datagram);
+  bool touch(Datagram const& datagram);
+
+  /// Client seen by the exec task
+  struct Client {
+    int sock_fd;
+    sockaddr_storage addr;
+    socklen_t len;
+    TickType_t last_tick;
+    bool ws;
+    bool pinged;
+  };
+  void reap();
+  void drop(Client const& client);
+  void erase(int sock_fd, void const* addr, socklen_t len);
+  std::vector<Client> _clients;
+  TickType_t _reap_tick{};
+  std::vector<Datagram> _datagrams;
+  std::vector<Work> _posted;
+  std::mutex _datagrams_mutex;
+
+  /// POM request, waiting for the prog task to pick it up
+  struct PomRequest {
+    enum : uint8_t { LocoRead, LocoWrite, AccessoryRead, AccessoryWrite } type;
+    uint16_t addr;
+    uint16_t cv_addr;
+    uint8_t byte;
+    bool c;
+  };
+  void enqueue(PomRequest const& req);
+  QueueHandle_t _pom_queue{};
+
+  ///
+  Aggregator _aggregator;
+
+  ///
+  int _wakeup_fd{-1};
+
   std::mutex _internal_mutex;
 };
 
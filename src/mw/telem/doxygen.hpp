@@ -0,0 +1,47 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Telemetry documentation
+///
+/// \file   mw/telem/doxygen.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+namespace mw::telem {
+
+/// \page page_mw_telem Telemetry
+/// \details \tableofcontents
+/// This module periodically collects all measurements and statistics which are
+/// of interest to more than one consumer (voltages, currents, temperature,
+/// RSSI, heap) into a single \ref Snapshot. The snapshot is published through a
+/// \ref Seqlock "sequence lock", so readers never block the producer and never
+/// see a partially updated snapshot. Every snapshot carries a version which is
+/// incremented on each update.
+///
+/// \section section_mw_telem_init Initialization
+/// \copydetails init
+///
+/// \section section_mw_telem_task Task
+/// \copydetails task_function
+///
+/// <div class="section_buttons">
+/// | Previous          | Next              |
+/// | :---------------- | ----------------: |
+/// | \ref page_mw_roco | \ref page_mw_zimo |
+/// </div>
+
+} // namespace mw::telem
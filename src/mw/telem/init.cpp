@@ -0,0 +1,36 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Initialize telemetry
+///
+/// \file   mw/telem/init.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "init.hpp"
+#include "task_function.hpp"
+
+namespace mw::telem {
+
+/// Initialize telemetry
+///
+/// Initialization takes place in init(). This function only starts the
+/// telemetry \ref task running \ref task_function().
+esp_err_t init() {
+  task.create(task_function);
+  return ESP_OK;
+}
+
+} // namespace mw::telem
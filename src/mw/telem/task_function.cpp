@@ -0,0 +1,98 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Telemetry task function
+///
+/// \file   mw/telem/task_function.cpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#include "task_function.hpp"
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <algorithm>
+#include "drv/anlg/convert.hpp"
+
+namespace mw::telem {
+
+/// Telemetry task
+///
+/// This task is the only producer of the telemetry \ref snapshot. Every \ref
+/// task "timeout" milliseconds it peeks the analog queues, queries RSSI and
+/// heap statistics and publishes the result with a single store. Consumers
+/// (e.g. \ref page_intf_http, \ref page_mw_roco or \ref page_mw_disp) load the
+/// latest snapshot instead of issuing kernel calls of their own, which keeps
+/// the cost of a request independent of the number of clients.
+///
+/// The time it took to gather the snapshot is measured and published alongside
+/// the data in \ref Snapshot::update_time and \ref Snapshot::max_update_time.
+[[noreturn]] void task_function(void*) {
+  using namespace drv::anlg;
+
+  // RSSI only gets refreshed every n-th update
+  static constexpr auto rssi_divider{10u};
+
+  Snapshot snap{};
+  auto last_wake_tick{xTaskGetTickCount()};
+
+  for (;;) {
+    auto const then{esp_timer_get_time()};
+
+    snap.state = state.load();
+
+    // Voltages
+    if (VccVoltageMeasurement meas;
+        xQueuePeek(vcc_voltages_queue.handle, &meas, 0u))
+      snap.vcc_voltage = measurement2mV(meas).value();
+    if (SupplyVoltageMeasurement meas;
+        xQueuePeek(supply_voltages_queue.handle, &meas, 0u))
+      snap.supply_voltage = measurement2mV(meas).value();
+
+    // Currents
+    if (CurrentMeasurement meas; xQueuePeek(currents_queue.handle, &meas, 0u))
+      snap.current = measurement2mA(meas).value();
+    if (CurrentMeasurement meas;
+        xQueuePeek(filtered_current_queue.handle, &meas, 0u))
+      snap.filtered_current = measurement2mA(meas).value();
+
+    // Temperature
+    if (TemperatureQueue::value_type temp;
+        xQueuePeek(temperature_queue.handle, &temp, 0u))
+      snap.temperature = temp;
+
+    // RSSI changes slowly
+    if (!(snap.version % rssi_divider)) {
+      wifi_ap_record_t ap_record;
+      snap.rssi_valid = esp_wifi_sta_get_ap_info(&ap_record) == ESP_OK;
+      snap.rssi = snap.rssi_valid ? ap_record.rssi : 0;
+    }
+
+    // Heap
+    snap.heap = esp_get_free_heap_size();
+    snap.internal_heap = esp_get_free_internal_heap_size();
+
+    //
+    ++snap.version;
+    snap.update_time = static_cast<uint32_t>(esp_timer_get_time() - then);
+    snap.max_update_time = std::max(snap.max_update_time, snap.update_time);
+    snapshot.store(snap);
+
+    xTaskDelayUntil(&last_wake_tick, pdMS_TO_TICKS(task.timeout));
+  }
+}
+
+} // namespace mw::telem
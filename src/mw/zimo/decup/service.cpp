@@ -17,6 +17,7 @@
 #include <ztl/utility.hpp>
 #include <zusi/zusi.hpp>
 #include "drv/led/bug.hpp"
+#include "intf/http/outbox.hpp"
 #include "log.h"
 #include "utility.hpp"
 
@@ -73,14 +74,19 @@ esp_err_t Service::socket(intf::http::Message& msg, State decup_state) {
 void Service::loop() {
   drv::led::Bug const led_bug{};
 
-  for (;;) {
-    assert(_queue.size());
-    auto const msg{std::move(_queue.front())};
-    _queue.pop();
+  for (auto sock_fd{-1};;) {
+    auto const msg{_queue.pop(std::chrono::milliseconds{task.timeout})};
+    if (!msg) {
+      LOGI("WebSocket timeout");
+      if (auto const err{httpd_sess_trigger_close(sock_fd)})
+        LOGE("httpd_sess_trigger_close failed %s", esp_err_to_name(err));
+      return close();
+    }
+    sock_fd = msg->sock_fd;
 
-    switch (msg.type) {
+    switch (msg->type) {
       case HTTPD_WS_TYPE_BINARY:
-        std::ranges::for_each(msg.payload,
+        std::ranges::for_each(msg->payload,
                               [&](uint8_t byte) { _ack = receive(byte); });
         break;
       case HTTPD_WS_TYPE_CLOSE: LOGI("WebSocket closed"); return close();
@@ -90,24 +96,13 @@ void Service::loop() {
         break;
     }
 
-    if (auto const err{httpd_queue_work(new intf::http::Message{
-          .sock_fd = msg.sock_fd,
-          .type = HTTPD_WS_TYPE_BINARY,
-          .payload =
-            _ack ? std::vector<uint8_t>{*_ack} : std::vector<uint8_t>{},
-        })}) {
-      LOGE("httpd_queue_work failed %s", esp_err_to_name(err));
+    if (auto const err{intf::http::outbox.ack(
+          sock_fd,
+          _ack ? std::span<uint8_t const>{&*_ack, 1uz}
+               : std::span<uint8_t const>{})}) {
+      LOGE("outbox ack failed %s", esp_err_to_name(err));
       return close();
     }
-
-    TickType_t const then{xTaskGetTickCount() + pdMS_TO_TICKS(task.timeout)};
-    while (empty(_queue))
-      if (xTaskGetTickCount() >= then) {
-        LOGI("WebSocket timeout");
-        if (auto const err{httpd_sess_trigger_close(msg.sock_fd)})
-          LOGE("httpd_sess_trigger_close failed %s", esp_err_to_name(err));
-        return close();
-      }
   }
 }
 
@@ -130,7 +125,7 @@ void Service::config(uint8_t) {}
 
 /// \todo document
 void Service::close() {
-  _queue = {};
+  _queue.clear();
   state.store(State::Suspending);
   reset();
 }
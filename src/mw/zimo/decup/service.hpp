@@ -16,8 +16,8 @@
 #pragma once
 
 #include <esp_task.h>
-#include <queue>
 #include <ulf/decup_ein.hpp>
+#include "channel.hpp"
 #include "intf/http/message.hpp"
 
 namespace mw::zimo::decup {
@@ -39,7 +39,7 @@ private:
 
   void close();
 
-  std::queue<intf::http::Message> _queue{};
+  Channel<intf::http::Message> _queue{};
   std::optional<uint8_t> _ack{};
 };
 
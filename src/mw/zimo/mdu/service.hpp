@@ -16,7 +16,7 @@
 #pragma once
 
 #include <esp_task.h>
-#include <queue>
+#include "channel.hpp"
 #include "intf/http/message.hpp"
 
 namespace mw::zimo::mdu {
@@ -35,7 +35,7 @@ private:
   std::array<uint8_t, 2uz> transmit(std::vector<uint8_t> const& payload) const;
   void close();
 
-  std::queue<intf::http::Message> _queue{};
+  Channel<intf::http::Message> _queue{};
   std::array<uint8_t, 2uz> _acks{};
 };
 
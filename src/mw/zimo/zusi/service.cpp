@@ -17,6 +17,7 @@
 #include <ulf/susiv2.hpp>
 #include <ztl/utility.hpp>
 #include "drv/led/bug.hpp"
+#include "intf/http/outbox.hpp"
 #include "log.h"
 #include "utility.hpp"
 
@@ -64,13 +65,18 @@ void Service::loop() {
   drv::led::Bug const led_bug{};
   auto const timeout{http_receive_timeout2ms()};
 
-  for (;;) {
-    assert(_queue.size());
-    auto const msg{std::move(_queue.front())};
-    _queue.pop();
+  for (auto sock_fd{-1};;) {
+    auto const msg{_queue.pop(std::chrono::milliseconds{timeout})};
+    if (!msg) {
+      LOGI("WebSocket timeout");
+      if (auto const err{httpd_sess_trigger_close(sock_fd)})
+        LOGE("httpd_sess_trigger_close failed %s", esp_err_to_name(err));
+      return close();
+    }
+    sock_fd = msg->sock_fd;
 
-    switch (msg.type) {
-      case HTTPD_WS_TYPE_BINARY: _resp = transmit(msg.payload); break;
+    switch (msg->type) {
+      case HTTPD_WS_TYPE_BINARY: _resp = transmit(msg->payload); break;
       case HTTPD_WS_TYPE_CLOSE: LOGI("WebSocket closed"); return close();
       default:
         LOGE("WebSocket packet type neither binary nor close");
@@ -79,23 +85,11 @@ void Service::loop() {
         break;
     }
 
-    if (auto const err{httpd_queue_work(new intf::http::Message{
-          .sock_fd = msg.sock_fd,
-          .type = HTTPD_WS_TYPE_BINARY,
-          .payload = {cbegin(_resp), cend(_resp)},
-        })}) {
-      LOGE("httpd_queue_work failed %s", esp_err_to_name(err));
+    if (auto const err{intf::http::outbox.ack(sock_fd,
+                                              {data(_resp), size(_resp)})}) {
+      LOGE("outbox ack failed %s", esp_err_to_name(err));
       return close();
     }
-
-    TickType_t const then{xTaskGetTickCount() + pdMS_TO_TICKS(timeout)};
-    while (empty(_queue))
-      if (xTaskGetTickCount() >= then) {
-        LOGI("WebSocket timeout");
-        if (auto const err{httpd_sess_trigger_close(msg.sock_fd)})
-          LOGE("httpd_sess_trigger_close failed %s", esp_err_to_name(err));
-        return close();
-      }
   }
 }
 
@@ -122,7 +116,7 @@ Service::transmit(std::vector<uint8_t> const& payload) const {
 
 /// \todo document
 void Service::close() {
-  _queue = {};
+  _queue.clear();
 
   // send exit command... just in case?
   // std::array<uint8_t, 10uz> exit_cmd{};
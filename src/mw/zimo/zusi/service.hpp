@@ -16,8 +16,8 @@
 #pragma once
 
 #include <esp_task.h>
-#include <queue>
 #include <ulf/susiv2.hpp>
+#include "channel.hpp"
 #include "intf/http/message.hpp"
 
 namespace mw::zimo::zusi {
@@ -38,7 +38,7 @@ private:
   void close();
 
   ::ulf::susiv2::Response _resp{};
-  std::queue<intf::http::Message> _queue{};
+  Channel<intf::http::Message> _queue{};
 };
 
 } // namespace mw::zimo::zusi
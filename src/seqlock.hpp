@@ -0,0 +1,102 @@
+// Copyright (C) 2025 Vincent Hamp
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/// Sequence lock
+///
+/// \file   seqlock.hpp
+/// \author Vincent Hamp
+/// \date   19/10/2026
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/// Single writer, multiple reader sequence lock
+///
+/// Seqlock stores a copy of a trivially copyable type which can be read from
+/// any task without ever blocking the writer. Internally two copies are kept
+/// (a so called latch). The lowest bit of the sequence counter selects the copy
+/// readers currently use while the writer updates the other one. A reader only
+/// retries if the sequence counter changed while copying, which implies that
+/// the writer made progress. Contrary to a classic seqlock a reader therefore
+/// never spins on a writer which got preempted in the middle of an update.
+///
+/// The data is stored as relaxed atomic words, so torn reads are well defined
+/// and simply get discarded.
+///
+/// \tparam T Trivially copyable type
+template<typename T>
+  requires(std::is_trivially_copyable_v<T> &&
+           std::is_default_constructible_v<T>)
+class Seqlock {
+  using word_type = uint32_t;
+  static constexpr auto words{(sizeof(T) + sizeof(word_type) - 1uz) /
+                              sizeof(word_type)};
+  using Words = std::array<word_type, words>;
+
+public:
+  constexpr Seqlock() = default;
+
+  /// Store value
+  ///
+  /// \warning Only a single writer is allowed
+  /// \param  value Value
+  void store(T const& value) {
+    Words tmp{};
+    std::memcpy(data(tmp), &value, sizeof(T));
+    auto const seq{_seq.load(std::memory_order_relaxed)};
+    for (auto i{0uz}; i < size(_copies); ++i) {
+      // Redirect readers to the other copy before touching this one
+      _seq.store(seq + i + 1u, std::memory_order_release);
+      std::atomic_thread_fence(std::memory_order_release);
+      auto& copy{_copies[(seq + i) & 1u]};
+      for (auto j{0uz}; j < words; ++j)
+        copy[j].store(tmp[j], std::memory_order_relaxed);
+    }
+  }
+
+  /// Load value
+  ///
+  /// \return Value
+  T load() const {
+    Words tmp;
+    for (;;) {
+      auto const seq{_seq.load(std::memory_order_acquire)};
+      auto const& copy{_copies[seq & 1u]};
+      for (auto j{0uz}; j < words; ++j)
+        tmp[j] = copy[j].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq.load(std::memory_order_relaxed) == seq) break;
+    }
+    T value;
+    std::memcpy(&value, data(tmp), sizeof(T));
+    return value;
+  }
+
+  /// Number of stores
+  ///
+  /// \return Number of stores
+  size_t count() const {
+    return _seq.load(std::memory_order_acquire) / size(_copies);
+  }
+
+private:
+  std::array<std::array<std::atomic<word_type>, words>, 2uz> _copies{};
+  std::atomic<size_t> _seq{};
+};
@@ -72,6 +72,47 @@
     COMMON_TASK_MEMBERS(NAME, PRIORITY, CORE_ID, TIMEOUT)                      \
   } OBJECT
 
+/// Create pool of tasks sharing the same task function
+///
+/// \param  OBJECT      Instance name
+/// \param  NAME        Descriptive name
+/// \param  COUNT       Number of tasks
+/// \param  STACK_SIZE  Stack size in bytes
+/// \param  PRIORITY    Priority
+/// \param  CORE_ID     Core the tasks are pinned to
+/// \param  TIMEOUT     Timeout in ms
+#define TASK_POOL(OBJECT, NAME, COUNT, STACK_SIZE, PRIORITY, CORE_ID, TIMEOUT) \
+  struct CONCAT(TaskPool, __LINE__) {                                          \
+    static constexpr char const* name{NAME};                                   \
+    static constexpr auto count{COUNT};                                        \
+    static constexpr UBaseType_t priority{PRIORITY};                           \
+    static constexpr BaseType_t core_id{CORE_ID};                              \
+    static constexpr TickType_t timeout{TIMEOUT};                              \
+    static inline std::array<std::array<StackType_t, STACK_SIZE>, COUNT>       \
+      stacks{};                                                                \
+    static inline std::array<StaticTask_t, COUNT> tcbs{};                      \
+    static inline TaskFunction_t function{NULL};                               \
+    static inline std::array<TaskHandle_t, COUNT> handles{};                   \
+    static void create(TaskFunction_t f = function) {                          \
+      function = f;                                                            \
+      for (auto i{0uz}; i < count; ++i)                                        \
+        handles[i] = xTaskCreateStaticPinnedToCore(function,                   \
+                                                   name,                       \
+                                                   size(stacks[i]),            \
+                                                   NULL,                       \
+                                                   priority,                   \
+                                                   data(stacks[i]),            \
+                                                   &tcbs[i],                   \
+                                                   core_id);                   \
+    }                                                                          \
+    static void destroy() {                                                    \
+      for (auto& handle : handles) {                                           \
+        vTaskDelete(handle);                                                   \
+        handle = NULL;                                                         \
+      }                                                                        \
+    }                                                                          \
+  } OBJECT
+
 /// Create shared task
 ///
 /// \param  OBJECT      Instance name
@@ -23,6 +23,7 @@
 #include <ArduinoJson.h>
 #include <driver/gpio.h>
 #include <esp_system.h>
+#include <ranges>
 #include "log.h"
 #include "mem/nvs/settings.hpp"
 
@@ -82,6 +83,22 @@ std::optional<dcc::Address> uri2loco_address(std::string_view uri) {
                                            : dcc::Address::ExtendedLoco};
 }
 
+/// Get value of query parameter
+///
+/// \param  uri URI
+/// \param  key Key
+/// \return Value or std::nullopt if key is not part of the query
+std::optional<std::string_view> uri2query(std::string_view uri,
+                                          std::string_view key) {
+  auto const pos{uri.find('?')};
+  if (pos == std::string_view::npos) return std::nullopt;
+  for (auto const param : uri.substr(pos + 1uz) | std::views::split('&'))
+    if (std::string_view const kv{param};
+        kv.starts_with(key) && size(kv) > size(key) && kv[size(key)] == '=')
+      return kv.substr(size(key) + 1uz);
+  return std::nullopt;
+}
+
 /// \warning
 /// Do not use this function in time-critical code. Always cache the value!
 uint32_t http_receive_timeout2ms() {
@@ -62,6 +62,9 @@ std::optional<dcc::Address::value_type> uri2address(std::string_view uri);
 
 std::optional<dcc::Address> uri2loco_address(std::string_view uri);
 
+std::optional<std::string_view> uri2query(std::string_view uri,
+                                          std::string_view key);
+
 /// https://rosettacode.org/wiki/URL_decoding#C
 template<std::output_iterator<char> OutputIt>
 OutputIt decode_uri(std::string_view uri, OutputIt out) {
@@ -158,26 +161,3 @@ template<typename... Ts>
 auto httpd_sess_trigger_close(Ts&&... ts) {
   return httpd_sess_trigger_close(intf::http::handle, std::forward<Ts>(ts)...);
 }
-
-/// \todo document
-inline auto httpd_queue_work(intf::http::Message* msg) {
-  return httpd_queue_work(
-    intf::http::handle,
-    [](void* arg) {
-      auto msg{std::bit_cast<intf::http::Message*>(arg)};
-
-      // Wrap message in httpd_ws_frame_t
-      httpd_ws_frame_t frame{
-        .type = msg->type,
-        .payload = data(msg->payload),
-        .len = size(msg->payload),
-      };
-      if (auto const err{httpd_ws_send_frame_async(
-            intf::http::handle, msg->sock_fd, &frame)})
-        LOGD("httpd_ws_send_frame_async failed %s", esp_err_to_name(err));
-
-      // Delete
-      delete msg;
-    },
-    msg);
-}
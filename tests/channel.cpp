@@ -0,0 +1,64 @@
+#include "channel.hpp"
+#include <gtest/gtest.h>
+#include <array>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(channel, fifo) {
+  Channel<int> channel;
+  for (auto i{0}; i < 10; ++i) channel.push(int{i});
+  EXPECT_EQ(channel.size(), 10uz);
+  for (auto i{0}; i < 10; ++i) EXPECT_EQ(channel.pop(), i);
+  EXPECT_FALSE(channel.pop());
+}
+
+TEST(channel, timeout) {
+  Channel<int> channel;
+  auto const start{std::chrono::steady_clock::now()};
+  EXPECT_FALSE(channel.pop(20ms));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+}
+
+TEST(channel, clear) {
+  Channel<std::string> channel;
+  channel.push("foo");
+  channel.push("bar");
+  channel.clear();
+  EXPECT_EQ(channel.size(), 0uz);
+  EXPECT_FALSE(channel.pop());
+}
+
+TEST(channel, multiple_producers) {
+  constexpr auto n{10'000};
+  Channel<int> channel;
+  std::array<std::thread, 4uz> producers;
+  for (auto& producer : producers)
+    producer = std::thread{[&channel] {
+      for (auto i{0}; i < n; ++i) channel.push(int{i});
+    }};
+
+  auto count{0uz};
+  int64_t sum{};
+  while (auto const value{channel.pop(1s)}) {
+    sum += *value;
+    if (++count == size(producers) * n) break;
+  }
+  for (auto& producer : producers) producer.join();
+
+  EXPECT_EQ(count, size(producers) * n);
+  EXPECT_EQ(sum, static_cast<int64_t>(size(producers)) * n * (n - 1) / 2);
+  EXPECT_FALSE(channel.pop());
+}
+
+TEST(channel, pop_waits_for_late_value) {
+  Channel<int> channel;
+  std::thread producer{[&channel] {
+    std::this_thread::sleep_for(20ms);
+    channel.push(42);
+  }};
+  EXPECT_EQ(channel.pop(1s), 42);
+  producer.join();
+}
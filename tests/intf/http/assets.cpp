@@ -0,0 +1,82 @@
+#include "intf/http/assets.hpp"
+#include <gtest/gtest.h>
+
+using namespace intf::http;
+
+namespace {
+
+constexpr char index_html[]{"index"};
+constexpr char index_html_exit[]{"index exit"};
+constexpr char main_js[]{"main"};
+constexpr char logo_png[]{"logo"};
+
+constexpr std::array<std::array<char const*, 4uz>, 4uz> embeds{{
+  {"main.3f2a9c1d.js", "\"1111\"", main_js, main_js + 4},
+  {"index.html", "\"2222\"", index_html, index_html + 5},
+  {"icons/logo.png", "\"3333\"", logo_png, logo_png + 4},
+  {"index.html_exit", "\"4444\"", index_html_exit, index_html_exit + 10},
+}};
+
+constexpr auto assets{make_assets(embeds)};
+
+} // namespace
+
+TEST(assets, content_type) {
+  EXPECT_STREQ(content_type("main.dart.js"), "text/javascript");
+  EXPECT_STREQ(content_type("manifest.json"), "application/json");
+  EXPECT_STREQ(content_type("canvaskit/canvaskit.wasm"), "application/wasm");
+  EXPECT_STREQ(content_type("icons/Icon-192.png"), "image/png");
+  EXPECT_STREQ(content_type("index.html"), "text/html");
+  EXPECT_STREQ(content_type("NOTICES"), "text/html");
+}
+
+TEST(assets, cache_control) {
+  static_assert(is_hashed("main.3f2a9c1d.js"));
+  static_assert(is_hashed("assets/chunk-DEADBEEF.css"));
+  static_assert(!is_hashed("main.dart.js"));
+  static_assert(!is_hashed("index.html"));
+  static_assert(!is_hashed("deadbeef/index.html"));
+  static_assert(!is_hashed("main.3f2a9c1.js"));
+  EXPECT_STREQ(cache_control("main.3f2a9c1d.js"),
+               "public, max-age=31536000, immutable");
+  EXPECT_STREQ(cache_control("flutter_bootstrap.js"), "no-cache");
+}
+
+TEST(assets, table_is_sorted) {
+  static_assert(std::ranges::is_sorted(assets, {}, &Asset::uri));
+  EXPECT_STREQ(assets[0uz].etag, "\"3333\"");
+  EXPECT_STREQ(assets[0uz].type, "image/png");
+  EXPECT_STREQ(assets[3uz].cache_control,
+               "public, max-age=31536000, immutable");
+}
+
+TEST(assets, find_asset) {
+  auto asset{find_asset(assets, "/index.html")};
+  ASSERT_TRUE(asset);
+  EXPECT_EQ(asset->start, index_html);
+
+  // Variant with exit script is next
+  ++asset;
+  EXPECT_EQ(asset->start, index_html_exit);
+
+  EXPECT_EQ(find_asset(assets, "/main.3f2a9c1d.js?v=1")->start, main_js);
+  EXPECT_EQ(find_asset(assets, "/icons/logo.png#top")->start, logo_png);
+  EXPECT_EQ(find_asset(assets, "icons/logo.png")->start, logo_png);
+  EXPECT_FALSE(find_asset(assets, "/"));
+  EXPECT_FALSE(find_asset(assets, "/index"));
+  EXPECT_FALSE(find_asset(assets, "/logo.png"));
+  EXPECT_FALSE(find_asset(assets, "/zzz"));
+  static_assert(normalize_uri("//index.html?a=b#c") == "index.html");
+}
+
+TEST(assets, etag_match) {
+  EXPECT_TRUE(etag_match(R"("1111")", R"("1111")"));
+  EXPECT_TRUE(etag_match(R"(W/"1111")", R"("1111")"));
+  EXPECT_TRUE(etag_match(R"("0000", "1111")", R"("1111")"));
+  EXPECT_TRUE(etag_match(R"("0000",W/"1111" )", R"("1111")"));
+  EXPECT_TRUE(etag_match("*", R"("1111")"));
+  EXPECT_FALSE(etag_match(R"("0000")", R"("1111")"));
+  EXPECT_FALSE(etag_match(R"(1111)", R"("1111")"));
+  EXPECT_FALSE(etag_match("", R"("1111")"));
+  EXPECT_FALSE(etag_match(" , ", R"("1111")"));
+}
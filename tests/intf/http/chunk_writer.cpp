@@ -0,0 +1,107 @@
+#include "intf/http/chunk_writer.hpp"
+#include <gtest/gtest.h>
+#include "mw/dcc/locos.hpp"
+
+namespace {
+
+mw::dcc::Locos make_locos(size_t n) {
+  mw::dcc::Locos locos;
+  for (auto i{0uz}; i < n; ++i) {
+    mw::dcc::Loco loco;
+    loco.name = "Loco " + std::to_string(i);
+    loco.rvvvvvvv = static_cast<uint8_t>(i);
+    loco.f31_0 = static_cast<uint32_t>(i * 7uz);
+    locos[static_cast<mw::dcc::Locos::key_type>(3uz + i * 11uz)] = loco;
+  }
+  return locos;
+}
+
+std::string serialize_document(mw::dcc::Locos const& locos) {
+  JsonDocument doc;
+  auto array{doc.to<JsonArray>()};
+  for (auto const& [addr, loco] : locos) {
+    auto loco_doc{loco.toJsonDocument()};
+    loco_doc["address"] = addr;
+    array.add(loco_doc);
+  }
+  std::string json;
+  serializeJson(doc, json);
+  return json;
+}
+
+template<size_t N>
+std::vector<std::string> serialize_chunks(mw::dcc::Locos const& locos) {
+  std::vector<std::string> chunks;
+  auto it{cbegin(locos)};
+  EXPECT_TRUE(intf::http::serialize_json_array<N>(
+    [&chunks](std::string_view chunk) {
+      chunks.emplace_back(chunk);
+      return true;
+    },
+    [&]() -> std::optional<JsonDocument> {
+      if (it == cend(locos)) return std::nullopt;
+      auto doc{it->second.toJsonDocument()};
+      doc["address"] = it->first;
+      ++it;
+      return doc;
+    }));
+  return chunks;
+}
+
+} // namespace
+
+TEST(chunk_writer, empty_array) {
+  auto const chunks{serialize_chunks<16uz>({})};
+  ASSERT_EQ(size(chunks), 1uz);
+  EXPECT_EQ(chunks[0uz], "[]");
+}
+
+TEST(chunk_writer, byte_identical_to_document) {
+  for (auto const n : {1uz, 2uz, 50uz}) {
+    auto const locos{make_locos(n)};
+    auto const chunks{serialize_chunks<16uz>(locos)};
+    std::string json;
+    for (auto const& chunk : chunks) {
+      EXPECT_LE(size(chunk), 16uz);
+      EXPECT_FALSE(empty(chunk));
+      json += chunk;
+    }
+    EXPECT_EQ(json, serialize_document(locos));
+  }
+}
+
+TEST(chunk_writer, stop_after_failed_send) {
+  auto const locos{make_locos(50uz)};
+  auto sends{0uz};
+  auto elements{0uz};
+  auto it{cbegin(locos)};
+  EXPECT_FALSE(intf::http::serialize_json_array<16uz>(
+    [&sends](std::string_view) { return ++sends < 3uz; },
+    [&]() -> std::optional<JsonDocument> {
+      if (it == cend(locos)) return std::nullopt;
+      ++elements;
+      return (it++)->second.toJsonDocument();
+    }));
+  EXPECT_EQ(sends, 3uz);
+  EXPECT_LT(elements, size(locos));
+}
+
+TEST(chunk_writer, cached_strings_byte_identical_to_document) {
+  auto const locos{make_locos(50uz)};
+  std::string json;
+  auto it{cbegin(locos)};
+  EXPECT_TRUE(intf::http::serialize_json_array<16uz>(
+    [&json](std::string_view chunk) {
+      json += chunk;
+      return true;
+    },
+    [&]() -> std::optional<std::string> {
+      if (it == cend(locos)) return std::nullopt;
+      auto str{it->second.toJson()};
+      str.pop_back();
+      str += R"(,"address":)" + std::to_string(it->first) + "}";
+      ++it;
+      return str;
+    }));
+  EXPECT_EQ(json, serialize_document(locos));
+}
@@ -1,7 +1,58 @@
 #include "endpoints_test.hpp"
+#include <map>
 
 using namespace testing;
 
+namespace {
+
+// Previous std::map based lookup, only kept as reference
+struct key_compare {
+  bool operator()(httpd_uri_t const& lhs, httpd_uri_t const& rhs) const {
+    if (lhs.method != rhs.method) return lhs.method < rhs.method;
+    else if (auto const lhs_prefix_len{strrchr(lhs.uri, '/') - lhs.uri + 1},
+             rhs_prefix_len{strrchr(rhs.uri, '/') - rhs.uri + 1};
+             lhs_prefix_len == rhs_prefix_len)
+      return strncmp(lhs.uri, rhs.uri, lhs_prefix_len) < 0;
+    else return strcmp(lhs.uri, rhs.uri) < 0;
+  }
+};
+
+// Endpoints subscribed by firmware
+constexpr std::array<httpd_uri_t, 18uz> firmware_endpoints{{
+  {.uri = "/dcc/", .method = HTTP_GET},
+  {.uri = "/dcc/", .method = HTTP_POST},
+  {.uri = "/dcc/locos/", .method = HTTP_DELETE},
+  {.uri = "/dcc/locos/", .method = HTTP_GET},
+  {.uri = "/dcc/locos/", .method = HTTP_PUT},
+  {.uri = "/dcc/turnouts/", .method = HTTP_DELETE},
+  {.uri = "/dcc/turnouts/", .method = HTTP_GET},
+  {.uri = "/dcc/turnouts/", .method = HTTP_PUT},
+  {.uri = "/meter/", .method = HTTP_DELETE},
+  {.uri = "/meter/", .method = HTTP_GET},
+  {.uri = "/settings/", .method = HTTP_GET},
+  {.uri = "/settings/", .method = HTTP_POST},
+  {.uri = "/sys/", .method = HTTP_GET},
+  {.uri = "/zimo/decup/zpp/"},
+  {.uri = "/zimo/decup/zsu/"},
+  {.uri = "/zimo/mdu/zpp/"},
+  {.uri = "/zimo/mdu/zsu/"},
+  {.uri = "/zimo/zusi/"},
+}};
+
+// Requests typically seen by firmware
+constexpr std::array<httpd_uri_t, 8uz> firmware_requests{{
+  {.uri = "/dcc/", .method = HTTP_GET},
+  {.uri = "/dcc/locos/", .method = HTTP_GET},
+  {.uri = "/dcc/locos/3", .method = HTTP_GET},
+  {.uri = "/dcc/locos/?since=42", .method = HTTP_GET},
+  {.uri = "/dcc/turnouts/1024", .method = HTTP_PUT},
+  {.uri = "/sys/", .method = HTTP_GET},
+  {.uri = "/zimo/mdu/zsu/"},
+  {.uri = "/unknown/", .method = HTTP_GET},
+}};
+
+} // namespace
+
 TEST_F(EndpointsTest, uri_without_slash_triggers_assertion) {
   ASSERT_DEATH(subscribe({.uri = "no_slash", .method = HTTP_GET},
                          _subscriber,
@@ -76,3 +127,137 @@ TEST_F(EndpointsTest, different_method_same_uri) {
     syncResponse(&req);
   }
 }
+
+TEST_F(EndpointsTest, admit_up_to_queue_limit) {
+  subscribe({.uri = "/settings/", .method = HTTP_POST},
+            _subscriber,
+            &SubscriberMock::request0);
+  subscribe(
+    {.uri = "/a/", .method = HTTP_GET}, _subscriber, &SubscriberMock::request1);
+
+  // Limit overridden by config
+  httpd_req_t settings{
+    .handle = NULL, .method = HTTP_POST, .uri = "/settings/"};
+  EXPECT_TRUE(admit(&settings));
+  EXPECT_FALSE(admit(&settings));
+  finish(&settings, 10u, 100u);
+  EXPECT_TRUE(admit(&settings));
+  cancel(&settings);
+
+  // Default limit
+  httpd_req_t a{.handle = NULL, .method = HTTP_GET, .uri = "/a/3"};
+  for (auto i{0uz}; i < intf::http::endpoint_queue_limit; ++i)
+    EXPECT_TRUE(admit(&a));
+  EXPECT_FALSE(admit(&a));
+
+  // Unknown endpoints are never limited
+  httpd_req_t b{.handle = NULL, .method = HTTP_GET, .uri = "/b/"};
+  for (auto i{0uz}; i < 2uz * intf::http::endpoint_queue_limit; ++i)
+    EXPECT_TRUE(admit(&b));
+}
+
+TEST_F(EndpointsTest, stats) {
+  subscribe(
+    {.uri = "/a/", .method = HTTP_GET}, _subscriber, &SubscriberMock::request0);
+
+  httpd_req_t req{.handle = NULL, .method = HTTP_GET, .uri = "/a/"};
+  ASSERT_TRUE(admit(&req));
+  ASSERT_TRUE(admit(&req));
+  finish(&req, 10u, 300u);
+  finish(&req, 30u, 100u);
+  ASSERT_TRUE(admit(&req));
+
+  auto n{0uz};
+  visitStats([&](httpd_uri_t const& key, Stats const& stats) {
+    ++n;
+    EXPECT_STREQ(key.uri, "/a/");
+    EXPECT_EQ(stats.requests, 2u);
+    EXPECT_EQ(stats.rejected, 0u);
+    EXPECT_EQ(stats.pending, 1u);
+    EXPECT_EQ(stats.limit, intf::http::endpoint_queue_limit);
+    EXPECT_EQ(stats.wait_us, 40u);
+    EXPECT_EQ(stats.service_us, 400u);
+    EXPECT_EQ(stats.max_wait_us, 30u);
+    EXPECT_EQ(stats.max_service_us, 300u);
+  });
+  EXPECT_EQ(n, 1uz);
+}
+
+TEST_F(EndpointsTest, address_is_parsed_during_routing) {
+  subscribe({.uri = "/dcc/locos/", .method = HTTP_GET},
+            _subscriber,
+            &SubscriberMock::request0);
+
+  for (auto const& [uri, address] :
+       {std::pair{"/dcc/locos/", std::optional<uint16_t>{}},
+        std::pair{"/dcc/locos/3", std::optional<uint16_t>{3u}},
+        std::pair{"/dcc/locos/10239", std::optional<uint16_t>{10239u}},
+        std::pair{"/dcc/locos/3?since=1", std::optional<uint16_t>{3u}},
+        std::pair{"/dcc/locos/?since=1/2", std::optional<uint16_t>{}},
+        std::pair{"/dcc/locos/x4-2", std::optional<uint16_t>{}},
+        std::pair{"/dcc/locos/70000", std::optional<uint16_t>{}}}) {
+    auto const r{route(HTTP_GET, uri)};
+    ASSERT_TRUE(r) << uri;
+    EXPECT_EQ(r->address, address) << uri;
+  }
+
+  EXPECT_CALL(*_subscriber, request0(Field(&intf::http::Request::address,
+                                           Optional(42u))))
+    .Times(Exactly(1));
+  httpd_req_t req{.handle = NULL, .method = HTTP_GET, .uri = "/dcc/locos/42"};
+  syncResponse(&req);
+}
+
+TEST_F(EndpointsTest, unknown_uri_is_not_routed) {
+  subscribe({.uri = "/dcc/locos/", .method = HTTP_GET},
+            _subscriber,
+            &SubscriberMock::request0);
+
+  EXPECT_FALSE(route(HTTP_POST, "/dcc/locos/"));
+  EXPECT_FALSE(route(HTTP_GET, "/dcc/turnouts/"));
+  EXPECT_FALSE(route(HTTP_GET, "/dcc/locos/3/"));
+  EXPECT_FALSE(route(HTTP_GET, "dcc/locos/"));
+
+  // Intermediate nodes are routed but have no subscriber
+  httpd_req_t req{.handle = NULL, .method = HTTP_GET, .uri = "/dcc/"};
+  EXPECT_EQ(syncResponse(&req).error(), "501 Not Implemented");
+}
+
+TEST_F(EndpointsTest, async_fan_out) {
+  auto const other{std::make_shared<SubscriberMock>()};
+  subscribe({.uri = "/a/"}, _subscriber, &SubscriberMock::socket0);
+  subscribe({.uri = "/a/"}, other, &SubscriberMock::socket1);
+
+  // First subscriber moves from message, second still gets the payload
+  EXPECT_CALL(*_subscriber, socket0(_))
+    .WillOnce([](intf::http::Message& msg) {
+      auto const payload{std::move(msg.payload)};
+      EXPECT_EQ(size(payload), 3uz);
+      return ESP_FAIL;
+    });
+  EXPECT_CALL(*other, socket1(_)).WillOnce([](intf::http::Message& msg) {
+    EXPECT_EQ(size(msg.payload), 3uz);
+    return ESP_OK;
+  });
+
+  httpd_req_t req{.handle = NULL, .uri = "/a/"};
+  intf::http::Message msg{.sock_fd = 42, .payload = {1u, 2u, 3u}};
+  EXPECT_EQ(asyncResponse(&req, msg), ESP_FAIL);
+}
+
+TEST_F(EndpointsTest, routing_matches_map_lookup) {
+  std::map<httpd_uri_t, size_t, key_compare> map;
+  for (auto const& key : firmware_endpoints) {
+    map[key] = size(map);
+    if (key.method == HTTP_DELETE && key.uri[1uz] == 'z')
+      subscribe(key, _subscriber, &SubscriberMock::socket0);
+    else subscribe(key, _subscriber, &SubscriberMock::request0);
+  }
+
+  // Route trie finds the same endpoints and addresses
+  for (auto const& key : firmware_requests) {
+    auto const r{route(key.method, key.uri)};
+    ASSERT_EQ(static_cast<bool>(r), map.find(key) != cend(map)) << key.uri;
+    if (r) EXPECT_EQ(r->address, uri2address(key.uri)) << key.uri;
+  }
+}
@@ -0,0 +1,160 @@
+#include "intf/http/gzip.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include "mw/dcc/locos.hpp"
+
+using namespace intf::http;
+
+namespace {
+
+constexpr auto window_size{2048uz};
+
+std::string make_roster_json(size_t n) {
+  std::string json{'['};
+  for (auto i{0uz}; i < n; ++i) {
+    mw::dcc::Loco loco;
+    loco.name = "Loco " + std::to_string(i);
+    loco.rvvvvvvv = static_cast<uint8_t>(i);
+    loco.f31_0 = static_cast<uint32_t>(i * 7uz);
+    auto doc{loco.toJsonDocument()};
+    doc["address"] = 3uz + i * 11uz;
+    if (i) json += ',';
+    serializeJson(doc, json);
+  }
+  return json += ']';
+}
+
+// Compress input fed in pieces of up to max_piece bytes
+std::string compress(std::string_view input, size_t max_piece = SIZE_MAX) {
+  std::string gz;
+  Send const send{[&gz](std::string_view chunk) {
+    gz += chunk;
+    return true;
+  }};
+  GzipWriter<response_chunk_size, window_size> writer{send};
+  std::mt19937 gen{42u};
+  while (!empty(input)) {
+    auto const n{std::min(
+      size(input), std::uniform_int_distribution<size_t>{1uz, max_piece}(gen))};
+    EXPECT_EQ(writer.write(input.substr(0uz, n)), n);
+    input.remove_prefix(n);
+  }
+  EXPECT_TRUE(writer.finish());
+  return gz;
+}
+
+// Minimal gunzip which only understands fixed Huffman blocks
+std::string decompress(std::string_view gz) {
+  static constexpr std::array<uint16_t, 29uz> length_bases{
+    3u,  4u,  5u,  6u,  7u,  8u,  9u,  10u,  11u,  13u,  15u,  17u,  19u,  23u,
+    27u, 31u, 35u, 43u, 51u, 59u, 67u, 83u, 99u, 115u, 131u, 163u, 195u, 227u,
+    258u};
+  static constexpr std::array<uint16_t, 30uz> distance_bases{
+    1u,    2u,    3u,    4u,    5u,    7u,    9u,    13u,   17u,   25u,
+    33u,   49u,   65u,   97u,   129u,  193u,  257u,  385u,  513u,  769u,
+    1025u, 1537u, 2049u, 3073u, 4097u, 6145u, 8193u, 12289u, 16385u, 24577u};
+
+  EXPECT_TRUE(gz.starts_with("\x1F\x8B\x08"));
+  auto bit_pos{10uz * 8uz};
+  auto const bits{[&](size_t n) {
+    uint32_t v{};
+    for (auto i{0uz}; i < n; ++i, ++bit_pos)
+      v |= static_cast<uint32_t>(
+             static_cast<uint8_t>(gz.at(bit_pos / 8uz)) >> bit_pos % 8uz & 1u)
+           << i;
+    return v;
+  }};
+  auto const huffman{[&](uint32_t code, size_t n) {
+    for (auto i{0uz}; i < n; ++i) code = code << 1u | bits(1uz);
+    return code;
+  }};
+  auto const extra{[](size_t i) { return i < 4uz ? 0uz : i / 2uz - 1uz; }};
+
+  std::string out;
+  for (auto final{false}; !final;) {
+    final = bits(1uz);
+    EXPECT_EQ(bits(2uz), 1u);
+    for (;;) {
+      uint32_t sym{};
+      if (auto const code{huffman(0u, 7uz)}; code < 0x18u) sym = 256u + code;
+      else if (auto const code8{huffman(code, 1uz)}; code8 < 0xC0u)
+        sym = code8 - 0x30u;
+      else if (code8 < 0xC8u) sym = 280u + code8 - 0xC0u;
+      else sym = 144u + huffman(code8, 1uz) - 0x190u;
+
+      if (sym < 256u) out += static_cast<char>(sym);
+      else if (sym == 256u) break;
+      else {
+        auto const l{sym - 257u};
+        auto const len{length_bases[l] +
+                       (l < 8u || l == 28u ? 0u : bits((l - 4u) / 4u))};
+        auto const d{huffman(0u, 5uz)};
+        auto const dist{distance_bases[d] + bits(extra(d))};
+        EXPECT_LE(dist, size(out));
+        for (auto i{0uz}; i < len; ++i) out += out[size(out) - dist];
+      }
+    }
+  }
+
+  // Trailer
+  bit_pos = (bit_pos + 7uz) / 8uz * 8uz;
+  auto const crc{bits(32uz)};
+  auto const isize{bits(32uz)};
+  EXPECT_EQ(bit_pos / 8uz, size(gz));
+  EXPECT_EQ(crc,
+            crc32(0u, std::bit_cast<uint8_t const*>(data(out)), size(out)));
+  EXPECT_EQ(isize, size(out));
+  return out;
+}
+
+} // namespace
+
+TEST(gzip, crc32) {
+  std::string_view const str{"123456789"};
+  EXPECT_EQ(crc32(0u, std::bit_cast<uint8_t const*>(data(str)), size(str)),
+            0xCBF4'3926u);
+}
+
+TEST(gzip, accepts_gzip) {
+  EXPECT_TRUE(accepts_gzip("gzip"));
+  EXPECT_TRUE(accepts_gzip("gzip, deflate, br"));
+  EXPECT_TRUE(accepts_gzip("deflate, gzip;q=0.5"));
+  EXPECT_TRUE(accepts_gzip("*"));
+  EXPECT_TRUE(accepts_gzip("br;q=1.0, x-gzip"));
+  EXPECT_TRUE(accepts_gzip("gzip;q=0.01"));
+  EXPECT_FALSE(accepts_gzip(""));
+  EXPECT_FALSE(accepts_gzip("identity"));
+  EXPECT_FALSE(accepts_gzip("deflate, br"));
+  EXPECT_FALSE(accepts_gzip("gzip;q=0"));
+  EXPECT_FALSE(accepts_gzip("gzip; q=0.000"));
+}
+
+TEST(gzip, round_trip) {
+  std::mt19937 gen{1u};
+  std::string random(10000uz, '\0');
+  std::ranges::generate(random, [&] { return static_cast<char>(gen()); });
+
+  for (auto const& input : {std::string{},
+                            std::string{"a"},
+                            std::string(100000uz, 'x'),
+                            random,
+                            make_roster_json(100uz)})
+    for (auto const max_piece : {1uz, 100uz, SIZE_MAX})
+      EXPECT_EQ(decompress(compress(input, max_piece)), input);
+}
+
+TEST(gzip, send_failure) {
+  auto const json{make_roster_json(100uz)};
+  Send const send{[](std::string_view) { return false; }};
+  GzipWriter<response_chunk_size, window_size> writer{send};
+  EXPECT_EQ(writer.write(json), 0uz);
+  EXPECT_FALSE(writer.ok());
+  EXPECT_FALSE(writer.finish());
+}
+
+TEST(gzip, roster) {
+  auto const json{make_roster_json(1000uz)};
+  auto const gz{compress(json)};
+  EXPECT_EQ(decompress(gz), json);
+  EXPECT_LT(size(gz) * 5uz, size(json));
+}
@@ -0,0 +1,107 @@
+#include "intf/http/message.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(message_pool, acquire_until_exhausted) {
+  intf::http::MessagePool<4uz> pool{64uz};
+  std::array<intf::http::Message*, 4uz> msgs{};
+  for (auto& msg : msgs) {
+    msg = pool.acquire();
+    ASSERT_NE(msg, nullptr);
+    EXPECT_GE(msg->payload.capacity(), 64uz);
+  }
+  EXPECT_EQ(pool.used(), 4uz);
+  EXPECT_EQ(pool.acquire(), nullptr);
+  EXPECT_EQ(pool.drops(), 1u);
+
+  pool.release(msgs[2uz]);
+  EXPECT_EQ(pool.used(), 3uz);
+  EXPECT_EQ(pool.acquire(), msgs[2uz]);
+}
+
+TEST(message_pool, release_keeps_capacity) {
+  intf::http::MessagePool<1uz> pool{8uz};
+  auto msg{pool.acquire()};
+  msg->payload.assign(256uz, 0xAAu);
+  auto const capacity{msg->payload.capacity()};
+  pool.release(msg);
+
+  msg = pool.acquire();
+  EXPECT_TRUE(empty(msg->payload));
+  EXPECT_EQ(msg->payload.capacity(), capacity);
+}
+
+TEST(message_pool, concurrent_acquire_release) {
+  intf::http::MessagePool<32uz> pool{8uz};
+  auto const f{[&pool] {
+    for (auto i{0uz}; i < 10'000uz; ++i)
+      if (auto msg{pool.acquire()}) {
+        msg->payload.push_back(static_cast<uint8_t>(i));
+        ASSERT_EQ(size(msg->payload), 1uz);
+        pool.release(msg);
+      }
+  }};
+  std::thread t0{f}, t1{f}, t2{f};
+  t0.join();
+  t1.join();
+  t2.join();
+  EXPECT_EQ(pool.used(), 0uz);
+}
+
+TEST(payload_pool, reuse_released_storage) {
+  intf::http::PayloadPool pool{2uz};
+  uint8_t const* storage{};
+  {
+    auto payload{pool.acquire(1000uz)};
+    EXPECT_EQ(size(payload), 1000uz);
+    storage = data(payload);
+  }
+  EXPECT_EQ(pool.misses(), 1u);
+
+  // Storage comes back with its capacity
+  auto payload{pool.acquire(100uz)};
+  EXPECT_EQ(size(payload), 100uz);
+  EXPECT_EQ(data(payload), storage);
+  EXPECT_EQ(pool.misses(), 1u);
+}
+
+TEST(payload_pool, copies_and_moves_stay_pooled) {
+  intf::http::PayloadPool pool{4uz};
+  for (auto i{0uz}; i < 100uz; ++i) {
+    intf::http::Message msg{.sock_fd = 42,
+                            .type = HTTPD_WS_TYPE_BINARY,
+                            .payload = pool.acquire(64uz)};
+    intf::http::Message cpy{msg};
+    EXPECT_EQ(cpy.payload, msg.payload);
+    auto moved{std::move(msg)};
+    intf::http::Payload assigned;
+    assigned = std::move(cpy.payload);
+  }
+  EXPECT_EQ(pool.misses(), 2u);
+}
+
+TEST(payload_pool, keep_at_most_n) {
+  intf::http::PayloadPool pool{1uz};
+  {
+    auto a{pool.acquire(8uz)};
+    auto b{pool.acquire(8uz)};
+  }
+  EXPECT_EQ(pool.misses(), 2u);
+  auto a{pool.acquire(8uz)};
+  auto b{pool.acquire(8uz)};
+  EXPECT_EQ(pool.misses(), 3u);
+}
+
+TEST(payload_pool, free_oversized_storage) {
+  intf::http::PayloadPool pool{2uz, 1024uz};
+  { auto large{pool.acquire(4096uz)}; }
+  EXPECT_EQ(pool.misses(), 1u);
+
+  // Oversized storage wasn't kept
+  { auto small{pool.acquire(64uz)}; }
+  EXPECT_EQ(pool.misses(), 2u);
+
+  // Storage within maximum capacity is
+  auto small{pool.acquire(64uz)};
+  EXPECT_EQ(pool.misses(), 2u);
+}
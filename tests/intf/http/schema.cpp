@@ -0,0 +1,131 @@
+#include "intf/http/schema.hpp"
+#include <gtest/gtest.h>
+#include "intf/http/sta/settings.hpp"
+#include "utility.hpp"
+
+using namespace intf::http;
+using intf::http::sta::settings_schema;
+
+namespace {
+
+constexpr std::string_view settings_json{
+  R"({"sta_mdns":"remise","sta_ssid":"Home","sta_pass":"secret","sta_alt_ssid":"","sta_alt_pass":"","sta_ip":"","sta_netmask":"","sta_gateway":"","http_rx_timeout":30,"http_tx_timeout":30,"http_exit_msg":true,"cur_lim":3,"cur_lim_serv":1,"cur_sc_time":100,"led_dc_bug":5,"led_dc_wifi":50,"dcc_preamble":17,"dcc_bit1_dur":58,"dcc_bit0_dur":100,"dcc_bidibit_dur":60,"dcc_prog_type":3,"dcc_strtp_rs_pc":25,"dcc_cntn_rs_pc":6,"dcc_prog_pc":7,"dcc_verify_bit1":true,"dcc_ack_cur":50,"dcc_loco_flags":130,"dcc_accy_flags":4,"dcc_accy_swtime":20,"dcc_accy_pc":2,"ext_flags":0})"};
+
+} // namespace
+
+TEST(schema, parse_json_status) {
+  EXPECT_TRUE(parse_json(R"({"a":1})"));
+  EXPECT_EQ(parse_json(R"({"a":1:)").error(), "415 Unsupported Media Type");
+  EXPECT_EQ(parse_json("").error(), "415 Unsupported Media Type");
+}
+
+TEST(schema, bind_settings) {
+  auto const doc{parse_json(settings_json)};
+  ASSERT_TRUE(doc);
+  auto const settings{bind_json(*doc, settings_schema)};
+  ASSERT_TRUE(settings);
+  EXPECT_EQ(settings->sta_mdns, "remise");
+  EXPECT_EQ(settings->sta_ssid, "Home");
+  EXPECT_EQ(settings->sta_ip, "");
+  EXPECT_EQ(settings->http_rx_timeout, 30u);
+  EXPECT_EQ(settings->http_exit_msg, true);
+  EXPECT_EQ(settings->cur_lim, 3u);
+  EXPECT_EQ(settings->dcc_loco_flags, 130u);
+  EXPECT_EQ(settings->ext_flags, 0u);
+}
+
+TEST(schema, bind_missing_and_unknown_members) {
+  auto const doc{parse_json(R"({"led_dc_bug":5,"unknown":[1,2,3]})")};
+  ASSERT_TRUE(doc);
+  auto const settings{bind_json(*doc, settings_schema)};
+  ASSERT_TRUE(settings);
+  EXPECT_EQ(settings->led_dc_bug, 5u);
+  EXPECT_FALSE(settings->led_dc_wifi);
+  EXPECT_FALSE(settings->sta_mdns);
+}
+
+TEST(schema, bind_rejects_out_of_range) {
+  for (auto const json : {R"({"http_rx_timeout":4})",
+                          R"({"http_rx_timeout":61})",
+                          R"({"http_rx_timeout":-30})",
+                          R"({"http_rx_timeout":300})"}) {
+    auto const doc{parse_json(json)};
+    ASSERT_TRUE(doc);
+    auto const settings{bind_json(*doc, settings_schema)};
+    ASSERT_FALSE(settings) << json;
+    EXPECT_EQ(settings.error(), "http_rx_timeout");
+  }
+
+  auto const doc{
+    parse_json(R"({"sta_ssid":"0123456789abcdef0123456789abcdefX"})")};
+  ASSERT_TRUE(doc);
+  EXPECT_EQ(bind_json(*doc, settings_schema).error(), "sta_ssid");
+}
+
+TEST(schema, bind_rejects_wrong_type) {
+  for (auto const [json, key] :
+       {std::pair{R"({"led_dc_bug":"5"})", "led_dc_bug"},
+        std::pair{R"({"led_dc_bug":5.5})", "led_dc_bug"},
+        std::pair{R"({"http_exit_msg":1})", "http_exit_msg"},
+        std::pair{R"({"sta_mdns":42})", "sta_mdns"}}) {
+    auto const doc{parse_json(json)};
+    ASSERT_TRUE(doc);
+    auto const settings{bind_json(*doc, settings_schema)};
+    ASSERT_FALSE(settings) << json;
+    EXPECT_EQ(settings.error(), key);
+  }
+
+  // Not an object at all
+  auto const doc{parse_json("[1,2,3]")};
+  ASSERT_TRUE(doc);
+  auto const settings{bind_json(*doc, settings_schema)};
+  ASSERT_FALSE(settings);
+  EXPECT_TRUE(empty(settings.error()));
+}
+
+TEST(schema, bind_rejects_bidi_bit_duration_gap) {
+  for (auto const value : {0u, 57u, 61u}) {
+    auto const json{R"({"dcc_bidibit_dur":)" + std::to_string(value) + "}"};
+    auto const doc{parse_json(json)};
+    ASSERT_TRUE(doc);
+    auto const settings{bind_json(*doc, settings_schema)};
+    ASSERT_TRUE(settings) << json;
+    EXPECT_EQ(settings->dcc_bidibit_dur, value);
+  }
+
+  for (auto const value : {1u, 30u, 56u, 62u}) {
+    auto const json{R"({"dcc_bidibit_dur":)" + std::to_string(value) + "}"};
+    auto const doc{parse_json(json)};
+    ASSERT_TRUE(doc);
+    auto const settings{bind_json(*doc, settings_schema)};
+    ASSERT_FALSE(settings) << json;
+    EXPECT_EQ(settings.error(), "dcc_bidibit_dur");
+  }
+}
+
+TEST(schema, bind_rejects_mdns_without_suffix) {
+  for (auto const json : {R"({"sta_mdns":"remise"})",
+                          R"({"sta_mdns":"wulf-remise"})"}) {
+    auto const doc{parse_json(json)};
+    ASSERT_TRUE(doc);
+    EXPECT_TRUE(bind_json(*doc, settings_schema)) << json;
+  }
+
+  for (auto const json : {R"({"sta_mdns":""})",
+                          R"({"sta_mdns":"wulf"})",
+                          R"({"sta_mdns":"remise-wulf"})"}) {
+    auto const doc{parse_json(json)};
+    ASSERT_TRUE(doc);
+    auto const settings{bind_json(*doc, settings_schema)};
+    ASSERT_FALSE(settings) << json;
+    EXPECT_EQ(settings.error(), "sta_mdns");
+  }
+}
+
+TEST(schema, settings_json_covers_schema) {
+  ASSERT_TRUE(validate_json(settings_json));
+  JsonDocument doc;
+  ASSERT_FALSE(deserializeJson(doc, settings_json));
+  for (auto const& f : settings_schema)
+    EXPECT_FALSE(JsonVariantConst{doc[f.key]}.isNull()) << f.key;
+}
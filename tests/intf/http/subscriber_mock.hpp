@@ -7,4 +7,6 @@
 struct SubscriberMock {
   MOCK_METHOD(intf::http::Response, request0, (intf::http::Request const&));
   MOCK_METHOD(intf::http::Response, request1, (intf::http::Request const&));
+  MOCK_METHOD(esp_err_t, socket0, (intf::http::Message&));
+  MOCK_METHOD(esp_err_t, socket1, (intf::http::Message&));
 };
@@ -0,0 +1,207 @@
+#include "mw/dcc/bulk.hpp"
+#include <nvs.h>
+#include <map>
+#include <set>
+#include "dcc_test.hpp"
+#include "mw/dcc/locos.hpp"
+#include "mw/dcc/turnouts.hpp"
+
+namespace {
+
+std::string make_locos_json(size_t n) {
+  JsonDocument doc;
+  JsonArray arr{doc.to<JsonArray>()};
+  for (auto i{0uz}; i < n; ++i) {
+    JsonObject obj{arr.add<JsonObject>()};
+    obj["address"] = 1uz + i;
+    obj["name"] = "Loco " + std::to_string(i);
+    obj["speed_steps"] = z21::LocoInfo::DCC128;
+    obj["f31_0"] = i;
+  }
+  std::string json;
+  serializeJson(doc, json);
+  return json;
+}
+
+std::string make_turnouts_json(size_t n) {
+  JsonDocument doc;
+  JsonArray arr{doc.to<JsonArray>()};
+  for (auto i{0uz}; i < n; ++i) {
+    JsonObject obj{arr.add<JsonObject>()};
+    obj["address"] = 1uz + i;
+    obj["name"] = "Turnout " + std::to_string(i);
+    obj["type"] = mw::dcc::Turnout::TurnoutLeft;
+    obj["group"]["addresses"].add(1uz + i);
+  }
+  std::string json;
+  serializeJson(doc, json);
+  return json;
+}
+
+// Parse JSON and apply it
+template<typename T>
+void bulk_put(T& map,
+              std::string const& json,
+              size_t& applied,
+              size_t& errors) {
+  JsonDocument doc;
+  EXPECT_FALSE(deserializeJson(doc, json));
+  errors = size(mw::dcc::bulk_put(
+    map, doc.as<JsonArrayConst>(), [&](size_t, auto, auto&) { ++applied; }));
+}
+
+// Counts commits and fails writes of chosen addresses
+struct FakeNvs {
+  ~FakeNvs() { ++commits; }
+
+  esp_err_t set(mw::dcc::Address::value_type addr, mw::dcc::Loco const& loco) {
+    if (fail.contains(addr)) return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    written[addr] = loco.name;
+    return ESP_OK;
+  }
+
+  static inline size_t commits{};
+  std::set<mw::dcc::Address::value_type> fail;
+  std::map<mw::dcc::Address::value_type, std::string> written;
+};
+
+} // namespace
+
+using mw::dcc::BulkError;
+
+TEST_F(DccTest, bulk_put_1000_locos) {
+  auto const json{make_locos_json(1000uz)};
+  mw::dcc::Locos locos;
+  size_t applied{}, errors{};
+  bulk_put(locos, json, applied, errors);
+
+  EXPECT_EQ(applied, 1000uz);
+  EXPECT_EQ(errors, 0uz);
+  ASSERT_EQ(size(locos), 1000uz);
+  EXPECT_EQ(locos[1u].name, "Loco 0");
+  EXPECT_EQ(locos[1000u].name, "Loco 999");
+  EXPECT_EQ(locos[1000u].speed_steps, z21::LocoInfo::DCC128);
+  EXPECT_EQ(locos[1000u].f31_0, 999u);
+}
+
+TEST_F(DccTest, bulk_put_1000_turnouts) {
+  auto const json{make_turnouts_json(1000uz)};
+  mw::dcc::Turnouts turnouts;
+  size_t applied{}, errors{};
+  bulk_put(turnouts, json, applied, errors);
+
+  EXPECT_EQ(applied, 1000uz);
+  EXPECT_EQ(errors, 0uz);
+  ASSERT_EQ(size(turnouts), 1000uz);
+  EXPECT_EQ(turnouts[500u].name, "Turnout 499");
+  EXPECT_EQ(turnouts[500u].type, mw::dcc::Turnout::TurnoutLeft);
+  EXPECT_EQ(turnouts[500u].group.addresses,
+            std::vector<mw::dcc::Address::value_type>{500u});
+}
+
+TEST_F(DccTest, bulk_put_updates_existing) {
+  mw::dcc::Locos locos;
+  locos[3u].name = "BR85";
+  locos[3u].f31_0 = 10u;
+  auto const& cached{locos[3u].toJson()};
+  EXPECT_FALSE(empty(cached));
+
+  JsonDocument doc;
+  deserializeJson(doc, R"([{"address":3,"name":"Reihe 2190"}])");
+  auto const errors{
+    mw::dcc::bulk_put(locos, doc.as<JsonArrayConst>(), [](auto...) {})};
+
+  EXPECT_TRUE(empty(errors));
+  ASSERT_EQ(size(locos), 1uz);
+  EXPECT_EQ(locos[3u].name, "Reihe 2190");
+  EXPECT_EQ(locos[3u].f31_0, 10u);
+  EXPECT_TRUE(locos[3u].toJson().contains("Reihe 2190"));
+}
+
+TEST_F(DccTest, bulk_put_reports_errors) {
+  mw::dcc::Locos locos;
+  JsonDocument doc;
+  deserializeJson(
+    doc,
+    R"([{"address":3},42,{"name":"BR85"},{"address":0},{"address":70000},{"address":5}])");
+  std::vector<size_t> indices;
+  auto const errors{mw::dcc::bulk_put(
+    locos, doc.as<JsonArrayConst>(), [&](size_t i, auto addr, auto&) {
+      indices.push_back(i);
+      EXPECT_TRUE(addr == 3u || addr == 5u);
+    })};
+
+  EXPECT_EQ(indices, (std::vector<size_t>{0uz, 5uz}));
+  ASSERT_EQ(size(errors), 4uz);
+  EXPECT_EQ(errors[0uz].index, 1uz);
+  EXPECT_EQ(errors[0uz].error, "Not an object");
+  EXPECT_EQ(errors[1uz].index, 2uz);
+  EXPECT_EQ(errors[1uz].error, "Invalid address");
+  EXPECT_EQ(errors[2uz].index, 3uz);
+  EXPECT_EQ(errors[3uz].index, 4uz);
+  EXPECT_EQ(size(locos), 2uz);
+  EXPECT_TRUE(locos.contains(3u));
+  EXPECT_TRUE(locos.contains(5u));
+}
+
+TEST_F(DccTest, bulk_put_persists_with_single_commit) {
+  mw::dcc::Locos locos;
+  locos[3u].name = "BR85";
+  locos[3u].revision = 7u;
+  JsonDocument doc;
+  deserializeJson(
+    doc,
+    R"([{"address":3,"name":"Reihe 2190"},42,{"address":4,"name":"BR 218"}])");
+
+  FakeNvs::commits = 0uz;
+  std::vector<BulkError> errors;
+  {
+    FakeNvs nvs;
+    errors = mw::dcc::bulk_put(
+      nvs, locos, doc.as<JsonArrayConst>(), [](size_t, auto, auto& loco) {
+        ++loco.revision;
+      });
+    EXPECT_EQ(nvs.written,
+              (std::map<mw::dcc::Address::value_type, std::string>{
+                {3u, "Reihe 2190"}, {4u, "BR 218"}}));
+  }
+  EXPECT_EQ(FakeNvs::commits, 1uz);
+
+  ASSERT_EQ(size(errors), 1uz);
+  EXPECT_EQ(errors[0uz].index, 1uz);
+  EXPECT_EQ(locos[3u].name, "Reihe 2190");
+  EXPECT_EQ(locos[3u].revision, 8u);
+  EXPECT_EQ(locos[4u].name, "BR 218");
+}
+
+TEST_F(DccTest, bulk_put_rolls_back_failed_writes) {
+  mw::dcc::Locos locos;
+  locos[3u].name = "BR85";
+  locos[3u].revision = 7u;
+  JsonDocument doc;
+  deserializeJson(doc,
+                  R"([{"address":3,"name":"Reihe 2190"},{"address":4},)"
+                  R"({"address":5,"name":"BR 218"}])");
+
+  FakeNvs nvs;
+  nvs.fail = {3u, 4u};
+  auto const errors{mw::dcc::bulk_put(
+    nvs, locos, doc.as<JsonArrayConst>(), [](size_t, auto, auto& loco) {
+      ++loco.revision;
+    })};
+
+  ASSERT_EQ(size(errors), 2uz);
+  EXPECT_EQ(errors[0uz].index, 0uz);
+  EXPECT_EQ(errors[0uz].error, esp_err_to_name(ESP_ERR_NVS_NOT_ENOUGH_SPACE));
+  EXPECT_EQ(errors[1uz].index, 1uz);
+
+  // Existing entry restored, inserted entry removed
+  ASSERT_EQ(size(locos), 2uz);
+  EXPECT_EQ(locos[3u].name, "BR85");
+  EXPECT_EQ(locos[3u].revision, 7u);
+  EXPECT_FALSE(locos.contains(4u));
+  EXPECT_EQ(locos[5u].name, "BR 218");
+  EXPECT_EQ(nvs.written,
+            (std::map<mw::dcc::Address::value_type, std::string>{
+              {5u, "BR 218"}}));
+}
@@ -51,3 +51,25 @@ TEST_F(DccTest, json_to_loco) {
   EXPECT_EQ(loco.f31_0, 10u);
   EXPECT_EQ(loco.bidi.error_counter, 1u);
 }
+
+TEST_F(DccTest, loco_to_json_cached) {
+  mw::dcc::Loco loco;
+  loco.name = "Reihe 2190";
+  auto const& json{loco.toJson()};
+  EXPECT_EQ(
+    json,
+    R"({"name":"Reihe 2190","mode":0,"speed_steps":4,"rvvvvvvv":0,"f31_0":0,"bidi":{"receive_counter":0,"error_counter":0,"options":0,"speed":0,"qos":0}})");
+
+  // Cache stays valid until invalidated
+  loco.f31_0 = 10u;
+  EXPECT_EQ(&loco.toJson(), &json);
+  EXPECT_TRUE(json.contains(R"("f31_0":0)"));
+  loco.invalidate();
+  EXPECT_TRUE(loco.toJson().contains(R"("f31_0":10)"));
+
+  // Deserialization invalidates
+  JsonDocument doc;
+  deserializeJson(doc, R"({"name":"BR85"})");
+  loco.fromJsonDocument(doc);
+  EXPECT_TRUE(loco.toJson().starts_with(R"({"name":"BR85")"));
+}
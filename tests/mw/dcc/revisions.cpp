@@ -0,0 +1,72 @@
+#include "mw/dcc/revisions.hpp"
+#include <gtest/gtest.h>
+
+using namespace mw::dcc;
+
+namespace {
+
+// Boots the service, reserved revisions survive reboots like NVS would
+struct Boot {
+  explicit Boot(uint32_t& nvs)
+    : revisions{nvs, [&nvs](uint32_t reserved) { nvs = reserved; }},
+      floor{revisions.next()} {}
+
+  Revisions revisions;
+  uint32_t floor;
+};
+
+} // namespace
+
+TEST(revisions, reserve_before_use) {
+  uint32_t nvs{};
+  Boot boot{nvs};
+  EXPECT_EQ(boot.floor, 1u);
+  EXPECT_EQ(nvs, revision_block);
+  for (auto i{boot.floor}; i < revision_block; ++i)
+    EXPECT_LE(boot.revisions.next(), nvs);
+  EXPECT_EQ(nvs, revision_block);
+  EXPECT_EQ(boot.revisions.next(), revision_block + 1u);
+  EXPECT_EQ(nvs, 2u * revision_block);
+}
+
+TEST(revisions, stale_since_after_restart) {
+  uint32_t nvs{};
+
+  // First boot, client synchronizes a few changes
+  uint32_t since{};
+  {
+    Boot boot{nvs};
+    for (auto i{0uz}; i < 10uz; ++i) boot.revisions.next();
+    since = boot.revisions.current();
+    EXPECT_FALSE(full_reload(since, boot.floor, boot.revisions.current()));
+  }
+
+  // Second boot, client still knows revision of first boot
+  Boot boot{nvs};
+  EXPECT_TRUE(full_reload(since, boot.floor, boot.revisions.current()));
+
+  // Even after the second boot made more changes than the first one
+  for (auto i{0uz}; i < 100uz; ++i) boot.revisions.next();
+  EXPECT_GT(boot.revisions.current(), since);
+  EXPECT_TRUE(full_reload(since, boot.floor, boot.revisions.current()));
+
+  // Client got reloaded and only needs deltas from now on
+  since = boot.revisions.current();
+  boot.revisions.next();
+  EXPECT_FALSE(full_reload(since, boot.floor, boot.revisions.current()));
+}
+
+TEST(revisions, stale_since_after_exhausted_block) {
+  uint32_t nvs{};
+
+  uint32_t since{};
+  {
+    Boot boot{nvs};
+    for (auto i{0u}; i < revision_block + 10u; ++i) boot.revisions.next();
+    since = boot.revisions.current();
+  }
+
+  Boot boot{nvs};
+  EXPECT_GT(boot.floor, since);
+  EXPECT_TRUE(full_reload(since, boot.floor, boot.revisions.current()));
+}
@@ -39,3 +39,19 @@ TEST_F(DccTest, json_to_turnout) {
       {z21::TurnoutInfo::Position::P1, z21::TurnoutInfo::Position::P0},
       {z21::TurnoutInfo::Position::P1, z21::TurnoutInfo::Position::P1}}));
 }
+
+TEST_F(DccTest, turnout_to_json_cached) {
+  mw::dcc::Turnout turnout;
+  turnout.name = "North";
+  turnout.group.addresses = {13u};
+  std::string expected;
+  serializeJson(turnout.toJsonDocument(), expected);
+  EXPECT_EQ(turnout.toJson(), expected);
+
+  //
+  turnout.position = z21::TurnoutInfo::Position::P1;
+  EXPECT_EQ(turnout.toJson(), expected);
+  turnout.invalidate();
+  EXPECT_NE(turnout.toJson(), expected);
+  EXPECT_TRUE(turnout.toJson().contains(R"("position":2)"));
+}
@@ -0,0 +1,214 @@
+#include "mw/frontend/tar.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+using mw::frontend::safe_path;
+using mw::frontend::TarReader;
+using namespace std::literals;
+
+namespace {
+
+// Append ustar header and data of a single entry
+void append_entry(std::vector<uint8_t>& tar,
+                  std::string_view path,
+                  std::string_view content,
+                  char type = '0',
+                  std::string_view prefix = {}) {
+  std::array<char, 512uz> header{};
+  std::ranges::copy(path, begin(header));
+  std::snprintf(&header[100uz], 8uz, "%07o", 0644u);
+  std::snprintf(&header[124uz], 12uz, "%011zo", size(content));
+  std::ranges::fill_n(&header[148uz], 8uz, ' ');
+  header[156uz] = type;
+  std::ranges::copy("ustar"sv, &header[257uz]);
+  std::ranges::copy("00"sv, &header[263uz]);
+  std::ranges::copy(prefix, &header[345uz]);
+  uint32_t sum{};
+  for (auto const c : header) sum += static_cast<uint8_t>(c);
+  std::snprintf(&header[148uz], 8uz, "%06o", sum);
+  tar.insert(cend(tar), cbegin(header), cend(header));
+  tar.insert(cend(tar), cbegin(content), cend(content));
+  tar.resize((size(tar) + 511uz) / 512uz * 512uz);
+}
+
+// Format pax extended header record, length includes itself
+std::string pax_record(std::string_view key, std::string_view value) {
+  auto const n{size(key) + size(value) + 3uz};
+  auto len{n + std::to_string(n).size()};
+  len = n + std::to_string(len).size();
+  return std::to_string(len) + ' ' + std::string{key} + '=' +
+         std::string{value} + '\n';
+}
+
+// Append end-of-archive marker
+void append_end(std::vector<uint8_t>& tar) { tar.resize(size(tar) + 1024uz); }
+
+// Collect extracted files
+struct Handler {
+  bool begin(std::string_view path) {
+    if (fail_on == path) return false;
+    current = path;
+    files[current];
+    return true;
+  }
+  bool write(std::span<uint8_t const> bytes) {
+    files[current].append(cbegin(bytes), cend(bytes));
+    return true;
+  }
+  bool end() {
+    ++ends;
+    return true;
+  }
+
+  std::map<std::string, std::string> files{};
+  std::string current{};
+  std::string_view fail_on{};
+  size_t ends{};
+};
+
+} // namespace
+
+TEST(tar, safe_path) {
+  static_assert(safe_path("index.html"));
+  static_assert(safe_path("assets/fonts/MaterialIcons-Regular.otf"));
+  static_assert(safe_path("a..b/c"));
+  static_assert(!safe_path(""));
+  static_assert(!safe_path("/etc/passwd"));
+  static_assert(!safe_path("../index.html"));
+  static_assert(!safe_path("assets/../../index.html"));
+  static_assert(!safe_path("assets/.."));
+}
+
+TEST(tar, extract_in_pieces) {
+  std::vector<uint8_t> tar;
+  append_entry(tar, "assets/", "", '5');
+  append_entry(tar, "./index.html", "<html></html>");
+  append_entry(tar, "pax", pax_record("path", "ignored/global/name"), 'g');
+  append_entry(tar, "main.dart.js", std::string(1000uz, 'j'));
+  append_entry(tar, "empty.json", "");
+  append_entry(tar, "MaterialIcons-Regular.otf", "otf", '0', "assets/fonts");
+  append_end(tar);
+
+  // Feed archive in odd sized pieces
+  for (auto const piece : {1uz, 7uz, 511uz, 512uz, 513uz, size(tar)}) {
+    TarReader reader;
+    Handler handler;
+    for (auto i{0uz}; i < size(tar); i += piece)
+      ASSERT_TRUE(reader.feed(
+        std::span{tar}.subspan(i, std::min(piece, size(tar) - i)), handler));
+    EXPECT_TRUE(reader.done());
+    EXPECT_EQ(handler.ends, 4uz);
+    EXPECT_EQ(handler.files,
+              (std::map<std::string, std::string>{
+                {"index.html", "<html></html>"},
+                {"main.dart.js", std::string(1000uz, 'j')},
+                {"empty.json", ""},
+                {"assets/fonts/MaterialIcons-Regular.otf", "otf"}}));
+  }
+}
+
+TEST(tar, pax_long_path) {
+  auto const long_path{"assets/packages/"s + std::string(120uz, 'p') +
+                       "/fonts/MaterialIcons-Regular.otf"};
+  std::vector<uint8_t> tar;
+  append_entry(tar,
+               "PaxHeaders/x",
+               pax_record("mtime", "1760000000.5") +
+                 pax_record("path", long_path),
+               'x');
+  append_entry(tar, long_path.substr(0uz, 100uz), "otf");
+  append_entry(tar, "index.html", "<html></html>");
+  append_end(tar);
+
+  for (auto const piece : {1uz, 100uz, size(tar)}) {
+    TarReader reader;
+    Handler handler;
+    for (auto i{0uz}; i < size(tar); i += piece)
+      ASSERT_TRUE(reader.feed(
+        std::span{tar}.subspan(i, std::min(piece, size(tar) - i)), handler));
+    EXPECT_TRUE(reader.done());
+    EXPECT_EQ(handler.files,
+              (std::map<std::string, std::string>{
+                {long_path, "otf"}, {"index.html", "<html></html>"}}));
+  }
+}
+
+TEST(tar, reject_malformed_pax) {
+  for (auto const& records : {"30 path=wrong/length\n"s,
+                             "path=index.html\n"s,
+                             "16 pathindex.html"s,
+                             std::string(2000uz, '\n')}) {
+    std::vector<uint8_t> tar;
+    append_entry(tar, "PaxHeaders/x", records, 'x');
+    append_entry(tar, "index.html", "<html></html>");
+
+    TarReader reader;
+    Handler handler;
+    EXPECT_FALSE(reader.feed(tar, handler)) << records;
+    EXPECT_TRUE(empty(handler.files));
+  }
+
+  // Unsafe paths are still rejected
+  std::vector<uint8_t> tar;
+  append_entry(tar, "PaxHeaders/x", pax_record("path", "../index.html"), 'x');
+  append_entry(tar, "index.html", "<html></html>");
+  TarReader reader;
+  Handler handler;
+  EXPECT_FALSE(reader.feed(tar, handler));
+  EXPECT_TRUE(empty(handler.files));
+}
+
+TEST(tar, incomplete_archive) {
+  std::vector<uint8_t> tar;
+  append_entry(tar, "index.html", "<html></html>");
+  tar.resize(size(tar) - 1uz);
+
+  TarReader reader;
+  Handler handler;
+  EXPECT_TRUE(reader.feed(tar, handler));
+  EXPECT_FALSE(reader.done());
+  EXPECT_EQ(handler.ends, 1uz);
+}
+
+TEST(tar, reject_bad_checksum) {
+  std::vector<uint8_t> tar;
+  append_entry(tar, "index.html", "<html></html>");
+  tar[0uz] = 'I';
+
+  TarReader reader;
+  Handler handler;
+  EXPECT_FALSE(reader.feed(tar, handler));
+  EXPECT_TRUE(empty(handler.files));
+
+  // Once failed, always failed
+  std::vector<uint8_t> good;
+  append_entry(good, "index.html", "<html></html>");
+  EXPECT_FALSE(reader.feed(good, handler));
+}
+
+TEST(tar, reject_unsafe_path) {
+  std::vector<uint8_t> tar;
+  append_entry(tar, "../index.html", "<html></html>");
+
+  TarReader reader;
+  Handler handler;
+  EXPECT_FALSE(reader.feed(tar, handler));
+  EXPECT_TRUE(empty(handler.files));
+}
+
+TEST(tar, handler_failure) {
+  std::vector<uint8_t> tar;
+  append_entry(tar, "index.html", "<html></html>");
+  append_entry(tar, "main.dart.js", "js");
+  append_end(tar);
+
+  TarReader reader;
+  Handler handler;
+  handler.fail_on = "main.dart.js";
+  EXPECT_FALSE(reader.feed(tar, handler));
+  EXPECT_FALSE(reader.done());
+  EXPECT_EQ(size(handler.files), 1uz);
+}
@@ -0,0 +1,73 @@
+#include "mw/meter/attribute.hpp"
+#include <gtest/gtest.h>
+#include <array>
+#include <limits>
+
+using namespace mw::meter;
+using mw::dcc::BidiSpeed;
+
+namespace {
+
+constexpr TickType_t now{pdMS_TO_TICKS(10'000u)};
+constexpr TickType_t stale{now - pdMS_TO_TICKS(bidi_speed_max_age) - 1u};
+
+uint64_t sum(auto const& energies) {
+  uint64_t acc{};
+  for (auto const& [addr, energy] : energies) acc += energy;
+  return acc;
+}
+
+} // namespace
+
+TEST(attribute, no_speeds) {
+  EXPECT_TRUE(empty(attribute(1000u, {}, now)));
+}
+
+TEST(attribute, zero_sum) {
+  std::array<BidiSpeed, 2uz> const speeds{{{3u, 0u, now}, {4u, 0u, now}}};
+  EXPECT_TRUE(empty(attribute(1000u, speeds, now)));
+}
+
+TEST(attribute, single_loco) {
+  std::array<BidiSpeed, 2uz> const speeds{{{3u, 42u, now}, {4u, 0u, now}}};
+  auto const energies{attribute(1000u, speeds, now)};
+  ASSERT_EQ(size(energies), 1uz);
+  EXPECT_EQ(energies[0uz].first, 3u);
+  EXPECT_EQ(energies[0uz].second, 1000u);
+}
+
+TEST(attribute, proportional_to_speed) {
+  std::array<BidiSpeed, 3uz> const speeds{
+    {{3u, 10u, now}, {4u, 30u, now}, {5u, 300u, now}}};
+  auto const energies{attribute(3400u, speeds, now)};
+  ASSERT_EQ(size(energies), 3uz);
+  EXPECT_EQ(energies[0uz].second, 100u);
+  EXPECT_EQ(energies[1uz].second, 300u);
+  EXPECT_EQ(energies[2uz].second, 3000u);
+  EXPECT_EQ(sum(energies), 3400u);
+}
+
+TEST(attribute, stale) {
+  // Stale loco gets nothing, remaining loco gets everything
+  std::array<BidiSpeed, 2uz> const speeds{{{3u, 50u, stale}, {4u, 20u, now}}};
+  auto const energies{attribute(1000u, speeds, now)};
+  ASSERT_EQ(size(energies), 1uz);
+  EXPECT_EQ(energies[0uz].first, 4u);
+  EXPECT_EQ(energies[0uz].second, 1000u);
+
+  // Only stale locos
+  std::array<BidiSpeed, 1uz> const only_stale{{{3u, 50u, stale}}};
+  EXPECT_TRUE(empty(attribute(1000u, only_stale, now)));
+
+  // Exactly at maximum age is still fresh
+  std::array<BidiSpeed, 1uz> const edge{
+    {{3u, 50u, now - pdMS_TO_TICKS(bidi_speed_max_age)}}};
+  EXPECT_EQ(size(attribute(1000u, edge, now)), 1uz);
+}
+
+TEST(attribute, tick_overflow) {
+  // Report shortly before the tick counter wrapped
+  std::array<BidiSpeed, 1uz> const speeds{
+    {{3u, 50u, std::numeric_limits<TickType_t>::max()}}};
+  EXPECT_EQ(size(attribute(1000u, speeds, 10u)), 1uz);
+}
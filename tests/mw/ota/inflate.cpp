@@ -0,0 +1,114 @@
+#include "mw/ota/inflate.hpp"
+#include <gtest/gtest.h>
+#include <optional>
+#include <random>
+#include <string>
+#include "intf/http/gzip.hpp"
+
+using namespace mw::ota;
+
+namespace {
+
+constexpr auto window_size{4096uz};
+
+// Raw deflate stream (fixed Huffman) of GzipWriter without header and trailer
+std::vector<uint8_t> deflate(std::string_view input) {
+  std::string gz;
+  intf::http::Send const send{[&gz](std::string_view chunk) {
+    gz += chunk;
+    return true;
+  }};
+  intf::http::GzipWriter<intf::http::response_chunk_size, window_size> writer{
+    send};
+  writer.write(input);
+  EXPECT_TRUE(writer.finish());
+  return {cbegin(gz) + 10, cend(gz) - 8};
+}
+
+// Decompress stream fed in pieces of up to max_piece bytes
+std::optional<std::string> inflate(std::span<uint8_t const> stream,
+                                   size_t max_piece = SIZE_MAX) {
+  std::string output;
+  Inflater<window_size> inflater;
+  std::mt19937 gen{42u};
+  while (!empty(stream)) {
+    std::uniform_int_distribution<size_t> dist{1uz, max_piece};
+    auto const n{std::min(size(stream), dist(gen))};
+    if (!inflater.feed(stream.first(n), [&](std::span<uint8_t const> bytes) {
+          output.append(cbegin(bytes), cend(bytes));
+          return true;
+        }))
+      return std::nullopt;
+    stream = stream.subspan(n);
+  }
+  if (!inflater.done()) return std::nullopt;
+  return output;
+}
+
+std::string make_text(size_t n) {
+  std::mt19937 gen{1u};
+  std::string text;
+  while (size(text) < n)
+    text += "loco " + std::to_string(gen() % 100u) + " speed " +
+            std::to_string(gen() % 128u) + '\n';
+  return text;
+}
+
+// zlib.compressobj(9, zlib.DEFLATED, -12) of z21_text, a dynamic block
+constexpr std::string_view z21_text{
+  "LAN_X_SET_LOCO_DRIVE LAN_X_SET_LOCO_FUNCTION LAN_X_GET_LOCO_INFO "
+  "LAN_X_SET_LOCO_DRIVE LAN_X_SET_LOCO_FUNCTION LAN_X_GET_LOCO_INFO "
+  "LAN_X_SET_LOCO_DRIVE LAN_X_SET_LOCO_FUNCTION LAN_X_GET_LOCO_INFO "
+  "LAN_X_SET_LOCO_DRIVE LAN_X_SET_LOCO_FUNCTION LAN_X_GET_LOCO_INFO "
+  "LAN_SYSTEMSTATE_GETDATA LAN_GET_SERIAL_NUMBER LAN_LOGOFF"};
+constexpr std::array<uint8_t, 84uz> z21_dynamic{
+  0xD5u, 0xCCu, 0xC1u, 0x09u, 0x80u, 0x30u, 0x0Cu, 0x85u, 0xE1u, 0x55u, 0x5Cu,
+  0x25u, 0xB6u, 0x69u, 0x09u, 0xA4u, 0x09u, 0x34u, 0xA9u, 0xE8u, 0x29u, 0xFBu,
+  0x6Fu, 0x21u, 0x15u, 0x3Du, 0xE8u, 0x06u, 0x5Eu, 0xBFu, 0xF7u, 0xF3u, 0x18u,
+  0x24u, 0xF6u, 0x30u, 0xF4u, 0x60u, 0x4Du, 0x1Au, 0xB9u, 0xD3u, 0x86u, 0x0Bu,
+  0xBFu, 0xB1u, 0x0Cu, 0x49u, 0x4Eu, 0x2Au, 0xB7u, 0xD7u, 0xC7u, 0x49u, 0x8Au,
+  0x7Eu, 0xDBu, 0xBFu, 0x1Eu, 0xD8u, 0x61u, 0x8Eu, 0xCDu, 0x1Cu, 0x1Cu, 0xE7u,
+  0x9Au, 0xC1u, 0xE1u, 0xF2u, 0x59u, 0x1Au, 0x76u, 0x02u, 0x0Eu, 0x19u, 0x6Du,
+  0xC5u, 0x7Eu, 0x29u, 0x6Bu, 0xD5u, 0x52u, 0x4Eu};
+
+} // namespace
+
+TEST(inflate, fixed_huffman) {
+  for (auto const& text : {std::string{}, std::string{"a"}, make_text(50000uz)})
+    for (auto const max_piece : {1uz, 100uz, SIZE_MAX})
+      EXPECT_EQ(inflate(deflate(text), max_piece), text);
+}
+
+TEST(inflate, dynamic_huffman) {
+  for (auto const max_piece : {1uz, 7uz, SIZE_MAX})
+    EXPECT_EQ(inflate(z21_dynamic, max_piece), z21_text);
+}
+
+TEST(inflate, stored) {
+  std::vector<uint8_t> stream{0x00u, 0x03u, 0x00u, 0xFCu, 0xFFu, 'a', 'b', 'c'};
+  stream.insert(cend(stream), {0x01u, 0x02u, 0x00u, 0xFDu, 0xFFu, 'd', 'e'});
+  for (auto const max_piece : {1uz, SIZE_MAX})
+    EXPECT_EQ(inflate(stream, max_piece), "abcde");
+
+  // LEN and NLEN don't match
+  stream[3uz] ^= 0x01u;
+  EXPECT_FALSE(inflate(stream));
+}
+
+TEST(inflate, malformed) {
+  auto const stream{deflate(make_text(10000uz))};
+
+  // Truncated
+  EXPECT_FALSE(inflate(std::span{stream}.first(size(stream) - 1uz)));
+
+  // Trailing garbage
+  auto trailing{stream};
+  trailing.push_back(0x00u);
+  EXPECT_FALSE(inflate(trailing));
+
+  // Reserved block type
+  EXPECT_FALSE(inflate(std::array<uint8_t, 1uz>{0x07u}));
+
+  // Back reference before start of stream (literal 'a', length 3, distance 2)
+  EXPECT_FALSE(inflate(std::array<uint8_t, 4uz>{0x4Bu, 0x04u, 0x42u, 0x00u}));
+}
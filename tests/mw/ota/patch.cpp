@@ -0,0 +1,236 @@
+#include "mw/ota/patch.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "intf/http/gzip.hpp"
+
+using namespace mw::ota;
+
+namespace {
+
+constexpr auto buffer_size{1024uz};
+constexpr std::array<uint8_t, 32uz> base_sha256{0xDEu, 0xADu, 0xBEu, 0xEFu};
+
+void append_varint(std::vector<uint8_t>& patch, uint64_t value) {
+  for (; value >= 0x80u; value >>= 7u)
+    patch.push_back(static_cast<uint8_t>(value | 0x80u));
+  patch.push_back(static_cast<uint8_t>(value));
+}
+
+// Header followed by operations compressed with GzipWriter, minus the gzip
+// header and trailer
+std::vector<uint8_t> make_patch(size_t image_size,
+                                std::span<uint8_t const> ops) {
+  std::vector<uint8_t> patch{begin(patch_magic), end(patch_magic)};
+  for (auto i{0uz}; i < sizeof(uint32_t); ++i)
+    patch.push_back(static_cast<uint8_t>(image_size >> (8uz * i)));
+  patch.insert(end(patch), begin(base_sha256), end(base_sha256));
+
+  std::string gz;
+  intf::http::Send const send{[&gz](std::string_view chunk) {
+    gz += chunk;
+    return true;
+  }};
+  intf::http::GzipWriter<intf::http::response_chunk_size, patch_window_size>
+    writer{send};
+  writer.write(data(ops), size(ops));
+  EXPECT_TRUE(writer.finish());
+  patch.insert(end(patch), begin(gz) + 10, end(gz) - 8);
+  return patch;
+}
+
+// Greedy copy/insert diff against base, good enough for tests
+std::vector<uint8_t> make_ops(std::span<uint8_t const> base,
+                              std::span<uint8_t const> image) {
+  constexpr auto min_match{8uz};
+  std::vector<uint8_t> patch;
+
+  auto const key{[](std::span<uint8_t const> bytes, size_t i) {
+    uint64_t k{};
+    std::memcpy(&k, &bytes[i], sizeof(k));
+    return k;
+  }};
+  std::unordered_map<uint64_t, size_t> index;
+  for (auto i{0uz}; i + min_match <= size(base); ++i)
+    index.try_emplace(key(base, i), i);
+
+  auto const match_length{[&](size_t src, size_t dst) {
+    auto n{0uz};
+    while (src + n < size(base) && dst + n < size(image) &&
+           base[src + n] == image[dst + n])
+      ++n;
+    return n;
+  }};
+
+  size_t src{}, literals{};
+  auto const flush{[&](size_t i) {
+    if (!literals) return;
+    patch.push_back(1u);
+    append_varint(patch, literals);
+    patch.insert(end(patch), begin(image) + i - literals, begin(image) + i);
+    literals = 0uz;
+  }};
+
+  for (auto i{0uz}; i < size(image);) {
+    auto from{src};
+    auto n{match_length(src, i)};
+    if (n < min_match && i + min_match <= size(image))
+      if (auto const it{index.find(key(image, i))}; it != cend(index))
+        if (auto const m{match_length(it->second, i)}; m > n)
+          from = it->second, n = m;
+    if (n < min_match) {
+      ++literals;
+      ++i;
+      continue;
+    }
+    flush(i);
+    auto const delta{static_cast<int64_t>(from) - static_cast<int64_t>(src)};
+    patch.push_back(0u);
+    append_varint(patch, n);
+    append_varint(patch,
+                  static_cast<uint64_t>(delta << 1) ^
+                    static_cast<uint64_t>(delta >> 63));
+    src = from + n;
+    i += n;
+  }
+  flush(size(image));
+  return patch;
+}
+
+std::vector<uint8_t> make_patch(std::span<uint8_t const> base,
+                                std::span<uint8_t const> image) {
+  return make_patch(size(image), make_ops(base, image));
+}
+
+// Apply patch fed in pieces of up to max_piece bytes
+std::optional<std::vector<uint8_t>> apply_patch(std::span<uint8_t const> base,
+                                                std::span<uint8_t const> patch,
+                                                size_t max_piece = SIZE_MAX) {
+  std::vector<uint8_t> image;
+  auto const read{[&](size_t offset, std::span<uint8_t> bytes) {
+    if (offset + size(bytes) > size(base)) return ESP_FAIL;
+    std::ranges::copy(base.subspan(offset, size(bytes)), begin(bytes));
+    return ESP_OK;
+  }};
+  auto const write{[&](std::span<uint8_t const> bytes) {
+    image.insert(end(image), begin(bytes), end(bytes));
+    return ESP_OK;
+  }};
+
+  Patcher<buffer_size> patcher{base_sha256};
+  std::mt19937 gen{42u};
+  while (!empty(patch)) {
+    auto const n{std::min(
+      size(patch), std::uniform_int_distribution<size_t>{1uz, max_piece}(gen))};
+    if (!patcher.feed(patch.first(n), read, write)) return std::nullopt;
+    patch = patch.subspan(n);
+  }
+  if (!patcher.done()) return std::nullopt;
+  EXPECT_EQ(patcher.written(), size(image));
+  return image;
+}
+
+// Pseudo firmware image, instructions with absolute addresses in them
+std::vector<uint8_t> make_image(size_t n) {
+  std::mt19937 gen{1u};
+  std::vector<uint8_t> image(n);
+  for (auto i{0uz}; i + 8uz <= n; i += 8uz) {
+    auto const op{static_cast<uint32_t>(gen() % 16u)};
+    auto const addr{static_cast<uint32_t>(0x4200'0000u + gen() % 4096u)};
+    std::memcpy(&image[i], &op, sizeof(op));
+    std::memcpy(&image[i + 4uz], &addr, sizeof(addr));
+  }
+  return image;
+}
+
+// Point release, some code changed, some inserted and the tail shifted
+std::vector<uint8_t> make_point_release(std::vector<uint8_t> image) {
+  std::mt19937 gen{2u};
+  for (auto i{0uz}; i < 50uz; ++i) image[gen() % size(image)] ^= 0x5Au;
+  std::vector<uint8_t> code(2048uz);
+  std::ranges::generate(code, [&] { return static_cast<uint8_t>(gen()); });
+  image.insert(begin(image) + size(image) / 3uz, begin(code), end(code));
+  image.erase(begin(image) + size(image) / 2uz,
+              begin(image) + size(image) / 2uz + 512uz);
+  return image;
+}
+
+} // namespace
+
+TEST(patch, is_patch) {
+  EXPECT_TRUE(is_patch(patch_magic));
+  EXPECT_FALSE(is_patch(std::span{patch_magic}.first(3uz)));
+  EXPECT_FALSE(is_patch(std::array<uint8_t, 4uz>{0xE9u, 0x05u, 0x02u, 0x20u}));
+}
+
+TEST(patch, round_trip) {
+  auto const base{make_image(64uz * 1024uz)};
+  for (auto const& image : {std::vector<uint8_t>{},
+                            base,
+                            make_point_release(base),
+                            std::vector<uint8_t>(begin(base) + 1000,
+                                                 begin(base) + 5000),
+                            make_image(10000uz)}) {
+    auto const patch{make_patch(base, image)};
+    for (auto const max_piece : {1uz, 100uz, SIZE_MAX})
+      EXPECT_EQ(apply_patch(base, patch, max_piece), image);
+  }
+}
+
+TEST(patch, wrong_base) {
+  auto const base{make_image(4096uz)};
+  auto patch{make_patch(base, base)};
+  patch[8uz] ^= 0xFFu;
+  EXPECT_FALSE(apply_patch(base, patch));
+  patch[8uz] ^= 0xFFu;
+  patch[0uz] = 0xE9u;
+  EXPECT_FALSE(apply_patch(base, patch));
+}
+
+TEST(patch, malformed) {
+  auto const base{make_image(4096uz)};
+  auto const image{make_point_release(base)};
+  auto const ops{make_ops(base, image)};
+  auto const patch{make_patch(size(image), ops)};
+
+  // Truncated
+  EXPECT_FALSE(apply_patch(base, std::span{patch}.first(size(patch) - 1uz)));
+  EXPECT_FALSE(apply_patch(base, std::span{patch}.first(patch_header_size)));
+
+  // Not deflate
+  auto raw{std::vector<uint8_t>{begin(patch),
+                                begin(patch) + patch_header_size}};
+  raw.insert(end(raw), begin(ops), end(ops));
+  EXPECT_FALSE(apply_patch(base, raw));
+
+  // Unknown operation
+  auto unknown{ops};
+  unknown[0uz] = 2u;
+  EXPECT_FALSE(apply_patch(base, make_patch(size(image), unknown)));
+
+  // Copy outside of base
+  EXPECT_FALSE(apply_patch(
+    base,
+    make_patch(size(image),
+               std::array<uint8_t, 5uz>{0u, 0x10u, 0x80u, 0x80u, 0x02u})));
+
+  // Copy before start of base
+  EXPECT_FALSE(apply_patch(
+    base, make_patch(size(image), std::array<uint8_t, 3uz>{0u, 0x10u, 0x01u})));
+
+  // Writing beyond announced image size
+  auto longer{ops};
+  longer.insert(end(longer), {1u, 1u, 0xFFu});
+  EXPECT_FALSE(apply_patch(base, make_patch(size(image), longer)));
+}
+
+TEST(patch, point_release) {
+  auto const base{make_image(1024uz * 1024uz)};
+  auto const image{make_point_release(base)};
+  auto const patch{make_patch(base, image)};
+  EXPECT_EQ(apply_patch(base, patch, 4096uz), image);
+  EXPECT_LT(size(patch) * 10uz, size(image));
+}
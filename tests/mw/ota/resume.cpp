@@ -0,0 +1,176 @@
+#include "mw/ota/resume.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace mw::ota;
+
+namespace {
+
+constexpr uint32_t address{0x10'0000u};
+
+// NVS
+struct MockStore {
+  std::optional<Progress> load() const { return progress; }
+  esp_err_t save(Progress const& p) {
+    progress = p;
+    ++saves;
+    return ESP_OK;
+  }
+  esp_err_t erase() {
+    progress.reset();
+    return ESP_OK;
+  }
+
+  std::optional<Progress> progress{};
+  size_t saves{};
+};
+
+// OTA partition, bytes behind the resume offset are garbage
+struct MockPartition {
+  void resume(uint32_t offset) {
+    ASSERT_LE(offset, size(bytes));
+    std::ranges::fill(std::span{bytes}.subspan(offset), 0xFFu);
+    bytes.resize(offset);
+  }
+
+  std::vector<uint8_t> bytes{};
+};
+
+std::vector<uint8_t> make_image(size_t n, uint32_t seed = 42u) {
+  std::mt19937 gen{seed};
+  std::vector<uint8_t> image(n);
+  std::ranges::generate(image, [&] { return static_cast<uint8_t>(gen()); });
+  return image;
+}
+
+Begin make_begin(std::vector<uint8_t> const& image) {
+  Begin begin{.size = static_cast<uint32_t>(size(image))};
+  std::ranges::copy(std::span{image}.first(size(begin.sha256)),
+                    data(begin.sha256));
+  return begin;
+}
+
+} // namespace
+
+TEST(ota_resume, parse_begin) {
+  std::vector<uint8_t> frame{begin_type, 0u, 0x78u, 0x56u, 0x34u, 0x12u};
+  for (auto i{0u}; i < 32u; ++i) frame.push_back(static_cast<uint8_t>(i));
+  auto const begin{parse_begin(frame)};
+  ASSERT_TRUE(begin);
+  EXPECT_EQ(begin->size, 0x1234'5678u);
+  EXPECT_EQ(begin->sha256[0uz], 0u);
+  EXPECT_EQ(begin->sha256[31uz], 31u);
+
+  frame.push_back(0u);
+  EXPECT_FALSE(parse_begin(frame));
+  frame.pop_back();
+  frame[0uz] = 'C';
+  EXPECT_FALSE(parse_begin(frame));
+}
+
+TEST(ota_resume, begin_ack) {
+  EXPECT_EQ(begin_ack(ack, 0x1234'5678u),
+            (std::array<uint8_t, 5uz>{ack, 0x78u, 0x56u, 0x34u, 0x12u}));
+}
+
+TEST(ota_resume, checkpoints) {
+  auto const image{make_image(5uz * checkpoint_interval + 100uz)};
+  MockStore store;
+  Resumable resumable;
+  EXPECT_EQ(resumable.begin(store, make_begin(image), address), 0u);
+  ASSERT_TRUE(store.progress);
+  EXPECT_EQ(store.progress->offset, 0u);
+
+  // Checkpoint only once a whole interval has been written
+  EXPECT_FALSE(resumable.written(store, checkpoint_interval - 1uz));
+  EXPECT_EQ(store.progress->offset, 0u);
+  EXPECT_FALSE(resumable.written(store, 1uz));
+  EXPECT_EQ(store.progress->offset, checkpoint_interval);
+  EXPECT_FALSE(resumable.written(store, 2uz * checkpoint_interval + 10uz));
+  EXPECT_EQ(store.progress->offset, 3uz * checkpoint_interval);
+  EXPECT_EQ(store.saves, 3uz);
+  EXPECT_FALSE(resumable.complete());
+
+  // No checkpoint for complete image
+  EXPECT_FALSE(resumable.written(store, 2uz * checkpoint_interval + 90uz));
+  EXPECT_EQ(store.saves, 3uz);
+  EXPECT_TRUE(resumable.complete());
+}
+
+TEST(ota_resume, only_resume_same_image_and_partition) {
+  auto const image{make_image(4uz * checkpoint_interval)};
+  MockStore store;
+  store.progress = Progress{.sha256 = make_begin(image).sha256,
+                            .size = static_cast<uint32_t>(size(image)),
+                            .address = address,
+                            .offset = 2u * checkpoint_interval};
+  auto const saved{*store.progress};
+
+  // Same image
+  EXPECT_EQ(Resumable{}.begin(store, make_begin(image), address),
+            2u * checkpoint_interval);
+  EXPECT_EQ(store.progress, saved);
+
+  // Other partition
+  EXPECT_EQ(Resumable{}.begin(store, make_begin(image), address * 2u), 0u);
+  store.progress = saved;
+
+  // Other size
+  auto begin{make_begin(image)};
+  ++begin.size;
+  EXPECT_EQ(Resumable{}.begin(store, begin, address), 0u);
+  store.progress = saved;
+
+  // Other image
+  EXPECT_EQ(Resumable{}.begin(store, make_begin(make_image(42uz, 1u)), address),
+            0u);
+  store.progress = saved;
+
+  // Corrupt progress
+  store.progress->offset = 1u;
+  EXPECT_EQ(Resumable{}.begin(store, make_begin(image), address), 0u);
+  EXPECT_EQ(store.progress->offset, 0u);
+}
+
+TEST(ota_resume, random_disconnects) {
+  constexpr auto chunk_size{4096uz};
+  auto const image{make_image(2uz * 1024uz * 1024uz + 1234uz)};
+  MockStore store;
+  MockPartition partition;
+  std::mt19937 gen{0u};
+  std::uniform_int_distribution<size_t> dist{0uz, size(image)};
+
+  auto connections{0uz};
+  auto bytes_sent{0uz};
+  for (;; ++connections) {
+    ASSERT_LT(connections, 100uz);
+
+    // Reconnect
+    Resumable resumable;
+    auto const offset{resumable.begin(store, make_begin(image), address)};
+    ASSERT_EQ(offset % checkpoint_interval, 0uz);
+    partition.resume(offset);
+
+    // Send until disconnect, last connection always finishes
+    auto const disconnect{connections < 10uz ? dist(gen) : size(image)};
+    for (auto i{static_cast<size_t>(offset)};
+         i < size(image) && i < disconnect;
+         i += chunk_size) {
+      auto const chunk{
+        std::span{image}.subspan(i, std::min(chunk_size, size(image) - i))};
+      partition.bytes.insert(cend(partition.bytes), cbegin(chunk), cend(chunk));
+      bytes_sent += size(chunk);
+      ASSERT_FALSE(resumable.written(store, size(chunk)));
+    }
+
+    if (resumable.complete()) break;
+  }
+
+  EXPECT_EQ(partition.bytes, image);
+  EXPECT_GT(connections, 0uz);
+
+  // Without resuming every reconnect would have started from zero
+  EXPECT_LT(bytes_sent, (connections + 1uz) * size(image) / 2uz);
+}
@@ -0,0 +1,247 @@
+#include "mw/ota/window.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include "channel.hpp"
+
+using namespace mw::ota;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Build chunk frame
+std::vector<uint8_t> make_chunk(uint16_t seq,
+                                std::span<uint8_t const> payload) {
+  auto const crc{crc32(0u, data(payload), size(payload))};
+  std::vector<uint8_t> frame{chunk_type,
+                             0u,
+                             static_cast<uint8_t>(seq),
+                             static_cast<uint8_t>(seq >> 8u),
+                             static_cast<uint8_t>(crc),
+                             static_cast<uint8_t>(crc >> 8u),
+                             static_cast<uint8_t>(crc >> 16u),
+                             static_cast<uint8_t>(crc >> 24u)};
+  frame.insert(cend(frame), cbegin(payload), cend(payload));
+  return frame;
+}
+
+std::vector<uint8_t> make_image(size_t n) {
+  std::mt19937 gen{42u};
+  std::vector<uint8_t> image(n);
+  std::ranges::generate(image, [&] { return static_cast<uint8_t>(gen()); });
+  return image;
+}
+
+// OTA partition which takes some time to write and optionally fails
+struct MockPartition {
+  esp_err_t write(std::span<uint8_t const> bytes) {
+    if (size(image) + size(bytes) > fail_at) return ESP_FAIL;
+    std::this_thread::sleep_for(delay);
+    image.insert(cend(image), cbegin(bytes), cend(bytes));
+    return ESP_OK;
+  }
+
+  std::vector<uint8_t> image{};
+  size_t fail_at{SIZE_MAX};
+  std::chrono::microseconds delay{};
+};
+
+// Upload image through simulated link with round trip time rtt
+void upload(std::vector<uint8_t> const& image,
+            size_t chunk_size,
+            size_t window,
+            std::chrono::microseconds rtt,
+            MockPartition& partition) {
+  using clock = std::chrono::steady_clock;
+  struct Frame {
+    clock::time_point arrival;
+    std::vector<uint8_t> payload;
+  };
+  struct Ack {
+    clock::time_point arrival;
+    std::array<uint8_t, 3uz> payload;
+  };
+  Channel<Frame> up;
+  Channel<Ack> down;
+
+  Window rx_window;
+  FlashWriter writer;
+  std::thread writer_task{[&] {
+    writer.run(
+      [&](std::span<uint8_t const> bytes) { return partition.write(bytes); },
+      [&](uint16_t seq, esp_err_t err) {
+        down.push({clock::now() + rtt / 2, chunk_ack(err ? nak : ack, seq)});
+      });
+  }};
+  std::thread receive_task{[&] {
+    while (auto frame{up.pop(1s)}) {
+      std::this_thread::sleep_until(frame->arrival);
+      if (empty(frame->payload)) break;
+      switch (rx_window.receive(frame->payload)) {
+        case Window::Verdict::Accept:
+          EXPECT_TRUE(
+            writer.submit(static_cast<uint16_t>(rx_window.next() - 1u),
+                          std::move(frame->payload),
+                          1s));
+          break;
+        case Window::Verdict::Nak:
+          down.push({clock::now() + rtt / 2, chunk_ack(nak, rx_window.next())});
+          break;
+        case Window::Verdict::Ignore: break;
+      }
+    }
+    writer.stop();
+  }};
+
+  auto const chunks{(size(image) + chunk_size - 1uz) / chunk_size};
+  auto const send{[&](size_t i) {
+    auto const payload{std::span{image}.subspan(
+      i * chunk_size, std::min(chunk_size, size(image) - i * chunk_size))};
+    up.push({clock::now() + rtt / 2,
+             make_chunk(static_cast<uint16_t>(i), payload)});
+  }};
+
+  size_t base{}, next{};
+  while (base < chunks) {
+    while (next < chunks && next - base < window) send(next++);
+    auto const a{down.pop(1s)};
+    if (!a) break;
+    std::this_thread::sleep_until(a->arrival);
+    auto const seq{
+      static_cast<size_t>(a->payload[1uz] | a->payload[2uz] << 8u)};
+    if (a->payload[0uz] == ack) base = seq + 1uz;
+    else break;
+  }
+  up.push({clock::now(), {}});
+  receive_task.join();
+  writer_task.join();
+}
+
+} // namespace
+
+TEST(ota_window, parse_chunk) {
+  auto const payload{make_image(100uz)};
+  auto frame{make_chunk(0x1234u, payload)};
+  auto const chunk{parse_chunk(frame)};
+  ASSERT_TRUE(chunk);
+  EXPECT_EQ(chunk->seq, 0x1234u);
+  EXPECT_TRUE(chunk->valid());
+  EXPECT_TRUE(std::ranges::equal(chunk->payload, payload));
+
+  // Corrupt payload
+  frame.back() ^= 0x01u;
+  EXPECT_FALSE(parse_chunk(frame)->valid());
+
+  // Legacy image or too short
+  EXPECT_FALSE(parse_chunk(std::vector<uint8_t>{0xE9u, 0u, 0u, 0u, 0u, 0u}));
+  EXPECT_FALSE(parse_chunk(std::span{frame}.first(chunk_header_size - 1uz)));
+  EXPECT_TRUE(parse_chunk(std::span{frame}.first(chunk_header_size)));
+}
+
+TEST(ota_window, chunk_ack) {
+  EXPECT_EQ(chunk_ack(ack, 0x1234u),
+            (std::array<uint8_t, 3uz>{ack, 0x34u, 0x12u}));
+  EXPECT_EQ(chunk_ack(nak, 0u), (std::array<uint8_t, 3uz>{nak, 0u, 0u}));
+}
+
+TEST(ota_window, go_back_n) {
+  auto const payload{make_image(16uz)};
+  Window window;
+  using enum Window::Verdict;
+
+  EXPECT_EQ(window.receive(make_chunk(0u, payload)), Accept);
+  EXPECT_EQ(window.receive(make_chunk(1u, payload)), Accept);
+
+  // Chunk 2 got lost, nak once and ignore rest of window
+  EXPECT_EQ(window.receive(make_chunk(3u, payload)), Nak);
+  EXPECT_EQ(window.next(), 2u);
+  EXPECT_EQ(window.receive(make_chunk(4u, payload)), Ignore);
+  EXPECT_EQ(window.receive(make_chunk(5u, payload)), Ignore);
+
+  // Retransmission is corrupt, nak again
+  auto corrupt{make_chunk(2u, payload)};
+  corrupt.back() ^= 0xFFu;
+  EXPECT_EQ(window.receive(corrupt), Nak);
+  EXPECT_EQ(window.receive(make_chunk(3u, payload)), Ignore);
+
+  // Retransmission succeeds, old chunks are ignored
+  EXPECT_EQ(window.receive(make_chunk(2u, payload)), Accept);
+  EXPECT_EQ(window.receive(make_chunk(1u, payload)), Ignore);
+  EXPECT_EQ(window.receive(make_chunk(3u, payload)), Accept);
+  EXPECT_EQ(window.next(), 4u);
+  EXPECT_EQ(window.naks(), 2uz);
+}
+
+TEST(ota_window, sequence_number_wraps) {
+  auto const payload{make_image(4uz)};
+  Window window;
+  for (auto i{0uz}; i <= UINT16_MAX + 2uz; ++i)
+    ASSERT_EQ(window.receive(make_chunk(static_cast<uint16_t>(i), payload)),
+              Window::Verdict::Accept);
+  EXPECT_EQ(window.receive(make_chunk(UINT16_MAX, payload)),
+            Window::Verdict::Ignore);
+  EXPECT_EQ(window.next(), 2u);
+}
+
+TEST(ota_window, upload) {
+  auto const image{make_image(100'000uz)};
+  MockPartition partition;
+  upload(image, 4096uz, window_size, 0us, partition);
+  EXPECT_EQ(partition.image, image);
+}
+
+TEST(ota_window, write_failure) {
+  auto const image{make_image(100'000uz)};
+  MockPartition partition{.fail_at = 50'000uz};
+  FlashWriter writer;
+  std::vector<std::pair<uint16_t, esp_err_t>> results;
+  std::thread writer_task{[&] {
+    writer.run(
+      [&](std::span<uint8_t const> bytes) { return partition.write(bytes); },
+      [&](uint16_t seq, esp_err_t err) { results.push_back({seq, err}); });
+  }};
+
+  auto seq{0u};
+  for (auto i{0uz}; i < size(image); i += 4096uz, ++seq) {
+    auto const payload{std::span{image}.subspan(
+      i, std::min(4096uz, size(image) - i))};
+    if (!writer.submit(static_cast<uint16_t>(seq),
+                       make_chunk(static_cast<uint16_t>(seq), payload),
+                       1s))
+      break;
+  }
+  writer.stop();
+  writer_task.join();
+
+  EXPECT_TRUE(writer.error());
+  ASSERT_FALSE(empty(results));
+  EXPECT_EQ(results.back(), (std::pair<uint16_t, esp_err_t>{12u, ESP_FAIL}));
+  EXPECT_EQ(size(results), 13uz);
+  EXPECT_EQ(writer.stats().chunks, 12uz);
+  EXPECT_EQ(size(partition.image), 12uz * 4096uz);
+  EXPECT_LT(seq, 25u);
+
+  // Failure must not leak into the next upload
+  writer.reset();
+  EXPECT_FALSE(writer.error());
+  EXPECT_EQ(writer.stats().chunks, 0uz);
+}
+
+TEST(ota_window, upload_over_slow_link) {
+  constexpr auto chunk_size{4096uz};
+  constexpr auto rtt{4ms};
+  constexpr auto delay{3ms};
+  auto const image{make_image(32uz * chunk_size)};
+
+  // Stop-and-wait
+  MockPartition stop_and_wait_partition{.delay = delay};
+  upload(image, chunk_size, 1uz, rtt, stop_and_wait_partition);
+  EXPECT_EQ(stop_and_wait_partition.image, image);
+
+  // Windowed
+  MockPartition windowed_partition{.delay = delay};
+  upload(image, chunk_size, window_size, rtt, windowed_partition);
+  EXPECT_EQ(windowed_partition.image, image);
+}
@@ -0,0 +1,109 @@
+#include "mw/roco/z21/aggregator.hpp"
+#include <gtest/gtest.h>
+#include <lwip/sockets.h>
+
+namespace {
+
+// Fake socket with distinct peer address per client
+z21::Socket make_socket(int fd, uint16_t port) {
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  return {fd, std::bit_cast<sockaddr*>(&addr), sizeof(addr)};
+}
+
+struct Sent {
+  int fd;
+  std::vector<uint8_t> payload;
+};
+
+} // namespace
+
+class AggregatorTest : public ::testing::Test {
+protected:
+  std::vector<Sent> _sent;
+  mw::roco::z21::Aggregator _aggregator{
+    [this](z21::Socket const& sock, std::span<uint8_t const> payload) {
+      _sent.push_back({sock.fd, {cbegin(payload), cend(payload)}});
+    },
+    16uz,
+    1000u};
+};
+
+TEST_F(AggregatorTest, hold_back_until_window_expired) {
+  auto const sock{make_socket(3, 21105u)};
+  std::array<uint8_t, 4uz> const dataset{0x04u, 0x00u, 0x85u, 0x00u};
+  EXPECT_TRUE(_aggregator.append(sock, dataset, 0u));
+  EXPECT_FALSE(_aggregator.append(sock, dataset, 100u));
+  EXPECT_EQ(_aggregator.deadline(), 1000u);
+
+  _aggregator.poll(999u);
+  EXPECT_TRUE(empty(_sent));
+
+  _aggregator.poll(1000u);
+  ASSERT_EQ(size(_sent), 1uz);
+  EXPECT_EQ(size(_sent[0uz].payload), 8uz);
+  EXPECT_FALSE(_aggregator.deadline());
+  EXPECT_EQ(_aggregator.datasets(), 2u);
+  EXPECT_EQ(_aggregator.datagrams(), 1u);
+  EXPECT_EQ(_aggregator.saved(), 1u);
+}
+
+TEST_F(AggregatorTest, separate_buffers_per_client) {
+  auto const sock0{make_socket(3, 21105u)};
+  auto const sock1{make_socket(3, 21106u)};
+  std::array<uint8_t, 4uz> const dataset{0x04u, 0x00u, 0x85u, 0x00u};
+  EXPECT_TRUE(_aggregator.append(sock0, dataset, 0u));
+  EXPECT_TRUE(_aggregator.append(sock1, dataset, 0u));
+  EXPECT_FALSE(_aggregator.append(sock1, dataset, 0u));
+  _aggregator.flush();
+  ASSERT_EQ(size(_sent), 2uz);
+  EXPECT_EQ(size(_sent[0uz].payload), 4uz);
+  EXPECT_EQ(size(_sent[1uz].payload), 8uz);
+  EXPECT_EQ(_aggregator.saved(), 1u);
+}
+
+TEST_F(AggregatorTest, flush_early_when_mtu_exceeded) {
+  auto const sock{make_socket(3, 21105u)};
+  std::array<uint8_t, 6uz> const dataset{};
+  EXPECT_TRUE(_aggregator.append(sock, dataset, 0u));
+  EXPECT_FALSE(_aggregator.append(sock, dataset, 0u));
+  EXPECT_TRUE(empty(_sent));
+
+  // 18 bytes don't fit into 16 byte MTU
+  EXPECT_TRUE(_aggregator.append(sock, dataset, 10u));
+  ASSERT_EQ(size(_sent), 1uz);
+  EXPECT_EQ(size(_sent[0uz].payload), 12uz);
+  EXPECT_EQ(_aggregator.deadline(), 1010u);
+}
+
+TEST_F(AggregatorTest, send_oversized_datasets_immediately) {
+  auto const sock{make_socket(3, 21105u)};
+  std::array<uint8_t, 20uz> const datasets{};
+  EXPECT_FALSE(_aggregator.append(sock, datasets, 0u));
+  ASSERT_EQ(size(_sent), 1uz);
+  EXPECT_FALSE(_aggregator.deadline());
+  EXPECT_EQ(_aggregator.saved(), 0u);
+}
+
+TEST_F(AggregatorTest, oversized_datasets_keep_order) {
+  auto const sock0{make_socket(3, 21105u)};
+  auto const sock1{make_socket(3, 21106u)};
+  std::array<uint8_t, 4uz> const dataset{0x04u, 0x00u, 0x85u, 0x00u};
+  std::array<uint8_t, 20uz> const datasets{};
+  EXPECT_TRUE(_aggregator.append(sock0, dataset, 0u));
+  EXPECT_TRUE(_aggregator.append(sock1, dataset, 0u));
+  EXPECT_FALSE(_aggregator.append(sock0, datasets, 0u));
+
+  // Buffered dataset of sock0 goes out before oversized ones
+  ASSERT_EQ(size(_sent), 2uz);
+  EXPECT_EQ(size(_sent[0uz].payload), 4uz);
+  EXPECT_EQ(size(_sent[1uz].payload), 20uz);
+
+  // Buffer of sock1 is untouched
+  EXPECT_EQ(_aggregator.deadline(), 1000u);
+  _aggregator.flush();
+  ASSERT_EQ(size(_sent), 3uz);
+  EXPECT_EQ(_aggregator.saved(), 0u);
+}
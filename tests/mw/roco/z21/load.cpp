@@ -0,0 +1,536 @@
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <z21/z21.hpp>
+#include "mem/nvs/init.hpp"
+#include "mem/nvs/locos.hpp"
+#include "mem/nvs/turnouts.hpp"
+#include "mw/dcc/service.hpp"
+#include "mw/roco/z21/aggregator.hpp"
+
+// Z21 load harness
+//
+// Binds a Z21 server to a loopback UDP socket and runs the real DCC service
+// behind it, including its operations task. The track task gets replaced by a
+// stub which drains the packet buffers. A number of simulated throttles then
+// drive, switch, subscribe and poll for a while, like
+// tools/scripts/roco_z21_load.py does against a real device. Reports reply
+// latency percentiles, broadcast fan-out time and server CPU time per
+// datagram.
+//
+// The harness is disabled by default, run it with
+// --gtest_filter=Z21LoadTest.* --gtest_also_run_disabled_tests
+
+namespace {
+
+using namespace std::chrono_literals;
+using Clock = std::chrono::steady_clock;
+
+constexpr auto clients{32uz};
+constexpr auto duration{10s};
+constexpr auto request_period{100ms};
+constexpr auto fanout_period{500ms};
+constexpr uint16_t shared_loco{3u};
+
+// Host threads must never take the FreeRTOS tick signal
+template<typename F>
+std::thread host_thread(F&& f) {
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_BLOCK, &all, &old);
+  std::thread thread{std::forward<F>(f)};
+  pthread_sigmask(SIG_SETMASK, &old, nullptr);
+  return thread;
+}
+
+std::chrono::nanoseconds thread_cpu_time() {
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+std::vector<uint8_t> dataset(uint16_t header,
+                             std::vector<uint8_t> const& payload = {}) {
+  auto const len{static_cast<uint16_t>(4uz + size(payload))};
+  std::vector<uint8_t> ds{static_cast<uint8_t>(len),
+                          static_cast<uint8_t>(len >> 8u),
+                          static_cast<uint8_t>(header),
+                          static_cast<uint8_t>(header >> 8u)};
+  ds.insert(cend(ds), cbegin(payload), cend(payload));
+  return ds;
+}
+
+std::vector<uint8_t> x_dataset(std::vector<uint8_t> xbus) {
+  uint8_t x{};
+  for (auto const b : xbus) x ^= b;
+  xbus.push_back(x);
+  return dataset(0x40u, xbus);
+}
+
+std::array<uint8_t, 2uz> loco_address(uint16_t addr) {
+  return {static_cast<uint8_t>(addr >> 8u | (addr >= 128u ? 0xC0u : 0x00u)),
+          static_cast<uint8_t>(addr)};
+}
+
+std::vector<uint8_t> set_broadcastflags(uint32_t flags) {
+  return dataset(0x50u,
+                 {static_cast<uint8_t>(flags),
+                  static_cast<uint8_t>(flags >> 8u),
+                  static_cast<uint8_t>(flags >> 16u),
+                  static_cast<uint8_t>(flags >> 24u)});
+}
+
+std::vector<uint8_t> get_loco_info(uint16_t addr) {
+  auto const [msb, lsb]{loco_address(addr)};
+  return x_dataset({0xE3u, 0xF0u, msb, lsb});
+}
+
+std::vector<uint8_t> set_loco_drive(uint16_t addr, uint8_t rvvvvvvv) {
+  auto const [msb, lsb]{loco_address(addr)};
+  return x_dataset({0xE4u, 0x13u, msb, lsb, rvvvvvvv});
+}
+
+std::vector<uint8_t> set_loco_function(uint16_t addr, uint8_t index, bool on) {
+  auto const [msb, lsb]{loco_address(addr)};
+  return x_dataset(
+    {0xE4u, 0xF8u, msb, lsb, static_cast<uint8_t>(on << 6u | index)});
+}
+
+std::vector<uint8_t> set_turnout(uint16_t addr, bool p) {
+  return x_dataset({0x53u,
+                    static_cast<uint8_t>(addr >> 8u),
+                    static_cast<uint8_t>(addr),
+                    static_cast<uint8_t>(0x88u | p)});
+}
+
+sockaddr_in loopback(uint16_t port) {
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  return addr;
+}
+
+uint64_t now_us() {
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      Clock::now().time_since_epoch())
+      .count());
+}
+
+template<typename T>
+T percentile(std::vector<T> values, size_t p) {
+  if (empty(values)) return {};
+  std::ranges::sort(values);
+  return values[std::min(size(values) - 1uz, p * size(values) / 100uz)];
+}
+
+// Z21 server on a loopback UDP socket
+//
+// Mirrors mw::roco::z21::Service, minus WebSockets. A single FreeRTOS task
+// receives and executes datagrams and runs posted broadcasts, so that only
+// this task ever walks the client registry.
+class LoadServer : public z21::server::Base<z21::server::intf::System,
+                                            z21::server::intf::Dcc> {
+public:
+  explicit LoadServer(std::shared_ptr<z21::server::intf::Dcc> dcc_service)
+    : _dcc_service{dcc_service} {
+    _fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    auto addr{loopback(0u)};
+    ::bind(_fd, std::bit_cast<sockaddr*>(&addr), sizeof(addr));
+    socklen_t len{sizeof(addr)};
+    getsockname(_fd, std::bit_cast<sockaddr*>(&addr), &len);
+    _port = ntohs(addr.sin_port);
+    xTaskCreate(
+      [](void* self) { static_cast<LoadServer*>(self)->taskFunction(); },
+      "load_server",
+      8192uz,
+      this,
+      mw::roco::z21::exec_task.priority,
+      NULL);
+  }
+
+  ~LoadServer() {
+    stop();
+    close(_fd);
+  }
+
+  // Posted work still pending gets dropped
+  void stop() {
+    _running = false;
+    while (!_stopped) vTaskDelay(pdMS_TO_TICKS(10u));
+  }
+
+  uint16_t port() const { return _port; }
+
+  void post(std::function<void()> work) {
+    std::lock_guard lock{_posted_mutex};
+    _posted.push_back(std::move(work));
+  }
+
+  size_t datagrams() const { return _datagrams; }
+  std::chrono::nanoseconds cpuTime() const {
+    return std::chrono::nanoseconds{_cpu_time.load()};
+  }
+
+private:
+  void taskFunction() {
+    std::array<uint8_t, Z21_MAX_PAYLOAD_SIZE> stack;
+    std::vector<std::function<void()>> posted;
+    while (_running) {
+      auto const start{thread_cpu_time()};
+      for (;;) {
+        sockaddr_storage addr{};
+        socklen_t len{sizeof(addr)};
+        auto const n{recvfrom(_fd,
+                              data(stack),
+                              size(stack),
+                              MSG_DONTWAIT,
+                              std::bit_cast<sockaddr*>(&addr),
+                              &len)};
+        if (n <= 0) break;
+        receive({_fd, std::bit_cast<sockaddr*>(&addr), len},
+                {data(stack), static_cast<size_t>(n)});
+        execute();
+        ++_datagrams;
+      }
+      {
+        std::lock_guard lock{_posted_mutex};
+        posted.swap(_posted);
+      }
+      for (auto const& work : posted) work();
+      posted.clear();
+      _aggregator.poll(now_us());
+      _cpu_time += (thread_cpu_time() - start).count();
+      vTaskDelay(1u);
+    }
+    _aggregator.flush();
+    _stopped = true;
+    vTaskDelete(NULL);
+  }
+
+  void transmit(z21::Socket const& sock,
+                std::span<uint8_t const> datasets) final {
+    _aggregator.append(sock, datasets, now_us());
+  }
+
+  [[nodiscard]] bool trackPower(bool) final { return true; }
+  [[nodiscard]] bool stop() final { return true; }
+  [[nodiscard]] int32_t serialNumber() const final { return 0x21; }
+  void logoff(z21::Socket const&) final {}
+
+  void locoEStop(uint16_t loco_addr) final {
+    _dcc_service->locoEStop(loco_addr);
+  }
+  void locoPurge(uint16_t loco_addr) final {
+    _dcc_service->locoPurge(loco_addr);
+  }
+  z21::LocoInfo locoInfo(uint16_t loco_addr) final {
+    return _dcc_service->locoInfo(loco_addr);
+  }
+  void locoFunction(uint16_t loco_addr, uint32_t mask, uint32_t state) final {
+    _dcc_service->locoFunction(loco_addr, mask, state);
+  }
+  void locoDrive(uint16_t loco_addr,
+                 z21::LocoInfo::SpeedSteps speed_steps,
+                 uint8_t rvvvvvvv) final {
+    _dcc_service->locoDrive(loco_addr, speed_steps, rvvvvvvv);
+  }
+  z21::LocoInfo::Mode locoMode(uint16_t loco_addr) final {
+    return _dcc_service->locoMode(loco_addr);
+  }
+  void locoMode(uint16_t loco_addr, z21::LocoInfo::Mode mode) final {
+    _dcc_service->locoMode(loco_addr, mode);
+  }
+
+  [[nodiscard]] z21::TurnoutInfo turnoutInfo(uint16_t accy_addr) final {
+    return _dcc_service->turnoutInfo(accy_addr);
+  }
+  [[nodiscard]] z21::AccessoryInfo accessoryInfo(uint16_t accy_addr) final {
+    return _dcc_service->accessoryInfo(accy_addr);
+  }
+  void turnout(uint16_t accy_addr, bool p, bool a, bool q) final {
+    _dcc_service->turnout(accy_addr, p, a, q);
+  }
+  void accessory(uint16_t accy_addr, uint8_t dddddddd) final {
+    _dcc_service->accessory(accy_addr, dddddddd);
+  }
+  [[nodiscard]] z21::TurnoutInfo::Mode turnoutMode(uint16_t accy_addr) final {
+    return _dcc_service->turnoutMode(accy_addr);
+  }
+  void turnoutMode(uint16_t accy_addr, z21::TurnoutInfo::Mode mode) final {
+    _dcc_service->turnoutMode(accy_addr, mode);
+  }
+
+  // No programming under load
+  [[nodiscard]] bool cvRead(uint16_t) final { return false; }
+  [[nodiscard]] bool cvWrite(uint16_t, uint8_t) final { return false; }
+  void cvPomRead(uint16_t, uint16_t) final {}
+  void cvPomWrite(uint16_t, uint16_t, uint8_t) final {}
+  void cvPomAccessoryRead(uint16_t, uint16_t, bool) final {}
+  void cvPomAccessoryWrite(uint16_t, uint16_t, uint8_t, bool) final {}
+
+  [[nodiscard]] z21::RailComData railComData(uint16_t loco_addr) final {
+    return _dcc_service->railComData(loco_addr);
+  }
+
+  std::shared_ptr<z21::server::intf::Dcc> _dcc_service;
+  int _fd{-1};
+  uint16_t _port{};
+  mw::roco::z21::Aggregator _aggregator{
+    [this](z21::Socket const& sock, std::span<uint8_t const> payload) {
+      ::sendto(_fd,
+               data(payload),
+               size(payload),
+               0,
+               std::bit_cast<sockaddr*>(&sock.addr),
+               sock.len);
+    },
+    mw::roco::z21::aggregation_mtu,
+    mw::roco::z21::aggregation_window};
+  std::mutex _posted_mutex;
+  std::vector<std::function<void()>> _posted;
+  std::atomic<size_t> _datagrams{};
+  std::atomic<std::chrono::nanoseconds::rep> _cpu_time{};
+  std::atomic<bool> _running{true};
+  std::atomic<bool> _stopped{};
+};
+
+// Simulated UDP throttle
+//
+// Drives its own loco, switches its own turnout and polls a probe loco nobody
+// drives. Only probe loco info and serial number replies get timed, since
+// neither can be confused with a broadcast.
+struct Throttle {
+  Throttle(size_t id, uint16_t port)
+    : id{id}, loco{static_cast<uint16_t>(100uz + id)},
+      probe{static_cast<uint16_t>(1000uz + id)},
+      turnout{static_cast<uint16_t>(1uz + id)}, server{loopback(port)} {
+    fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    timeval tv{.tv_sec = 0, .tv_usec = 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  }
+
+  ~Throttle() { close(fd); }
+
+  void send(std::vector<uint8_t> const& ds) const {
+    ::sendto(fd,
+             data(ds),
+             size(ds),
+             0,
+             std::bit_cast<sockaddr const*>(&server),
+             sizeof(server));
+  }
+
+  void request(uint16_t key, std::vector<uint8_t> const& ds) {
+    pending[key].push_back(Clock::now());
+    ++requests;
+    send(ds);
+  }
+
+  void reply(uint16_t key, Clock::time_point now) {
+    if (auto& q{pending[key]}; !empty(q)) {
+      latencies.push_back(now - q.front());
+      q.pop_front();
+    }
+  }
+
+  // Split datagram into datasets
+  void receive(std::span<uint8_t const> payload, Clock::time_point now) {
+    while (size(payload) >= 4uz) {
+      auto const len{payload[0uz] | payload[1uz] << 8u};
+      auto const header{payload[2uz] | payload[3uz] << 8u};
+      if (len < 4 || static_cast<size_t>(len) > size(payload)) break;
+      auto const ds{payload.subspan(4uz, len - 4uz)};
+      ++rx;
+      if (header == 0x10) reply(0u, now);
+      else if (header == 0x40 && size(ds) >= 6uz && ds[0uz] == 0xEFu) {
+        auto const addr{(ds[1uz] & 0x3Fu) << 8u | ds[2uz]};
+        if (addr == shared_loco) {
+          std::lock_guard lock{fanout_mutex};
+          fanout.try_emplace(ds[4uz] & 0x7Fu, now);
+        } else if (addr == probe) reply(probe, now);
+      }
+      payload = payload.subspan(static_cast<size_t>(len));
+    }
+  }
+
+  void run(std::atomic<bool> const& running) {
+    send(set_broadcastflags(0x00000101u));
+    send(get_loco_info(shared_loco));
+    std::array<uint8_t, Z21_MAX_PAYLOAD_SIZE> stack;
+    auto next{Clock::now()};
+    for (auto i{0uz}; running; ++i) {
+      switch (i % 5uz) {
+        case 0uz:
+          send(set_loco_drive(loco, static_cast<uint8_t>(0x82u + i % 126uz)));
+          break;
+        case 1uz:
+          send(
+            set_loco_function(loco, static_cast<uint8_t>(i % 29uz), i & 1uz));
+          break;
+        case 2uz: send(set_turnout(turnout, i & 1uz)); break;
+        case 3uz: request(probe, get_loco_info(probe)); break;
+        case 4uz: request(0u, dataset(0x10u)); break;
+      }
+      for (next += request_period; Clock::now() < next;)
+        if (auto const n{recv(fd, data(stack), size(stack), 0)}; n > 0)
+          receive({data(stack), static_cast<size_t>(n)}, Clock::now());
+    }
+    send(dataset(0x30u));
+  }
+
+  size_t id;
+  uint16_t loco;
+  uint16_t probe;
+  uint16_t turnout;
+  sockaddr_in server;
+  int fd{-1};
+  std::map<uint16_t, std::deque<Clock::time_point>> pending;
+  std::vector<Clock::duration> latencies;
+  size_t requests{};
+  size_t rx{};
+  std::mutex fanout_mutex;
+  std::map<uint8_t, Clock::time_point> fanout;
+};
+
+} // namespace
+
+class Z21LoadTest : public ::testing::Test {
+protected:
+  Z21LoadTest() {
+    EXPECT_EQ(mem::nvs::init(), ESP_OK);
+    drv::out::tx_message_buffer.front_handle =
+      xMessageBufferCreate(drv::out::tx_message_buffer.size);
+    drv::out::tx_message_buffer.back_handle =
+      xMessageBufferCreate(drv::out::tx_message_buffer.size);
+    drv::out::track::rx_queue.handle =
+      xQueueCreate(drv::out::track::rx_queue.size,
+                   sizeof(drv::out::track::RxQueue::value_type));
+
+    // Track stub, drains one packet per tick until operations end
+    drv::out::track::dcc::task.function = [](void*) {
+      std::array<uint8_t, drv::out::tx_message_buffer.size> packet;
+      while (state.load() == State::DCCOperations) {
+        if (!xMessageBufferReceive(drv::out::tx_message_buffer.front_handle,
+                                   data(packet),
+                                   size(packet),
+                                   0u))
+          xMessageBufferReceive(drv::out::tx_message_buffer.back_handle,
+                                data(packet),
+                                size(packet),
+                                0u);
+        vTaskDelay(1u);
+      }
+      vTaskDelete(NULL);
+    };
+
+    _dcc_service = std::make_shared<mw::dcc::Service>();
+    _server = std::make_shared<LoadServer>(_dcc_service);
+    _dcc_service->z21(
+      _server, _server, std::bind_front(&LoadServer::post, _server.get()));
+    state.store(State::DCCOperations);
+    mw::dcc::task.create();
+  }
+
+  ~Z21LoadTest() {
+    state.store(State::Suspended);
+    while (xTaskGetHandle(mw::dcc::task.name))
+      vTaskDelay(pdMS_TO_TICKS(mw::dcc::task.timeout));
+    _server->stop();
+    _dcc_service->z21(nullptr, nullptr, {});
+    _server.reset();
+    _dcc_service.reset();
+    mem::nvs::Locos{}.eraseAll();
+    mem::nvs::Turnouts{}.eraseAll();
+    vQueueDelete(drv::out::track::rx_queue.handle);
+    vMessageBufferDelete(drv::out::tx_message_buffer.back_handle);
+    vMessageBufferDelete(drv::out::tx_message_buffer.front_handle);
+  }
+
+  std::shared_ptr<mw::dcc::Service> _dcc_service;
+  std::shared_ptr<LoadServer> _server;
+};
+
+TEST_F(Z21LoadTest, DISABLED_udp_throttles) {
+  std::vector<std::unique_ptr<Throttle>> throttles;
+  for (auto i{0uz}; i < clients; ++i)
+    throttles.push_back(std::make_unique<Throttle>(i, _server->port()));
+
+  std::atomic<bool> running{true};
+  std::atomic<size_t> done{};
+  std::vector<std::thread> threads;
+  for (auto& throttle : throttles)
+    threads.push_back(host_thread([&, t = throttle.get()] {
+      t->run(running);
+      ++done;
+    }));
+
+  // Drive shared loco and record when each throttle sees the change
+  std::vector<Clock::duration> fanouts;
+  Throttle driver{clients, _server->port()};
+  uint8_t speed{};
+  for (auto const end{Clock::now() + duration}; Clock::now() < end;) {
+    speed = static_cast<uint8_t>(speed % 126u + 2u);
+    auto const sent{Clock::now()};
+    driver.send(set_loco_drive(shared_loco, 0x80u | speed));
+    vTaskDelay(pdMS_TO_TICKS(fanout_period.count()));
+    auto last{sent};
+    auto seen_by_all{true};
+    for (auto& t : throttles) {
+      std::lock_guard lock{t->fanout_mutex};
+      if (auto const it{t->fanout.find(speed)}; it != cend(t->fanout))
+        last = std::max(last, it->second);
+      else seen_by_all = false;
+      t->fanout.clear();
+    }
+    if (seen_by_all) fanouts.push_back(last - sent);
+  }
+
+  running = false;
+  while (done < clients) vTaskDelay(pdMS_TO_TICKS(10u));
+  for (auto& thread : threads) thread.join();
+
+  std::vector<Clock::duration> latencies;
+  size_t requests{}, rx{};
+  for (auto const& t : throttles) {
+    latencies.insert(cend(latencies), cbegin(t->latencies), cend(t->latencies));
+    requests += t->requests;
+    rx += t->rx;
+  }
+
+  // Only the last serial number and probe request of each throttle may still
+  // be in flight, and every throttle saw at least some of the broadcasts
+  EXPECT_LE(requests - size(latencies), clients * 2uz);
+  EXPECT_FALSE(empty(fanouts));
+
+  auto const ms{[](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>{d}.count();
+  }};
+  std::printf("clients         %zu\n", clients);
+  std::printf("requests        %zu\n", requests);
+  std::printf("replies         %zu\n", size(latencies));
+  for (auto const p : {50uz, 90uz, 99uz})
+    std::printf("latency p%-2zu     %.1fms\n", p, ms(percentile(latencies, p)));
+  std::printf("datasets rx     %zu\n", rx);
+  std::printf("fan-out p50     %.1fms\n", ms(percentile(fanouts, 50uz)));
+  std::printf("fan-out max     %.1fms\n", ms(percentile(fanouts, 100uz)));
+  if (auto const n{_server->datagrams()})
+    std::printf(
+      "cpu/datagram    %.1fus\n",
+      std::chrono::duration<double, std::micro>{_server->cpuTime()}.count() /
+        static_cast<double>(n));
+}
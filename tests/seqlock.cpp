@@ -0,0 +1,43 @@
+#include "seqlock.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace {
+
+struct Data {
+  uint32_t a;
+  uint32_t b;
+  uint8_t c;
+};
+
+} // namespace
+
+TEST(seqlock, store_load) {
+  Seqlock<Data> seqlock;
+  EXPECT_EQ(seqlock.count(), 0uz);
+  seqlock.store({.a = 42u, .b = 43u, .c = 44u});
+  auto const data{seqlock.load()};
+  EXPECT_EQ(data.a, 42u);
+  EXPECT_EQ(data.b, 43u);
+  EXPECT_EQ(data.c, 44u);
+  EXPECT_EQ(seqlock.count(), 1uz);
+}
+
+TEST(seqlock, no_torn_reads) {
+  Seqlock<Data> seqlock;
+  seqlock.store({.a = 0u, .b = ~0u, .c = 0u});
+
+  std::thread writer{[&seqlock] {
+    for (auto i{1u}; i <= 100'000u; ++i)
+      seqlock.store({.a = i, .b = ~i, .c = static_cast<uint8_t>(i)});
+  }};
+
+  for (auto i{0uz}; i < 100'000uz; ++i) {
+    auto const data{seqlock.load()};
+    ASSERT_EQ(data.b, ~data.a);
+    ASSERT_EQ(data.c, static_cast<uint8_t>(data.a));
+  }
+
+  writer.join();
+  EXPECT_EQ(seqlock.load().a, 100'000u);
+}
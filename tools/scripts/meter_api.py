@@ -0,0 +1,24 @@
+import json, requests
+
+
+run_get_requests = True
+run_delete_requests = False
+
+# Open session
+s = requests.Session()
+
+"""
+GET
+"""
+if run_get_requests:
+    r = s.get("http://remise.local/meter/")
+    print(str(r.request) + " " + str(r.url) + " " + str(r.status_code))
+    if len(r.content) and r.headers.get("content-type") == "application/json":
+        print(r.json())
+
+"""
+DELETE
+"""
+if run_delete_requests:
+    r = s.delete("http://remise.local/meter/")
+    print(str(r.request) + " " + str(r.url) + " " + str(r.status_code))
@@ -0,0 +1,88 @@
+import struct, sys, zlib
+
+# Create delta patch from the image currently running (base) to a new one
+#
+# Usage: python ota_patch.py base.bin new.bin patch.bin
+#
+# The patch can be uploaded through /ota/ just like an image.
+
+MIN_MATCH = 8
+WINDOW_BITS = 12  # mw::ota::patch_window_size
+APP_DESC_OFFSET = 32  # esp_image_header_t + esp_image_segment_header_t
+APP_DESC_MAGIC = 0xABCD5432
+APP_ELF_SHA256_OFFSET = APP_DESC_OFFSET + 144
+
+
+def varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append(value & 0x7F | 0x80)
+        value >>= 7
+    out.append(value)
+    return out
+
+
+def zigzag(value):
+    return value << 1 if value >= 0 else (-value << 1) - 1
+
+
+def match_length(base, src, image, dst):
+    n = 0
+    while src + n < len(base) and dst + n < len(image) and base[src + n] == image[dst + n]:
+        n += 1
+    return n
+
+
+def make_patch(base, image):
+    (magic,) = struct.unpack_from("<I", base, APP_DESC_OFFSET)
+    if magic != APP_DESC_MAGIC:
+        sys.exit("base is not an app image")
+    header = bytearray(b"ORDP")
+    header += struct.pack("<I", len(image))
+    header += base[APP_ELF_SHA256_OFFSET : APP_ELF_SHA256_OFFSET + 32]
+    ops = bytearray()
+
+    index = {}
+    for i in range(len(base) - MIN_MATCH + 1):
+        index.setdefault(base[i : i + MIN_MATCH], i)
+
+    src = 0
+    literals = bytearray()
+    i = 0
+    while i < len(image):
+        start, n = src, match_length(base, src, image, i)
+        if n < MIN_MATCH:
+            candidate = index.get(image[i : i + MIN_MATCH])
+            if candidate is not None:
+                m = match_length(base, candidate, image, i)
+                if m > n:
+                    start, n = candidate, m
+        if n < MIN_MATCH:
+            literals.append(image[i])
+            i += 1
+            continue
+        if literals:
+            ops += b"\x01" + varint(len(literals)) + literals
+            literals = bytearray()
+        ops += b"\x00" + varint(n) + varint(zigzag(start - src))
+        src = start + n
+        i += n
+    if literals:
+        ops += b"\x01" + varint(len(literals)) + literals
+
+    # Operations are a raw deflate stream the device inflates with a small window
+    compressor = zlib.compressobj(9, zlib.DEFLATED, -WINDOW_BITS)
+    return header + compressor.compress(ops) + compressor.flush()
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 4:
+        sys.exit("usage: ota_patch.py base.bin new.bin patch.bin")
+    with open(sys.argv[1], "rb") as f:
+        base = f.read()
+    with open(sys.argv[2], "rb") as f:
+        image = f.read()
+    patch = make_patch(base, image)
+    with open(sys.argv[3], "wb") as f:
+        f.write(patch)
+    print(f"{len(image)} -> {len(patch)} bytes ({len(image) / len(patch):.1f}x)")
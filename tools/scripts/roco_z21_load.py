@@ -0,0 +1,267 @@
+import argparse, collections, random, socket, statistics, struct, threading, time
+import requests
+from websocket import create_connection
+
+"""
+Z21 load test
+
+Simulates a number of UDP and WebSocket throttles against a running device.
+Every client subscribes to driving, switching and system state broadcasts and
+then cycles through drive, function, turnout, loco info and system state
+requests. Client 0 additionally drives a shared loco every other client has
+subscribed to, which measures broadcast fan-out time.
+
+Z21 replies carry no request id, so latencies are only measured for requests
+whose reply can't be confused with a broadcast. Loco info is requested for a
+probe loco nobody drives, and serial number replies are never broadcast.
+Replies get matched to requests of the same kind in order.
+
+The CPU time per datagram is derived from the z21_runtime and z21_datagrams
+counters of the /sys/ endpoint.
+
+Clients drive locos 100+id, probe locos 1000+id and switch turnouts 1+id.
+Every loco and turnout which didn't exist before the run gets deleted at the
+end.
+
+tests/mw/roco/z21/load.cpp runs the same traffic against the Z21 and DCC
+services on the linux target.
+"""
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--host", default="remise.local")
+parser.add_argument("--udp", type=int, default=8, help="number of UDP clients")
+parser.add_argument("--ws", type=int, default=2, help="number of WebSocket clients")
+parser.add_argument("--duration", type=float, default=30.0, help="[s]")
+parser.add_argument("--rate", type=float, default=10.0, help="requests/s/client")
+parser.add_argument("--shared-loco", type=int, default=3)
+args = parser.parse_args()
+
+
+def xor(data):
+    x = 0
+    for b in data:
+        x ^= b
+    return x
+
+
+def dataset(header, payload):
+    return struct.pack("<HH", 4 + len(payload), header) + bytes(payload)
+
+
+def x_dataset(xbus):
+    return dataset(0x40, xbus + [xor(xbus)])
+
+
+def loco_addr(addr):
+    return [(addr >> 8) | (0xC0 if addr >= 128 else 0x00), addr & 0xFF]
+
+
+def set_broadcastflags(flags):
+    return dataset(0x50, list(struct.pack("<I", flags)))
+
+
+def get_serial_number():
+    return dataset(0x10, [])
+
+
+def systemstate_getdata():
+    return dataset(0x85, [])
+
+
+def get_loco_info(addr):
+    return x_dataset([0xE3, 0xF0] + loco_addr(addr))
+
+
+def set_loco_drive(addr, rvvvvvvv):
+    return x_dataset([0xE4, 0x13] + loco_addr(addr) + [rvvvvvvv])
+
+
+def set_loco_function(addr, index, on):
+    return x_dataset([0xE4, 0xF8] + loco_addr(addr) + [(on << 6) | index])
+
+
+def set_turnout(addr, p):
+    return x_dataset([0x53, addr >> 8, addr & 0xFF, 0x88 | p])
+
+
+def logoff():
+    return dataset(0x30, [])
+
+
+def split(payload):
+    while len(payload) >= 4:
+        length, header = struct.unpack_from("<HH", payload)
+        if length < 4 or length > len(payload):
+            break
+        yield header, payload[4:length]
+        payload = payload[length:]
+
+
+class Client:
+    def __init__(self, id):
+        self.id = id
+        self.loco = 100 + id
+        self.probe = 1000 + id
+        self.turnout = 1 + id
+        self.latencies = []
+        self.pending = collections.defaultdict(collections.deque)
+        self.fanout = {}
+        self.rx = 0
+        self.running = True
+
+    def request(self, key, data):
+        self.pending[key].append(time.perf_counter())
+        self.send(data)
+
+    def reply(self, key, now):
+        if self.pending[key]:
+            self.latencies.append(now - self.pending[key].popleft())
+
+    def receive(self, payload):
+        now = time.perf_counter()
+        for header, data in split(payload):
+            self.rx += 1
+            if header == 0x10:
+                self.reply("serial", now)
+            elif header == 0x40 and len(data) >= 6 and data[0] == 0xEF:
+                addr = ((data[1] & 0x3F) << 8) | data[2]
+                if addr == args.shared_loco:
+                    self.fanout.setdefault(data[4] & 0x7F, now)
+                elif addr == self.probe:
+                    self.reply("loco", now)
+
+    def run(self):
+        self.send(set_broadcastflags(0x00000101))
+        self.send(get_loco_info(args.shared_loco))
+        period = 1.0 / args.rate
+        i = 0
+        while self.running:
+            match i % 5:
+                case 0:
+                    self.send(set_loco_drive(self.loco, 0x80 | random.randrange(2, 128)))
+                case 1:
+                    self.send(set_loco_function(self.loco, i % 29, i & 1))
+                case 2:
+                    self.send(set_turnout(self.turnout, i & 1))
+                case 3:
+                    self.request("loco", get_loco_info(self.probe))
+                case 4 if i & 1:
+                    self.send(systemstate_getdata())
+                case 4:
+                    self.request("serial", get_serial_number())
+            i += 1
+            time.sleep(period * random.uniform(0.5, 1.5))
+        self.send(logoff())
+
+
+class UdpClient(Client):
+    def __init__(self, id):
+        super().__init__(id)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.settimeout(0.1)
+        self.addr = (socket.gethostbyname(args.host), 21105)
+        threading.Thread(target=self.listen, daemon=True).start()
+
+    def send(self, data):
+        self.sock.sendto(data, self.addr)
+
+    def listen(self):
+        while self.running:
+            try:
+                self.receive(self.sock.recv(1472))
+            except socket.timeout:
+                pass
+
+
+class WsClient(Client):
+    def __init__(self, id):
+        super().__init__(id)
+        self.ws = create_connection(f"ws://{args.host}/roco/z21/", timeout=0.1)
+        threading.Thread(target=self.listen, daemon=True).start()
+
+    def send(self, data):
+        self.ws.send(data, opcode=2)
+
+    def listen(self):
+        while self.running:
+            try:
+                self.receive(self.ws.recv())
+            except Exception:
+                pass
+
+
+def sys_counters():
+    doc = requests.get(f"http://{args.host}/sys/").json()
+    return doc.get("z21_runtime", 0), doc.get("z21_datagrams", 0)
+
+
+def addresses(collection):
+    r = requests.get(f"http://{args.host}/dcc/{collection}/")
+    return {obj["address"] for obj in r.json()}
+
+
+def cleanup(collection, before, used):
+    for addr in used - before:
+        requests.delete(f"http://{args.host}/dcc/{collection}/{addr}")
+
+
+def percentile(values, p):
+    if not values:
+        return float("nan")
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p / 100 * len(values)))]
+
+
+locos_before = addresses("locos")
+turnouts_before = addresses("turnouts")
+
+clients = [UdpClient(i) for i in range(args.udp)]
+clients += [WsClient(args.udp + i) for i in range(args.ws)]
+runtime_before, datagrams_before = sys_counters()
+
+threads = [threading.Thread(target=c.run) for c in clients]
+for t in threads:
+    t.start()
+
+# Drive shared loco from client 0 and record when each client sees the change
+fanouts = []
+deadline = time.perf_counter() + args.duration
+speed = 0
+while time.perf_counter() < deadline:
+    speed = speed % 126 + 2
+    sent = time.perf_counter()
+    clients[0].send(set_loco_drive(args.shared_loco, 0x80 | speed))
+    time.sleep(1.0)
+    seen = [c.fanout.pop(speed, None) for c in clients]
+    if all(seen):
+        fanouts.append(max(seen) - sent)
+    for c in clients:
+        c.fanout.clear()
+
+for c in clients:
+    c.running = False
+for t in threads:
+    t.join()
+time.sleep(0.5)
+
+runtime_after, datagrams_after = sys_counters()
+
+# Remove locos and turnouts created by this run
+used_locos = {args.shared_loco} | {a for c in clients for a in (c.loco, c.probe)}
+cleanup("locos", locos_before, used_locos)
+cleanup("turnouts", turnouts_before, {c.turnout for c in clients})
+
+latencies = [l for c in clients for l in c.latencies]
+print(f"clients          {len(clients)} ({args.udp} UDP, {args.ws} WebSocket)")
+print(f"replies          {len(latencies)}")
+for p in (50, 90, 99):
+    print(f"latency p{p:<2}      {percentile(latencies, p) * 1e3:.1f}ms")
+print(f"datasets rx      {sum(c.rx for c in clients)}")
+if fanouts:
+    print(f"fan-out median   {statistics.median(fanouts) * 1e3:.1f}ms")
+    print(f"fan-out max      {max(fanouts) * 1e3:.1f}ms")
+if datagrams_after > datagrams_before:
+    print(
+        f"cpu/datagram     "
+        f"{(runtime_after - runtime_before) / (datagrams_after - datagrams_before):.1f}us"
+    )